@@ -1,6 +1,7 @@
 #ifndef SUCCINCT_GRAPH_BENCHMARK_H
 #define SUCCINCT_GRAPH_BENCHMARK_H
 
+#include <chrono>
 #include <random>
 #include <string>
 #include <sstream>
@@ -11,6 +12,7 @@
 #include <thrift/transport/TBufferTransports.h>
 #include <thrift/transport/TSocket.h>
 
+#include "LatencyHistogram.hpp"
 #include "SuccinctGraph.hpp"
 #include "ports.h"
 #include "utils.h"
@@ -54,6 +56,10 @@ private:
     // constexpr static int64_t MEASURE_MICROSECS = 120 * 1000 * 1000;
     // constexpr static int64_t COOLDOWN_MICROSECS = 30 * 1000 * 1000;
 
+    // Timings for each target rate of the open-loop benchmark.
+    constexpr static int64_t OPEN_LOOP_WARMUP_MICROSECS = 30 * 1000 * 1000;
+    constexpr static int64_t OPEN_LOOP_MEASURE_MICROSECS = 60 * 1000 * 1000;
+
     constexpr static int query_batch_size = 100;
 
     typedef enum {
@@ -75,6 +81,27 @@ private:
         TAO_MIX_WITH_UPDATES = 15
     } BenchType;
 
+    // TAO operation types, numbered as returned by choose_query() and
+    // choose_query_with_updates(); indexes the per-op latency histograms.
+    typedef enum {
+        TAO_ASSOC_RANGE_OP = 0,
+        TAO_OBJ_GET_OP = 1,
+        TAO_ASSOC_GET_OP = 2,
+        TAO_ASSOC_COUNT_OP = 3,
+        TAO_ASSOC_TIME_RANGE_OP = 4,
+        TAO_ASSOC_ADD_OP = 5,
+        TAO_OBJ_ADD_OP = 6,
+        NUM_TAO_OPS = 7
+    } TaoOp;
+
+    static const char* tao_op_name(int op) {
+        static const char* names[NUM_TAO_OPS] = {
+            "assoc_range", "obj_get", "assoc_get", "assoc_count",
+            "assoc_time_range", "assoc_add", "obj_add"
+        };
+        return names[op];
+    }
+
     // Read/Write workload distribution; from ATC 13 Bronson et al.
     constexpr static double ASSOC_RANGE_PERC = 0.409;
     constexpr static double OBJ_GET_PERC = 0.289;
@@ -126,32 +153,8 @@ private:
         const std::string& master_hostname,
         const BenchType type)
     {
-        std::vector<shared_ptr<benchmark_thread_data_t>> thread_datas;
-        for (int i = 0; i < num_threads; ++i) {
-            try {
-                shared_ptr<TSocket> socket(
-                    new TSocket(master_hostname, QUERY_HANDLER_PORT));
-                shared_ptr<TTransport> transport(
-                    new TBufferedTransport(socket));
-                shared_ptr<TProtocol> protocol(new TBinaryProtocol(transport));
-                shared_ptr<GraphQueryAggregatorServiceClient> client(
-                    new GraphQueryAggregatorServiceClient(protocol));
-                transport->open();
-                client->init();
-
-                shared_ptr<benchmark_thread_data_t> thread_data(
-                    new benchmark_thread_data_t);
-                thread_data->client = client;
-                thread_data->client_id = i;
-                thread_data->transport = transport;
-                thread_data->master_hostname = master_hostname;
-
-                thread_datas.push_back(thread_data);
-
-            } catch (std::exception& e) {
-                LOG_E("Exception opening clients: %s\n", e.what());
-            }
-        }
+        std::vector<shared_ptr<benchmark_thread_data_t>> thread_datas =
+            connect_clients(num_threads, master_hostname);
 
         std::vector<shared_ptr<std::thread>> threads;
         time_t start;
@@ -289,6 +292,8 @@ private:
             (get_timestamp() - start) * 1. / 1e6,
             (WARMUP_MICROSECS + MEASURE_MICROSECS + COOLDOWN_MICROSECS) / 1e6);
 
+        write_latency_histograms(thread_datas, type);
+
         // Close the client-side transports, otherwise Thrift on the
         // server-side doesn't place nicely with next connections.
         for (auto thread_data : thread_datas) {
@@ -307,8 +312,314 @@ private:
         shared_ptr<TTransport> transport;
         std::string master_hostname;
         int client_id; // for seeding
+        // Measure-phase latencies (us), indexed by TaoOp
+        std::vector<LatencyHistogram> histograms;
+        int64_t completed; // measure-phase queries, open-loop only
+        // Measure-phase queries that failed, or were skipped while the
+        // client could not reconnect; open-loop only
+        int64_t errors;
     } benchmark_thread_data_t;
 
+    // Merges the measure-phase latency histograms of all threads and writes
+    // them out (see write_latency_summary).
+    void write_latency_histograms(
+        const std::vector<shared_ptr<benchmark_thread_data_t>>& thread_datas,
+        const BenchType type)
+    {
+        std::string bench;
+        switch (type) {
+        case TAO_ASSOC_RANGE:
+            bench = "tao_assoc_range";
+            break;
+        case TAO_ASSOC_COUNT:
+            bench = "tao_assoc_count";
+            break;
+        case TAO_OBJ_GET:
+            bench = "tao_obj_get";
+            break;
+        case TAO_ASSOC_GET:
+            bench = "tao_assoc_get";
+            break;
+        case TAO_ASSOC_TIME_RANGE:
+            bench = "tao_assoc_time_range";
+            break;
+        case TAO_MIX:
+            bench = "tao_mix";
+            break;
+        case TAO_MIX_WITH_UPDATES:
+            bench = "tao_mix_with_updates";
+            break;
+        default:
+            return;  // not instrumented
+        }
+
+        std::vector<LatencyHistogram> merged(NUM_TAO_OPS);
+        for (auto thread_data : thread_datas) {
+            for (int op = 0; op < NUM_TAO_OPS; ++op) {
+                merged[op].merge(thread_data->histograms[op]);
+            }
+        }
+        write_latency_summary(merged, thread_datas.size(), bench);
+    }
+
+    // Writes per-op histograms, indexed by TaoOp, and their union to
+    // latency_<bench>.json.  Next to the raw percentiles, "corrected" ones
+    // account for coordinated omission: each client is closed-loop, so a slow
+    // request delays the ones it would have issued next.  We assume a client
+    // intends to issue one request per mean service time.
+    void write_latency_summary(
+        const std::vector<LatencyHistogram>& per_op,
+        size_t num_threads,
+        const std::string& bench)
+    {
+        LatencyHistogram all;
+        for (auto& histogram : per_op) {
+            all.merge(histogram);
+        }
+        int64_t expected_interval = static_cast<int64_t>(all.mean());
+
+        std::ofstream out("latency_" + bench + ".json");
+        out << "{\"bench\": \"" << bench << "\", \"threads\": "
+            << num_threads << ",\n \"ops\": {";
+        bool first = true;
+        for (int op = 0; op < NUM_TAO_OPS; ++op) {
+            if (per_op[op].count() == 0) {
+                continue;
+            }
+            out << (first ? "\n" : ",\n") << "  \"" << tao_op_name(op)
+                << "\": ";
+            per_op[op].write_json(out);
+            out << ",\n  \"" << tao_op_name(op) << "_corrected\": ";
+            per_op[op].corrected(expected_interval).write_json(out);
+            first = false;
+        }
+        out << "},\n \"all\": ";
+        all.write_json(out);
+        out << ",\n \"all_corrected\": ";
+        all.corrected(expected_interval).write_json(out);
+        out << "}\n";
+        out.close();
+
+        LOG_E("Latency [%s]: p50 %" PRId64 " us, p99 %" PRId64 " us, "
+            "p999 %" PRId64 " us over %" PRId64 " queries\n", bench.c_str(),
+            all.value_at_percentile(50), all.value_at_percentile(99),
+            all.value_at_percentile(99.9), all.count());
+    }
+
+    // Opens one client connection to the master aggregator per thread.
+    std::vector<shared_ptr<benchmark_thread_data_t>> connect_clients(
+        const int num_threads,
+        const std::string& master_hostname)
+    {
+        std::vector<shared_ptr<benchmark_thread_data_t>> thread_datas;
+        for (int i = 0; i < num_threads; ++i) {
+            try {
+                shared_ptr<TSocket> socket(
+                    new TSocket(master_hostname, QUERY_HANDLER_PORT));
+                shared_ptr<TTransport> transport(
+                    new TBufferedTransport(socket));
+                shared_ptr<TProtocol> protocol(new TBinaryProtocol(transport));
+                shared_ptr<GraphQueryAggregatorServiceClient> client(
+                    new GraphQueryAggregatorServiceClient(protocol));
+                transport->open();
+                client->init();
+
+                shared_ptr<benchmark_thread_data_t> thread_data(
+                    new benchmark_thread_data_t);
+                thread_data->client = client;
+                thread_data->client_id = i;
+                thread_data->transport = transport;
+                thread_data->master_hostname = master_hostname;
+                thread_data->histograms.resize(NUM_TAO_OPS);
+                thread_data->completed = 0;
+                thread_data->errors = 0;
+
+                thread_datas.push_back(thread_data);
+
+            } catch (std::exception& e) {
+                LOG_E("Exception opening clients: %s\n", e.what());
+            }
+        }
+        return thread_datas;
+    }
+
+    // Re-opens a client connection after a failed query.  On failure the
+    // client and transport are left null, until a later call succeeds.
+    void reconnect_client(shared_ptr<benchmark_thread_data_t> thread_data) {
+        thread_data->client.reset();
+        thread_data->transport.reset();
+
+        try {
+            shared_ptr<TSocket> socket(
+                new TSocket(thread_data->master_hostname, QUERY_HANDLER_PORT));
+            shared_ptr<TTransport> transport(new TBufferedTransport(socket));
+            shared_ptr<TProtocol> protocol(new TBinaryProtocol(transport));
+            shared_ptr<GraphQueryAggregatorServiceClient> client(
+                new GraphQueryAggregatorServiceClient(protocol));
+            transport->open();
+            client->init();
+            LOG_E("Reestablished connections.\n");
+
+            thread_data->client = client;
+            thread_data->transport = transport;
+        } catch(std::exception& e2) {
+            LOG_E("Failed to establish connections, will try next round.\n");
+        }
+    }
+
+    // Issues one TAO read query of type `query` (see TaoOp), drawn from the
+    // warmup or the measure query set; returns the number of edges returned.
+    template<typename Generator>
+    size_t issue_tao_query(
+        shared_ptr<benchmark_thread_data_t> thread_data,
+        int query,
+        bool warmup,
+        Generator& gen)
+    {
+        std::vector<ThriftAssoc> result;
+        std::vector<std::string> attrs;
+        int query_idx;
+        switch (query) {
+        case TAO_ASSOC_RANGE_OP: {
+            const std::vector<int64_t>& nodes =
+                warmup ? warmup_assoc_range_nodes : assoc_range_nodes;
+            query_idx = std::uniform_int_distribution<int>(
+                0, nodes.size() - 1)(gen);
+            thread_data->client->assoc_range(result,
+                nodes.at(query_idx),
+                (warmup ? warmup_assoc_range_atypes : assoc_range_atypes)
+                    .at(query_idx),
+                (warmup ? warmup_assoc_range_offs : assoc_range_offs)
+                    .at(query_idx),
+                (warmup ? warmup_assoc_range_lens : assoc_range_lens)
+                    .at(query_idx));
+            break;
+        }
+        case TAO_OBJ_GET_OP: {
+            const std::vector<int64_t>& nodes =
+                warmup ? warmup_obj_get_nodes : obj_get_nodes;
+            query_idx = std::uniform_int_distribution<int>(
+                0, nodes.size() - 1)(gen);
+            thread_data->client->obj_get(attrs, nodes.at(query_idx));
+            break;
+        }
+        case TAO_ASSOC_GET_OP: {
+            const std::vector<int64_t>& nodes =
+                warmup ? warmup_assoc_get_nodes : assoc_get_nodes;
+            query_idx = std::uniform_int_distribution<int>(
+                0, nodes.size() - 1)(gen);
+            thread_data->client->assoc_get(result,
+                nodes.at(query_idx),
+                (warmup ? warmup_assoc_get_atypes : assoc_get_atypes)
+                    .at(query_idx),
+                (warmup ? warmup_assoc_get_dst_id_sets : assoc_get_dst_id_sets)
+                    .at(query_idx),
+                (warmup ? warmup_assoc_get_lows : assoc_get_lows)
+                    .at(query_idx),
+                (warmup ? warmup_assoc_get_highs : assoc_get_highs)
+                    .at(query_idx));
+            break;
+        }
+        case TAO_ASSOC_COUNT_OP: {
+            const std::vector<int64_t>& nodes =
+                warmup ? warmup_assoc_count_nodes : assoc_count_nodes;
+            query_idx = std::uniform_int_distribution<int>(
+                0, nodes.size() - 1)(gen);
+            thread_data->client->assoc_count(
+                nodes.at(query_idx),
+                (warmup ? warmup_assoc_count_atypes : assoc_count_atypes)
+                    .at(query_idx));
+            break;
+        }
+        case TAO_ASSOC_TIME_RANGE_OP: {
+            const std::vector<int64_t>& nodes =
+                warmup ? warmup_assoc_time_range_nodes : assoc_time_range_nodes;
+            query_idx = std::uniform_int_distribution<int>(
+                0, nodes.size() - 1)(gen);
+            thread_data->client->assoc_time_range(result,
+                nodes.at(query_idx),
+                (warmup ? warmup_assoc_time_range_atypes
+                    : assoc_time_range_atypes).at(query_idx),
+                (warmup ? warmup_assoc_time_range_lows
+                    : assoc_time_range_lows).at(query_idx),
+                (warmup ? warmup_assoc_time_range_highs
+                    : assoc_time_range_highs).at(query_idx),
+                (warmup ? warmup_assoc_time_range_limits
+                    : assoc_time_range_limits).at(query_idx));
+            break;
+        }
+        default:
+            assert(false);
+        }
+        return result.size();
+    }
+
+    // One open-loop client: issues TAO mix queries at the arrival times of
+    // its own schedule (Poisson or constant, `rate` queries/sec), whether or
+    // not earlier queries have completed.  Latency is measured from the
+    // scheduled arrival, so time spent waiting behind a slow query counts.
+    // Only arrivals scheduled in the measure window are recorded; those in
+    // the warmup window draw from the warmup query set.  While the client is
+    // disconnected, each arrival retries the connection and, if that fails,
+    // is skipped; measure-window failures and skips count as errors.
+    void open_loop_tao_mix_helper(
+        shared_ptr<benchmark_thread_data_t> thread_data,
+        double rate,
+        bool poisson,
+        int64_t warmup_micros,
+        int64_t measure_micros)
+    {
+        std::mt19937 gen(thread_data->client_id * 7919 + 1);
+        std::uniform_real_distribution<double> query_dis(0, 1);
+        std::exponential_distribution<double> interarrival(rate / 1e6);
+        double interval = 1e6 / rate;
+
+        double start = get_timestamp();
+        double measure_start = start + warmup_micros;
+        double end = measure_start + measure_micros;
+        // Random phase, so that constant-rate clients don't fire in lockstep
+        double arrival = start + query_dis(gen) * interval;
+
+        thread_data->completed = 0;
+        thread_data->errors = 0;
+        while (arrival < end) {
+            double now = get_timestamp();
+            if (now < arrival) {
+                std::this_thread::sleep_for(std::chrono::microseconds(
+                    static_cast<int64_t>(arrival - now)));
+            }
+
+            int query = choose_query(query_dis(gen));
+            bool measured = arrival >= measure_start;
+            if (thread_data->client == nullptr) {
+                reconnect_client(thread_data);
+            }
+            if (thread_data->client == nullptr) {
+                if (measured) {
+                    ++thread_data->errors;
+                }
+            } else {
+                try {
+                    issue_tao_query(thread_data, query, !measured, gen);
+                    if (measured) {
+                        thread_data->histograms[query].record(
+                            get_timestamp() - static_cast<time_t>(arrival));
+                        ++thread_data->completed;
+                    }
+                } catch (std::exception& e) {
+                    LOG_E("Query failed: type = %d, err = %s\n", query,
+                        e.what());
+                    if (measured) {
+                        ++thread_data->errors;
+                    }
+                    reconnect_client(thread_data);
+                }
+            }
+
+            arrival += poisson ? interarrival(gen) : interval;
+        }
+    }
+
 public:
 
     GraphBenchmark(SuccinctGraph *graph, const std::string& master_hostname) {
@@ -1476,11 +1787,13 @@ public:
 		start = get_timestamp();
 		while (get_timestamp() - start < MEASURE_MICROSECS) {
 			query_idx = assoc_range_size(gen);
+			time_t query_start = get_timestamp();
 			thread_data->client->assoc_range(result,
 				this->assoc_range_nodes.at(query_idx),
 				this->assoc_range_atypes.at(query_idx),
 				this->assoc_range_offs.at(query_idx),
 				this->assoc_range_lens.at(query_idx));
+			thread_data->histograms[TAO_ASSOC_RANGE_OP].record(get_timestamp() - query_start);
 
 			edges += result.size();
 			++i;
@@ -1563,8 +1876,10 @@ public:
 		start = get_timestamp();
 		while (get_timestamp() - start < MEASURE_MICROSECS) {
 			query_idx = obj_get_size(gen);
+			time_t query_start = get_timestamp();
 			thread_data->client->obj_get(attrs,
 				this->obj_get_nodes.at(query_idx));
+			thread_data->histograms[TAO_OBJ_GET_OP].record(get_timestamp() - query_start);
 			++i;
 		}
 
@@ -1649,12 +1964,14 @@ public:
 		start = get_timestamp();
 		while (get_timestamp() - start < MEASURE_MICROSECS) {
 			query_idx = assoc_get_size(gen);
+			time_t query_start = get_timestamp();
 			thread_data->client->assoc_get(result,
 				this->assoc_get_nodes.at(query_idx),
 				this->assoc_get_atypes.at(query_idx),
 				this->assoc_get_dst_id_sets.at(query_idx),
 				this->assoc_get_lows.at(query_idx),
 				this->assoc_get_highs.at(query_idx));
+			thread_data->histograms[TAO_ASSOC_GET_OP].record(get_timestamp() - query_start);
 
 			edges += result.size();
 			++i;
@@ -1742,9 +2059,11 @@ public:
 		start = get_timestamp();
 		while (get_timestamp() - start < MEASURE_MICROSECS) {
 			query_idx = assoc_count_size(gen);
+			time_t query_start = get_timestamp();
 			thread_data->client->assoc_count(
 				this->assoc_count_nodes.at(query_idx),
 				this->assoc_count_atypes.at(query_idx));
+			thread_data->histograms[TAO_ASSOC_COUNT_OP].record(get_timestamp() - query_start);
 
 			edges += result.size();
 			++i;
@@ -1835,12 +2154,14 @@ public:
 		start = get_timestamp();
 		while (get_timestamp() - start < MEASURE_MICROSECS) {
 			query_idx = assoc_time_range_size(gen);
+			time_t query_start = get_timestamp();
 			thread_data->client->assoc_time_range(result,
 				this->assoc_time_range_nodes.at(query_idx),
 				this->assoc_time_range_atypes.at(query_idx),
 				this->assoc_time_range_lows.at(query_idx),
 				this->assoc_time_range_highs.at(query_idx),
 				this->assoc_time_range_limits.at(query_idx));
+			thread_data->histograms[TAO_ASSOC_TIME_RANGE_OP].record(get_timestamp() - query_start);
 
 			edges += result.size();
 			++i;
@@ -2030,6 +2351,7 @@ public:
 		while (get_timestamp() - start < MEASURE_MICROSECS) {
 			try {
 				query = choose_query(query_dis(gen));
+				time_t query_start = get_timestamp();
 				switch (query) {
 				case 0:
 				  query_idx = assoc_range_size(gen);
@@ -2071,6 +2393,7 @@ public:
 				default:
 				  assert(false);
 				}
+				thread_data->histograms[query].record(get_timestamp() - query_start);
 				edges += result.size();
 				++i;
 			} catch (std::exception& e) {
@@ -2350,6 +2673,7 @@ public:
 		while (get_timestamp() - start < MEASURE_MICROSECS) {
 			try {
 				query = choose_query_with_updates(query_dis(gen), query_dis(gen));
+				time_t query_start = get_timestamp();
 				switch (query) {
 				case 0:
 				  query_idx = assoc_range_size(gen);
@@ -2400,6 +2724,7 @@ public:
 				default:
 				  assert(false);
 				}
+				thread_data->histograms[query].record(get_timestamp() - query_start);
 				edges += result.size();
 				++i;
 			} catch (std::exception& e) {
@@ -2586,6 +2911,104 @@ public:
             BenchType::TAO_MIX_WITH_UPDATES);
     }
 
+    // Open-loop TAO mix: for each target rate (queries/sec, aggregated over
+    // all clients), num_clients clients each issue queries at rate /
+    // num_clients on a Poisson or constant arrival schedule; see
+    // open_loop_tao_mix_helper().  Each client has one connection, so
+    // num_clients should exceed the target rate times the expected latency,
+    // or the clients themselves become the queue.
+    //
+    // Appends one line per rate to res_file:
+    //   target_qps,achieved_qps,p50_us,p90_us,p99_us,p999_us,max_us,errors
+    // and writes per-op histograms to latency_tao_mix_open_loop_<rate>.json.
+    void benchmark_tao_mix_open_loop(
+        const int num_clients,
+        const std::string& master_hostname,
+        const std::vector<double>& target_rates,
+        bool poisson,
+        const std::string& res_file,
+        const std::string& warmup_assoc_range_file,
+        const std::string& assoc_range_file,
+        const std::string& warmup_assoc_count_file,
+        const std::string& assoc_count_file,
+        const std::string& warmup_obj_get_file,
+        const std::string& obj_get_file,
+        const std::string& warmup_assoc_get_file,
+        const std::string& assoc_get_file,
+        const std::string& warmup_assoc_time_range_file,
+        const std::string& assoc_time_range_file)
+    {
+        // assoc_range
+        read_assoc_range_queries(warmup_assoc_range_file, assoc_range_file);
+        // assoc_count
+        read_neighbor_atype_queries(warmup_assoc_count_file, assoc_count_file,
+            warmup_assoc_count_nodes, assoc_count_nodes,
+            warmup_assoc_count_atypes, assoc_count_atypes);
+        // obj_get
+        read_neighbor_queries(warmup_obj_get_file, obj_get_file,
+            warmup_obj_get_nodes, obj_get_nodes);
+        // assoc_get
+        read_assoc_get_queries(warmup_assoc_get_file, assoc_get_file);
+        // assoc_time_range
+        read_assoc_time_range_queries(
+            warmup_assoc_time_range_file, assoc_time_range_file);
+
+        int64_t warmup_micros = OPEN_LOOP_WARMUP_MICROSECS;
+        int64_t measure_micros = OPEN_LOOP_MEASURE_MICROSECS;
+        std::ofstream res(res_file, std::ofstream::out | std::ofstream::app);
+        for (double target_rate : target_rates) {
+            LOG_E("Open-loop taoMix at %.1f queries/sec (%s arrivals)\n",
+                target_rate, poisson ? "poisson" : "constant");
+            std::vector<shared_ptr<benchmark_thread_data_t>> thread_datas =
+                connect_clients(num_clients, master_hostname);
+
+            std::vector<shared_ptr<std::thread>> threads;
+            for (auto thread_data : thread_datas) {
+                threads.push_back(shared_ptr<std::thread>(new std::thread(
+                    &GraphBenchmark::open_loop_tao_mix_helper, this,
+                    thread_data, target_rate / thread_datas.size(), poisson,
+                    warmup_micros, measure_micros)));
+            }
+            for (auto thread : threads) {
+                thread->join();
+            }
+
+            std::vector<LatencyHistogram> merged(NUM_TAO_OPS);
+            LatencyHistogram all;
+            int64_t completed = 0, errors = 0;
+            for (auto thread_data : thread_datas) {
+                for (int op = 0; op < NUM_TAO_OPS; ++op) {
+                    merged[op].merge(thread_data->histograms[op]);
+                    all.merge(thread_data->histograms[op]);
+                }
+                completed += thread_data->completed;
+                errors += thread_data->errors;
+                // Null if the client lost its connection and never got it back
+                if (thread_data->transport != nullptr) {
+                    thread_data->transport->close();
+                }
+            }
+            if (errors > 0) {
+                LOG_E("Open-loop taoMix at %.1f queries/sec: %" PRId64
+                    " queries failed or skipped\n", target_rate, errors);
+            }
+            // Open-loop latencies need no coordinated omission correction;
+            // the "_corrected" entries are for comparison with closed-loop.
+            write_latency_summary(merged, thread_datas.size(),
+                "tao_mix_open_loop_" + std::to_string(
+                    static_cast<int64_t>(target_rate)));
+
+            double achieved_rate = completed * 1e6 / measure_micros;
+            res << target_rate << "," << achieved_rate << ","
+                << all.value_at_percentile(50) << ","
+                << all.value_at_percentile(90) << ","
+                << all.value_at_percentile(99) << ","
+                << all.value_at_percentile(99.9) << ","
+                << all.max() << "," << errors << std::endl;
+        }
+        res.close();
+    }
+
     void benchmark_tao_assoc_range_throughput(
 		const int num_threads,
 		const std::string& master_hostname,
@@ -2712,6 +3135,77 @@ public:
         LOG_E("Measure complete.\n");
     }
 
+    // Encodes input_file with each random-access friendly NPA encoding and
+    // reports, per encoding, the NPA / total storage footprint and the
+    // average latency of random NPA lookups and 64-byte extracts.  Output is
+    // one CSV line per encoding:
+    //   scheme,npa_bytes,total_bytes,npa_lookup_ns,extract_us
+    void benchmark_npa_encodings(
+        std::string res_path,
+        uint64_t WARMUP_N,
+        uint64_t MEASURE_N,
+        std::string input_file)
+    {
+        const uint64_t EXTRACT_LEN = 64;
+        // ELIAS_DELTA_ENCODED is excluded: SuccinctCore's constructor returns
+        // before building the SA/ISA for it.
+        std::vector<NPA::NPAEncodingScheme> schemes = {
+            NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED,
+            NPA::NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED,
+            NPA::NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED
+        };
+        std::ofstream res_stream(res_path);
+        res_stream << "scheme,npa_bytes,total_bytes,npa_lookup_ns,extract_us\n";
+
+        for (auto scheme : schemes) {
+            LOG_E("Benchmarking NPA encoding %d on '%s'\n",
+                scheme, input_file.c_str());
+            SuccinctFile file(input_file, SuccinctMode::CONSTRUCT_IN_MEMORY,
+                32, 32, 128, SamplingScheme::FLAT_SAMPLE_BY_INDEX,
+                SamplingScheme::FLAT_SAMPLE_BY_INDEX, scheme);
+            uint64_t size = file.GetOriginalSize();
+
+            // Same positions for every encoding
+            std::mt19937 rng(1618);
+            std::uniform_int_distribution<uint64_t> uni(0, size - 1);
+            std::vector<uint64_t> positions(MEASURE_N);
+            for (uint64_t i = 0; i < MEASURE_N; ++i) {
+                positions[i] = uni(rng);
+            }
+
+            // Warmup
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < WARMUP_N; ++i) {
+                sum += file.LookupNPA(uni(rng));
+            }
+
+            // Measure; a single lookup is too short to time individually
+            time_t t0 = get_timestamp();
+            for (uint64_t i = 0; i < MEASURE_N; ++i) {
+                sum += file.LookupNPA(positions[i]);
+            }
+            time_t t1 = get_timestamp();
+            double lookup_ns = (t1 - t0) * 1000.0 / MEASURE_N;
+
+            std::string result;
+            t0 = get_timestamp();
+            for (uint64_t i = 0; i < MEASURE_N; ++i) {
+                file.Extract(result, positions[i] % (size - EXTRACT_LEN),
+                    EXTRACT_LEN);
+            }
+            t1 = get_timestamp();
+            double extract_us = (t1 - t0) * 1.0 / MEASURE_N;
+
+            size_t npa_bytes = file.GetNPA()->StorageSize();
+            size_t total_bytes = file.StorageSize();
+            LOG_E("NPA encoding %d: npa %zu bytes, total %zu bytes, "
+                "lookup %.1f ns, extract %.2f us (checksum %" PRIu64 ")\n",
+                scheme, npa_bytes, total_bytes, lookup_ns, extract_us, sum);
+            res_stream << scheme << "," << npa_bytes << "," << total_bytes
+                << "," << lookup_ns << "," << extract_us << "\n";
+        }
+    }
+
     void benchmark_node_node_throughput(
         const int num_threads,
         const std::string& master_hostname,
@@ -2960,6 +3454,7 @@ public:
         int64_t cnt;
         std::vector<std::string> attrs;
         time_t t0, t1;
+        std::vector<LatencyHistogram> histograms(NUM_TAO_OPS);
 
         LOG_E("Benchmarking TAO mixed query latency\n");
         try {
@@ -3020,6 +3515,7 @@ public:
                         mod_get(assoc_range_lens, i));
                     t1 = get_timestamp();
                     assoc_range_res << result.size() << "," << t1 - t0 << '\n';
+                    histograms[TAO_ASSOC_RANGE_OP].record(t1 - t0);
                     break;
                 case 1:
                     t0 = get_timestamp();
@@ -3028,12 +3524,14 @@ public:
                         mod_get(assoc_count_atypes, i));
                     t1 = get_timestamp();
                     assoc_count_res << cnt << "," << t1 - t0 << "\n";
+                    histograms[TAO_ASSOC_COUNT_OP].record(t1 - t0);
                     break;
                 case 2:
                     t0 = get_timestamp();
                     obj_get_f_(attrs, mod_get(obj_get_nodes, i));
                     t1 = get_timestamp();
                     obj_get_res << attrs.size() << "," << t1 - t0 << "\n";
+                    histograms[TAO_OBJ_GET_OP].record(t1 - t0);
                     break;
                 case 3:
                     t0 = get_timestamp();
@@ -3045,6 +3543,7 @@ public:
                         mod_get(assoc_get_highs, i));
                     t1 = get_timestamp();
                     assoc_get_res << result.size() << "," << t1 - t0 << "\n";
+                    histograms[TAO_ASSOC_GET_OP].record(t1 - t0);
                     break;
                 case 4:
                     t0 = get_timestamp();
@@ -3057,6 +3556,7 @@ public:
                     t1 = get_timestamp();
                     assoc_time_range_res << result.size() << "," << t1 - t0
                         << "\n";
+                    histograms[TAO_ASSOC_TIME_RANGE_OP].record(t1 - t0);
                     break;
                 default:
                     assert(false);
@@ -3066,6 +3566,7 @@ public:
         } catch (std::exception &e) {
             LOG_E("Exception: %s\n", e.what());
         }
+        write_latency_summary(histograms, 1, "tao_mix_latency");
     }
 
     void benchmark_tao_mix_with_updates_latency(
@@ -0,0 +1,158 @@
+#ifndef SUCCINCT_GRAPH_LATENCY_HISTOGRAM_H
+#define SUCCINCT_GRAPH_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Log-linear latency histogram in the style of HdrHistogram: values below
+// 2 * SUB_BUCKETS are recorded exactly, larger values land in one of
+// SUB_BUCKETS linear buckets per power of two, bounding the relative error
+// to 1 / SUB_BUCKETS (< 1%).  Recording is O(1) and allocation-free, so each
+// benchmark thread keeps its own histograms and merges them after joining.
+//
+// Values are unitless; the benchmarks record microseconds.
+class LatencyHistogram {
+public:
+    constexpr static int SUB_BUCKET_BITS = 7;
+    constexpr static int64_t SUB_BUCKETS = 1LL << SUB_BUCKET_BITS;
+    // Largest trackable value is 2^MAX_VALUE_BITS - 1; larger values are
+    // clamped (2^40 us is ~12 days).
+    constexpr static int MAX_VALUE_BITS = 40;
+
+    LatencyHistogram()
+        : counts_((MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS, 0),
+          total_count_(0),
+          min_(std::numeric_limits<int64_t>::max()),
+          max_(0),
+          sum_(0) {
+    }
+
+    inline void record(int64_t value, int64_t count = 1) {
+        value = std::max<int64_t>(0, std::min(value, MAX_VALUE));
+        counts_[index_of(value)] += count;
+        total_count_ += count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        sum_ += static_cast<double>(value) * count;
+    }
+
+    // Records `value`, and if it exceeds `expected_interval`, also the
+    // latencies the requests that a closed-loop client failed to issue while
+    // stalled would have seen (coordinated omission correction).
+    inline void record_corrected(int64_t value, int64_t expected_interval) {
+        record(value);
+        if (expected_interval <= 0) {
+            return;
+        }
+        for (int64_t missing = value - expected_interval;
+             missing >= expected_interval; missing -= expected_interval) {
+            record(missing);
+        }
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_count_ += other.total_count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        sum_ += other.sum_;
+    }
+
+    // Returns a copy corrected for coordinated omission after the fact, as if
+    // every value had been recorded with record_corrected().
+    LatencyHistogram corrected(int64_t expected_interval) const {
+        LatencyHistogram copy;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            if (counts_[i] == 0) {
+                continue;
+            }
+            int64_t value = highest_equivalent_value(i);
+            copy.record(value, counts_[i]);
+            if (expected_interval <= 0) {
+                continue;
+            }
+            for (int64_t missing = value - expected_interval;
+                 missing >= expected_interval; missing -= expected_interval) {
+                copy.record(missing, counts_[i]);
+            }
+        }
+        return copy;
+    }
+
+    // Smallest recorded value v such that `percentile` percent of all
+    // recorded values are <= v, up to the bucket resolution.
+    int64_t value_at_percentile(double percentile) const {
+        if (total_count_ == 0) {
+            return 0;
+        }
+        percentile = std::max(0.0, std::min(percentile, 100.0));
+        int64_t target = std::max<int64_t>(1,
+            static_cast<int64_t>(std::ceil(percentile / 100. * total_count_)));
+        int64_t cumulative = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            cumulative += counts_[i];
+            if (cumulative >= target) {
+                return std::min(highest_equivalent_value(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    inline int64_t count() const { return total_count_; }
+    inline int64_t min() const { return total_count_ == 0 ? 0 : min_; }
+    inline int64_t max() const { return max_; }
+    inline double mean() const {
+        return total_count_ == 0 ? 0 : sum_ / total_count_;
+    }
+
+    // Writes a flat JSON object with count, min, mean, max and the usual
+    // percentiles; `unit` is appended to the latency field names.
+    void write_json(std::ostream& out, const std::string& unit = "us") const {
+        out << "{\"count\": " << count()
+            << ", \"min_" << unit << "\": " << min()
+            << ", \"mean_" << unit << "\": " << mean()
+            << ", \"p50_" << unit << "\": " << value_at_percentile(50)
+            << ", \"p90_" << unit << "\": " << value_at_percentile(90)
+            << ", \"p99_" << unit << "\": " << value_at_percentile(99)
+            << ", \"p999_" << unit << "\": " << value_at_percentile(99.9)
+            << ", \"p9999_" << unit << "\": " << value_at_percentile(99.99)
+            << ", \"max_" << unit << "\": " << max() << "}";
+    }
+
+private:
+    constexpr static int64_t MAX_VALUE = (1LL << MAX_VALUE_BITS) - 1;
+
+    inline static size_t index_of(int64_t value) {
+        if (value < 2 * SUB_BUCKETS) {
+            return value;
+        }
+        int magnitude = 63 - __builtin_clzll(value);
+        int shift = magnitude - SUB_BUCKET_BITS;
+        return (shift * SUB_BUCKETS) + (value >> shift);
+    }
+
+    inline static int64_t highest_equivalent_value(size_t index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+        int shift = index / SUB_BUCKETS - 1;
+        int64_t lowest = (static_cast<int64_t>(index) - shift * SUB_BUCKETS)
+            << shift;
+        return lowest + (1LL << shift) - 1;
+    }
+
+    std::vector<int64_t> counts_;
+    int64_t total_count_;
+    int64_t min_;
+    int64_t max_;
+    double sum_;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef SUCCINCT_GRAPH_PERF_COUNTERS_H
+#define SUCCINCT_GRAPH_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Thin wrapper over a perf_event group counting CPU cycles, retired
+// instructions, cache misses, branch misses and data TLB load misses of the
+// calling thread (user space only).  Opening the group fails without
+// CAP_PERFMON or with kernel.perf_event_paranoid > 2, and in most containers;
+// available() is then false and all reads return zeros, so callers can always
+// use it.
+class PerfCounters {
+public:
+    enum Counter {
+        CYCLES = 0,
+        INSTRUCTIONS = 1,
+        CACHE_MISSES = 2,
+        BRANCH_MISSES = 3,
+        DTLB_MISSES = 4,
+        NUM_COUNTERS = 5
+    };
+
+    struct Values {
+        uint64_t counts[NUM_COUNTERS];
+        bool valid;
+
+        Values() : valid(false) {
+            memset(counts, 0, sizeof(counts));
+        }
+
+        uint64_t operator[](Counter c) const { return counts[c]; }
+    };
+
+    PerfCounters() : leader_fd_(-1) {
+#ifdef __linux__
+        const uint32_t types[NUM_COUNTERS] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+        };
+        const uint64_t configs[NUM_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+        };
+        for (int i = 0; i < NUM_COUNTERS; ++i) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[i];
+            attr.config = configs[i];
+            attr.disabled = (i == 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            int fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader_fd_, 0);
+            if (fd < 0) {
+                close_all();
+                return;
+            }
+            if (i == 0) {
+                leader_fd_ = fd;
+            }
+            fds_.push_back(fd);
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+        close_all();
+    }
+
+    inline bool available() const { return leader_fd_ >= 0; }
+
+    inline void start() {
+#ifdef __linux__
+        if (available()) {
+            ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    // Stops counting and returns the counts since the last start().
+    inline Values stop() {
+        Values values;
+#ifdef __linux__
+        if (!available()) {
+            return values;
+        }
+        ioctl(leader_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // Layout for PERF_FORMAT_GROUP: nr, then one value per counter.
+        uint64_t buf[1 + NUM_COUNTERS];
+        ssize_t expected = sizeof(buf);
+        if (read(leader_fd_, buf, sizeof(buf)) == expected
+            && buf[0] == NUM_COUNTERS) {
+            memcpy(values.counts, buf + 1, sizeof(values.counts));
+            values.valid = true;
+        }
+#endif
+        return values;
+    }
+
+private:
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+
+    void close_all() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            close(fd);
+        }
+#endif
+        fds_.clear();
+        leader_fd_ = -1;
+    }
+
+    int leader_fd_;
+    std::vector<int> fds_;
+};
+
+#endif
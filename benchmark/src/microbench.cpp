@@ -0,0 +1,593 @@
+#include "KVLogStore.h"
+#include "Numa.h"
+#include "PerfCounters.hpp"
+#include "SuccinctGraphSerde.hpp"
+#include "succinct_file.h"
+#include "utils.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// In-process microbenchmarks for the succinct-cpp primitives the graph
+// queries are built from (LookupNPA/SA/ISA, GetRange, Extract, ExtractUntil)
+// and for the SuccinctGraphSerde decoders.  Synthetic line-oriented shards
+// are constructed in memory for each NPA encoding and sampling scheme, and
+// each primitive is timed over a pool of precomputed random arguments, so no
+// cluster, Thrift or dataset is needed.  Where perf_event is available,
+// cycles, instructions, cache misses, branch misses and data TLB misses per
+// op are reported alongside ns/op.
+//
+// The KVLogStore n-gram index is timed against the index it replaced (a
+// hash map of uncompressed posting vectors, copied on every search) on the
+// same records, with the index sizes and build times reported alongside.
+//
+// -g none|thp|hugetlb selects the huge page policy the shards are built
+// with; comparing the dtlb/op of runs with and without shows what huge pages
+// save on the random NPA/SA/ISA accesses.
+//
+// With -n, each shard is constructed with its memory on the first NUMA node
+// and every primitive is timed from a thread pinned to each node in turn
+// (".../mem<m>-cpu<c>/..."), comparing local against remote access.
+//
+// Usage: microbench [-s small|medium|all] [-e enc,...] [-i scheme,...]
+//                   [-f filter] [-m min_secs] [-d tmp_dir] [-o out.csv] [-n]
+//                   [-g none|thp|hugetlb]
+
+// Number of precomputed arguments per primitive; a power of two.
+const size_t QUERY_POOL_SIZE = 1 << 16;
+
+const size_t SMALL_SHARD_BYTES = 1 << 20;
+const size_t MEDIUM_SHARD_BYTES = 16 << 20;
+
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct sampling_config_t {
+    const char* name;
+    SamplingScheme sa_scheme;
+    SamplingScheme isa_scheme;
+};
+
+const sampling_config_t SAMPLING_CONFIGS[] = {
+    { "flat-idx", FLAT_SAMPLE_BY_INDEX, FLAT_SAMPLE_BY_INDEX },
+    { "flat-val", FLAT_SAMPLE_BY_VALUE, FLAT_SAMPLE_BY_VALUE },
+    { "layered", LAYERED_SAMPLE_BY_INDEX, LAYERED_SAMPLE_BY_INDEX },
+    { "opp-layered", OPPORTUNISTIC_LAYERED_SAMPLE_BY_INDEX,
+        OPPORTUNISTIC_LAYERED_SAMPLE_BY_INDEX },
+    { "hybrid", FLAT_SAMPLE_BY_INDEX, HYBRID_SAMPLE_BY_INDEX },
+};
+const int NUM_SAMPLING_CONFIGS =
+    sizeof(SAMPLING_CONFIGS) / sizeof(SAMPLING_CONFIGS[0]);
+
+const char* NPA_ENCODING_NAMES[] = {
+    "wavelet-tree", "elias-delta", "elias-gamma", "interleaved-gamma",
+    "frame-of-ref"
+};
+const int NUM_NPA_ENCODINGS =
+    sizeof(NPA_ENCODING_NAMES) / sizeof(NPA_ENCODING_NAMES[0]);
+
+class MicroBenchmarkRunner {
+public:
+    MicroBenchmarkRunner(double min_secs, const std::string& filter,
+                         const std::string& csv_file)
+        : min_secs_(min_secs), filter_(filter) {
+
+        if (!counters_.available()) {
+            LOG_E("perf_event unavailable, reporting ns/op only\n");
+        }
+        if (!csv_file.empty()) {
+            csv_.open(csv_file);
+            csv_ << "name,iterations,ns_per_op,cycles_per_op,"
+                 << "instructions_per_op,cache_misses_per_op,"
+                 << "branch_misses_per_op,dtlb_misses_per_op\n";
+        }
+        LOG_E("%-60s %12s %10s %9s %9s %9s %9s %9s\n", "Benchmark",
+            "Iterations", "ns/op", "cyc/op", "ins/op", "llc/op", "br/op",
+            "dtlb/op");
+    }
+
+    // Runs op(i) for i = 0, 1, ... long enough to fill min_secs_, after a
+    // calibration pass that also warms caches, and reports per-op costs.
+    // op must return a value that depends on the work done.
+    template<typename Op>
+    void run(const std::string& name, Op op) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) {
+            return;
+        }
+
+        uint64_t iters = 64;
+        double secs = 0;
+        while (true) {
+            secs = time_iterations(op, iters);
+            if (secs >= min_secs_ / 10 || iters >= (1ULL << 40)) {
+                break;
+            }
+            iters *= (secs <= 0) ? 16 : std::min(16.,
+                std::max(2., 1.2 * min_secs_ / 10 / secs));
+        }
+        iters = std::max<uint64_t>(1,
+            iters * (min_secs_ / std::max(secs, 1e-9)));
+
+        counters_.start();
+        secs = time_iterations(op, iters);
+        PerfCounters::Values values = counters_.stop();
+
+        report(name, iters, secs, values);
+    }
+
+private:
+    template<typename Op>
+    double time_iterations(Op& op, uint64_t iters) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iters; ++i) {
+            do_not_optimize(op(i));
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    void report(const std::string& name, uint64_t iters, double secs,
+                const PerfCounters::Values& values) {
+        double ns_per_op = secs * 1e9 / iters;
+        double per_op[PerfCounters::NUM_COUNTERS];
+        for (int c = 0; c < PerfCounters::NUM_COUNTERS; ++c) {
+            per_op[c] = values.valid ? (double) values.counts[c] / iters : 0;
+        }
+
+        if (values.valid) {
+            LOG_E("%-60s %12" PRIu64 " %10.1f %9.1f %9.1f %9.3f %9.3f "
+                "%9.3f\n", name.c_str(), iters, ns_per_op,
+                per_op[PerfCounters::CYCLES],
+                per_op[PerfCounters::INSTRUCTIONS],
+                per_op[PerfCounters::CACHE_MISSES],
+                per_op[PerfCounters::BRANCH_MISSES],
+                per_op[PerfCounters::DTLB_MISSES]);
+        } else {
+            LOG_E("%-60s %12" PRIu64 " %10.1f %9s %9s %9s %9s %9s\n",
+                name.c_str(), iters, ns_per_op, "-", "-", "-", "-", "-");
+        }
+
+        if (csv_.is_open()) {
+            csv_ << name << "," << iters << "," << ns_per_op;
+            for (int c = 0; c < PerfCounters::NUM_COUNTERS; ++c) {
+                csv_ << ",";
+                if (values.valid) {
+                    csv_ << per_op[c];
+                }
+            }
+            csv_ << std::endl;
+        }
+    }
+
+    double min_secs_;
+    std::string filter_;
+    std::ofstream csv_;
+    PerfCounters counters_;
+};
+
+// Generates roughly `bytes` bytes of synthetic line-oriented records, loosely
+// shaped like a node table: variable-length records of skewed lowercase
+// attribute tokens and numbers.  Appends the record start offsets to
+// `record_starts`.
+std::string generate_records(size_t bytes,
+                             std::vector<uint64_t>& record_starts) {
+    std::mt19937_64 rng(bytes);
+    std::geometric_distribution<int> letter(0.25);
+    std::uniform_int_distribution<int> token_len(2, 12);
+    std::uniform_int_distribution<int> num_tokens(2, 24);
+
+    std::string data;
+    data.reserve(bytes + 1024);
+    while (data.size() < bytes) {
+        record_starts.push_back(data.size());
+        int tokens = num_tokens(rng);
+        for (int t = 0; t < tokens; ++t) {
+            if (t > 0) {
+                data += ' ';
+            }
+            if (rng() % 4 == 0) {
+                data += std::to_string(rng() % 1000000);
+                continue;
+            }
+            int len = token_len(rng);
+            for (int c = 0; c < len; ++c) {
+                data += (char) ('a' + std::min(letter(rng), 25));
+            }
+        }
+        data += '\n';
+    }
+    return data;
+}
+
+// Writes a synthetic shard of roughly `bytes` bytes (see generate_records).
+// Returns the record start offsets.
+std::vector<uint64_t> generate_shard(const std::string& path, size_t bytes) {
+    std::vector<uint64_t> record_starts;
+    std::ofstream out(path);
+    out << generate_records(bytes, record_starts);
+    return record_starts;
+}
+
+void bench_shard(MicroBenchmarkRunner& runner, const std::string& shard_name,
+                 const std::string& path,
+                 const std::vector<uint64_t>& record_starts,
+                 NPA::NPAEncodingScheme npa_encoding,
+                 const sampling_config_t& sampling, bool numa) {
+
+    std::string prefix = shard_name + "/" + NPA_ENCODING_NAMES[npa_encoding]
+        + "/" + sampling.name + "/";
+
+    // Without -n, the primitives run once, on whichever CPU (-1).
+    int mem_node = Numa::nodes()[0];
+    std::vector<int> cpu_nodes(1, -1);
+    if (numa) {
+        cpu_nodes = Numa::nodes();
+        Numa::pin_thread(mem_node);
+        Numa::prefer_node(mem_node);
+    }
+
+    time_t t0 = get_timestamp();
+    SuccinctFile file(path, SuccinctMode::CONSTRUCT_IN_MEMORY, 32, 32, 128,
+        sampling.sa_scheme, sampling.isa_scheme, npa_encoding);
+    LOG_E("# %s: constructed in %.1f s, %zu bytes\n", prefix.c_str(),
+        (get_timestamp() - t0) / 1e6, file.StorageSize());
+    if (numa) {
+        Numa::prefer_node(-1);
+    }
+
+    uint64_t n = file.GetOriginalSize();
+    std::mt19937_64 rng(n);
+    std::vector<uint64_t> positions(QUERY_POOL_SIZE);
+    std::vector<uint64_t> starts(QUERY_POOL_SIZE);
+    std::vector<std::string> patterns(QUERY_POOL_SIZE);
+    for (size_t i = 0; i < QUERY_POOL_SIZE; ++i) {
+        positions[i] = rng() % n;
+        starts[i] = record_starts[rng() % record_starts.size()];
+        file.Extract(patterns[i], rng() % (n - 16), 8);
+    }
+    const size_t mask = QUERY_POOL_SIZE - 1;
+    std::string result;
+
+    for (int node : cpu_nodes) {
+        std::string node_prefix = prefix;
+        if (node >= 0) {
+            Numa::pin_thread(node);
+            node_prefix += "mem" + std::to_string(mem_node) + "-cpu"
+                + std::to_string(node) + "/";
+        }
+        runner.run(node_prefix + "LookupNPA", [&](uint64_t i) {
+            return file.LookupNPA(positions[i & mask]);
+        });
+        runner.run(node_prefix + "LookupSA", [&](uint64_t i) {
+            return file.LookupSA(positions[i & mask]);
+        });
+        runner.run(node_prefix + "LookupISA", [&](uint64_t i) {
+            return file.LookupISA(positions[i & mask]);
+        });
+        runner.run(node_prefix + "LookupISA/record-start", [&](uint64_t i) {
+            return file.LookupISA(starts[i & mask]);
+        });
+        // SuccinctFile::GetRange is private; Count is a thin wrapper over it.
+        runner.run(node_prefix + "GetRange/8B", [&](uint64_t i) {
+            return file.Count(patterns[i & mask]);
+        });
+        runner.run(node_prefix + "Extract/64B", [&](uint64_t i) {
+            file.Extract(result, positions[i & mask] % (n - 64), 64);
+            return result.size();
+        });
+        runner.run(node_prefix + "ExtractUntil/record", [&](uint64_t i) {
+            return file.ExtractUntil(result, starts[i & mask], '\n');
+        });
+    }
+}
+
+void bench_serde(MicroBenchmarkRunner& runner) {
+    const int timestamp_width = 13;
+    const int node_id_width = 10;
+    const int list_len = 64;
+
+    std::mt19937_64 rng(0);
+    std::vector<std::string> node_ids(QUERY_POOL_SIZE);
+    std::string timestamps, dst_ids;
+    for (size_t i = 0; i < QUERY_POOL_SIZE; ++i) {
+        node_ids[i] = SuccinctGraphSerde::encode_node_id(rng() % 100000000,
+            node_id_width);
+    }
+    for (int i = 0; i < list_len; ++i) {
+        timestamps += SuccinctGraphSerde::encode_timestamp(
+            1400000000000LL + rng() % 100000000, timestamp_width);
+        dst_ids += node_ids[i];
+    }
+    const size_t mask = QUERY_POOL_SIZE - 1;
+
+    runner.run("serde/decode_node_id", [&](uint64_t i) {
+        return SuccinctGraphSerde::decode_node_id(node_ids[i & mask]);
+    });
+    runner.run("serde/decode_timestamp", [&](uint64_t i) {
+        return SuccinctGraphSerde::decode_timestamp(
+            timestamps.substr((i % list_len) * timestamp_width,
+                timestamp_width));
+    });
+    runner.run("serde/decode_multi_timestamps/64", [&](uint64_t i) {
+        return SuccinctGraphSerde::decode_multi_timestamps(timestamps,
+            timestamp_width).size();
+    });
+    runner.run("serde/decode_multi_node_ids/64", [&](uint64_t i) {
+        return SuccinctGraphSerde::decode_multi_node_ids(dst_ids,
+            node_id_width).size();
+    });
+}
+
+// The n-gram index KVLogStore used before posting lists were compressed: one
+// vector of 8-byte positions per (signed) 3-gram hash, copied out of the map
+// by every search, which also inserts the lists of absent n-grams.
+class LegacyNGramIndex {
+public:
+    explicit LegacyNGramIndex(const std::string& data,
+                              const std::vector<uint64_t>& record_starts)
+        : data_(data), record_starts_(record_starts) {
+        for (uint64_t i = 0; i + 3 <= data_.size(); i++) {
+            idx_[hash3(&data_[i])].push_back(i);
+        }
+    }
+
+    void search(std::set<int64_t>& result, const std::string& query) {
+        result.clear();
+        std::vector<uint64_t> idx_off = idx_[hash3(query.c_str())];
+        for (size_t i = 0; i < idx_off.size(); i++) {
+            uint64_t pos = idx_off[i];
+            if (pos + query.length() <= data_.size() &&
+                strncmp(&data_[pos] + 3, query.c_str() + 3,
+                    query.length() - 3) == 0) {
+                result.insert(std::upper_bound(record_starts_.begin(),
+                    record_starts_.end(), pos) - record_starts_.begin() - 1);
+            }
+        }
+    }
+
+    size_t storage_size() const {
+        size_t size = idx_.bucket_count() * sizeof(void*)
+            + idx_.size() * (sizeof(NGramIdx::value_type) + 2 * sizeof(void*));
+        for (auto& entry : idx_) {
+            size += entry.second.capacity() * sizeof(uint64_t);
+        }
+        return size;
+    }
+
+private:
+    typedef std::unordered_map<uint32_t, std::vector<uint64_t>> NGramIdx;
+
+    static uint32_t hash3(const char* buf) {
+        return buf[0] * 65536 + buf[1] * 256 + buf[2];
+    }
+
+    const std::string& data_;
+    const std::vector<uint64_t>& record_starts_;
+    NGramIdx idx_;
+};
+
+// Times KVLogStore::search for each n-gram length, with and without posting
+// list intersection, against LegacyNGramIndex, on the records of a synthetic
+// shard, for queries drawn from all records and from the most recently
+// written 1%.
+void bench_ngram_index(MicroBenchmarkRunner& runner,
+                       const std::string& shard_name, size_t bytes) {
+    std::vector<uint64_t> record_starts;
+    std::string data = generate_records(bytes, record_starts);
+    std::vector<std::string> records;
+    for (size_t i = 0; i < record_starts.size(); i++) {
+        uint64_t end = (i + 1 < record_starts.size()) ?
+            record_starts[i + 1] : data.size();
+        records.push_back(data.substr(record_starts[i],
+            end - record_starts[i]));
+    }
+
+    const size_t query_lens[] = { 4, 8, 16 };
+    const size_t mask = QUERY_POOL_SIZE - 1;
+    std::mt19937_64 rng(bytes);
+    std::map<std::string, std::vector<std::string>> pools;
+    for (size_t len : query_lens) {
+        std::string name = std::to_string(len) + "B";
+        std::vector<std::string>& all = pools[name];
+        std::vector<std::string>& recent = pools[name + "/recent"];
+        size_t num_recent = std::max<size_t>(1, records.size() / 100);
+        while (all.size() < QUERY_POOL_SIZE
+            || recent.size() < QUERY_POOL_SIZE) {
+            const std::string& any = records[rng() % records.size()];
+            const std::string& last = records[records.size() - 1
+                - rng() % num_recent];
+            if (any.size() > len) {
+                all.push_back(any.substr(rng() % (any.size() - len), len));
+            }
+            if (last.size() > len) {
+                recent.push_back(last.substr(rng() % (last.size() - len),
+                    len));
+            }
+        }
+        all.resize(QUERY_POOL_SIZE);
+        recent.resize(QUERY_POOL_SIZE);
+    }
+
+    std::set<int64_t> result;
+    std::string prefix = "logstore/" + shard_name + "/";
+    {
+        time_t t0 = get_timestamp();
+        LegacyNGramIndex legacy(data, record_starts);
+        LOG_E("# %slegacy: built in %.1f s, index %zu bytes for %zu bytes\n",
+            prefix.c_str(), (get_timestamp() - t0) / 1e6,
+            legacy.storage_size(), data.size());
+        for (auto& pool : pools) {
+            auto& queries = pool.second;
+            runner.run(prefix + "legacy/search/" + pool.first,
+                [&](uint64_t i) {
+                    legacy.search(result, queries[i & mask]);
+                    return result.size();
+                });
+        }
+    }
+
+    for (uint32_t n = NGramIndex::kMinN; n <= NGramIndex::kMaxN; n++) {
+        time_t t0 = get_timestamp();
+        KVLogStore store(0, 0, n);
+        for (auto& record : records) {
+            store.append(record);
+        }
+        std::string n_prefix = prefix + "n" + std::to_string(n) + "/";
+        LOG_E("# %s: built in %.1f s, index %zu bytes for %llu bytes\n",
+            n_prefix.c_str(), (get_timestamp() - t0) / 1e6,
+            store.index_size(), (unsigned long long) store.size());
+        // "rarest" only looks up the rarest n-gram of each query.
+        for (size_t ngrams : { KVLogStore::kDefaultSearchNGrams,
+                (size_t) 1 }) {
+            store.set_search_ngrams(ngrams);
+            std::string name = n_prefix + (ngrams == 1 ? "rarest/" : "search/");
+            for (auto& pool : pools) {
+                auto& queries = pool.second;
+                runner.run(name + pool.first, [&](uint64_t i) {
+                    store.search(result, queries[i & mask]);
+                    return result.size();
+                });
+            }
+        }
+    }
+}
+
+std::vector<int> parse_int_list(const std::string& list) {
+    std::vector<int> result;
+    std::stringstream ss(list);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        result.push_back(std::stoi(token));
+    }
+    return result;
+}
+
+void print_usage(char *exec) {
+    LOG_E("Usage: %s [-s small|medium|all] [-e npa_encodings] "
+        "[-i sampling_configs] [-f filter] [-m min_secs] [-d tmp_dir] "
+        "[-o out.csv] [-n (NUMA local vs remote)] "
+        "[-g none|thp|hugetlb (huge pages)]\n", exec);
+    LOG_E("NPA encodings:");
+    for (int i = 0; i < NUM_NPA_ENCODINGS; ++i) {
+        LOG_E(" %d=%s", i, NPA_ENCODING_NAMES[i]);
+    }
+    LOG_E("\nSampling configs:");
+    for (int i = 0; i < NUM_SAMPLING_CONFIGS; ++i) {
+        LOG_E(" %d=%s", i, SAMPLING_CONFIGS[i].name);
+    }
+    LOG_E("\n");
+}
+
+int main(int argc, char **argv) {
+    std::string sizes = "all";
+    std::string filter;
+    std::string tmp_dir = "/tmp";
+    std::string csv_file;
+    double min_secs = 0.5;
+    bool numa = false;
+    std::vector<int> encodings;
+    std::vector<int> configs;
+
+    int c;
+    while ((c = getopt(argc, argv, "s:e:i:f:m:d:o:ng:h")) != -1) {
+        switch (c) {
+        case 's':
+            sizes = std::string(optarg);
+            break;
+        case 'e':
+            encodings = parse_int_list(optarg);
+            break;
+        case 'i':
+            configs = parse_int_list(optarg);
+            break;
+        case 'f':
+            filter = std::string(optarg);
+            break;
+        case 'm':
+            min_secs = atof(optarg);
+            break;
+        case 'd':
+            tmp_dir = std::string(optarg);
+            break;
+        case 'o':
+            csv_file = std::string(optarg);
+            break;
+        case 'n':
+            numa = true;
+            break;
+        case 'g':
+            if (std::string(optarg) == "thp") {
+                SuccinctAllocator::SetHugePagePolicy(TRANSPARENT_HUGEPAGES);
+            } else if (std::string(optarg) == "hugetlb") {
+                SuccinctAllocator::SetHugePagePolicy(EXPLICIT_HUGEPAGES);
+            }
+            break;
+        default:
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (encodings.empty()) {
+        // In-memory construction of the wavelet tree and Elias delta NPAs
+        // is currently broken, so they only run when asked for with -e.
+        encodings = { NPA::ELIAS_GAMMA_ENCODED,
+            NPA::INTERLEAVED_ELIAS_GAMMA_ENCODED,
+            NPA::FRAME_OF_REFERENCE_ENCODED };
+    }
+    if (configs.empty()) {
+        for (int i = 0; i < NUM_SAMPLING_CONFIGS; ++i) {
+            configs.push_back(i);
+        }
+    }
+
+    std::vector<std::pair<std::string, size_t>> shards;
+    if (sizes == "small" || sizes == "all") {
+        shards.push_back(std::make_pair("small", SMALL_SHARD_BYTES));
+    }
+    if (sizes == "medium" || sizes == "all") {
+        shards.push_back(std::make_pair("medium", MEDIUM_SHARD_BYTES));
+    }
+    if (shards.empty()) {
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    MicroBenchmarkRunner runner(min_secs, filter, csv_file);
+    if (numa && Numa::nodes().size() < 2) {
+        LOG_E("# single NUMA node: -n only times local access\n");
+    }
+    bench_serde(runner);
+
+    for (auto& shard : shards) {
+        bench_ngram_index(runner, shard.first, shard.second);
+
+        std::string path = tmp_dir + "/microbench_" + shard.first + ".txt";
+        std::vector<uint64_t> record_starts = generate_shard(path,
+            shard.second);
+        for (int enc : encodings) {
+            assert(enc >= 0 && enc < NUM_NPA_ENCODINGS);
+            for (int cfg : configs) {
+                assert(cfg >= 0 && cfg < NUM_SAMPLING_CONFIGS);
+                bench_shard(runner, shard.first, path, record_starts,
+                    (NPA::NPAEncodingScheme) enc, SAMPLING_CONFIGS[cfg], numa);
+            }
+        }
+        unlink(path.c_str());
+    }
+
+    return 0;
+}
@@ -93,9 +93,14 @@ int main(int argc, char **argv) {
 
     int throughput_threads = 1;
 
+    // Open-loop benchmark: comma-separated target rates (queries/sec) and
+    // arrival process ("poisson" or "constant").
+    std::vector<double> target_rates;
+    bool poisson_arrivals = true;
+
     // TODO: how the script uses these here is a mess.
     while ((c = getopt(
-        argc, argv, "t:x:y:z:w:q:a:b:c:d:e:f:o:h:i:j:k:r:s:p:g:l:m:")) != -1)
+        argc, argv, "t:x:y:z:w:q:a:b:c:d:e:f:o:h:i:j:k:r:s:p:g:l:m:u:v:")) != -1)
     {
         switch(c) {
         case 't':
@@ -164,6 +169,17 @@ int main(int argc, char **argv) {
         case 'm':
             master_hostname = std::string(optarg);
             break;
+        case 'u': {
+            std::stringstream rates(optarg);
+            std::string rate;
+            while (std::getline(rates, rate, ',')) {
+                target_rates.push_back(std::stod(rate));
+            }
+            break;
+        }
+        case 'v':
+            poisson_arrivals = (std::string(optarg) != "constant");
+            break;
         }
     }
 
@@ -465,6 +481,32 @@ int main(int argc, char **argv) {
             warmup_assoc_time_range_file, // assoc_time_range
             query_assoc_time_range_file);
 
+    } else if (type == "tao-mix-open-loop") {
+
+        bench->benchmark_tao_mix_open_loop(
+            throughput_threads,
+            master_hostname,
+            target_rates,
+            poisson_arrivals,
+            result_file_name,
+            warmup_neighbor_file, // assoc_range
+            measure_neighbor_file,
+            warmup_query_file, // assoc_count
+            measure_query_file,
+            warmup_nhbr_node_file, // obj_get
+            nhbr_node_file,
+            warmup_node_file, // assoc_get
+            query_node_file,
+            warmup_assoc_time_range_file, // assoc_time_range
+            query_assoc_time_range_file);
+
+    } else if (type == "npa-latency") {
+
+        // Encodes the node file with each NPA encoding; see
+        // GraphBenchmark::benchmark_npa_encodings().
+        bench->benchmark_npa_encodings(result_file_name, warmup_n, measure_n,
+            node_file);
+
     } else if (type == "graph-format") {
 
         GraphFormatter::format_node_file(node_file);
@@ -1036,16 +1036,28 @@ int main(int argc, char **argv) {
         std::string node_file(argv[2]);
         std::string edge_file(argv[3]);
         int sa_sr = 64, isa_sr = 64, npa_sr = 256;
+        int npa_enc = NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED;
+        int isa_scheme = SamplingScheme::FLAT_SAMPLE_BY_INDEX;
         if (argc > 4) {
             sa_sr = std::stoi(argv[4]);
             isa_sr = std::stoi(argv[5]);
             npa_sr = std::stoi(argv[6]);
         }
+        if (argc > 7) {
+            // See NPA::NPAEncodingScheme for the values
+            npa_enc = std::stoi(argv[7]);
+        }
+        if (argc > 8) {
+            // See SamplingScheme for the values
+            isa_scheme = std::stoi(argv[8]);
+        }
 
         SuccinctGraph* graph = new SuccinctGraph("", true); // no-op
         graph->set_npa_sampling_rate(npa_sr);
         graph->set_sa_sampling_rate(sa_sr);
         graph->set_isa_sampling_rate(isa_sr);
+        graph->set_npa_encoding_scheme((NPA::NPAEncodingScheme) npa_enc);
+        graph->set_isa_sampling_scheme((SamplingScheme) isa_scheme);
         graph->construct(node_file, edge_file);
 
         printf("SuccinctGraph construction done\n");
@@ -1,14 +1,30 @@
+#include "DeletedEdges.h"
 #include "FileSuffixStore.h"
 #include "GraphFormatter.hpp"
 #include "GraphLogStore.h"
 #include "GraphSuffixStore.h"
 #include "KVLogStore.h"
 #include "KVSuffixStore.h"
+#include "NGramIndex.h"
+#include "ReplicaSelector.h"
+#include "Router.h"
+#include "ShardMap.h"
 #include "SuccinctGraph.hpp"
 #include "utils.h"
 
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 
 void assert_eq(
     const std::vector<SuccinctGraph::Assoc>& actual,
@@ -69,14 +85,20 @@ void test_kv_log_store() {
     KVLogStore kv_log_store(0);
 
     kv_log_store.get_value(ret, 0);
-    assert(ret == "1618");
+    assert(ret == "");
+    kv_log_store.search(keys, "1618");
+    assert_eq(keys, { });
 
+    assert(kv_log_store.append("1618") == 0);
+    kv_log_store.get_value(ret, 0);
+    assert(ret == "1618");
     kv_log_store.search(keys, "1618");
     assert_eq(keys, { 0 });
     kv_log_store.search(keys, "kkk");
     assert_eq(keys, { });
 
-    kv_log_store.append("sup");
+    assert(kv_log_store.append("Martin") == 1);
+    assert(kv_log_store.append("sup") == 2);
     kv_log_store.get_value(ret, 2);
     assert(ret == "sup");
 
@@ -87,6 +109,331 @@ void test_kv_log_store() {
     kv_log_store.append("1619");
     kv_log_store.search(keys, "1619");
     assert_eq(keys, { 4 });
+
+    // Replacing a value hides the old one from searches
+    assert(kv_log_store.insert(1, "Mahler") == 1);
+    kv_log_store.get_value(ret, 1);
+    assert(ret == "Mahler");
+    kv_log_store.search(keys, "Martin");
+    assert_eq(keys, { });
+    kv_log_store.search(keys, "Mahler");
+    assert_eq(keys, { 1 });
+
+    // Keys far from the appended ones, and the next one, which appends
+    // then skip
+    assert(kv_log_store.insert(1LL << 40, "far") == 1LL << 40);
+    assert(kv_log_store.insert(5, "next") == 5);
+    assert(kv_log_store.append("after") == 6);
+    kv_log_store.get_value(ret, 1LL << 40);
+    assert(ret == "far");
+    kv_log_store.get_value(ret, 5);
+    assert(ret == "next");
+    kv_log_store.search(keys, "far");
+    assert_eq(keys, { 1LL << 40 });
+
+    // Removed keys are gone, and may be inserted again
+    assert(kv_log_store.remove(3));
+    assert(!kv_log_store.remove(3));
+    assert(kv_log_store.remove(1LL << 40));
+    kv_log_store.get_value(ret, 3);
+    assert(ret == "");
+    kv_log_store.get_value(ret, 1LL << 40);
+    assert(ret == "");
+    kv_log_store.search(keys, "1618");
+    assert_eq(keys, { 0 });
+    assert(kv_log_store.insert(3, "1618 again") == 3);
+    kv_log_store.search(keys, "1618");
+    assert_eq(keys, { 0, 3 });
+    assert(!kv_log_store.remove(1LL << 41));
+
+    // Keys with a value: the appended ones ascending, then inserted ones
+    std::vector<int64_t> live_keys;
+    assert(kv_log_store.insert(1LL << 40, "far again") == 1LL << 40);
+    kv_log_store.keys(live_keys);
+    assert(live_keys
+        == std::vector<int64_t>({ 0, 1, 2, 3, 4, 5, 6, 1LL << 40 }));
+}
+
+void test_kv_log_store_segments() {
+    const uint64_t segment = KVLogStore::kSegmentSize;
+    KVLogStore kv_log_store(0, 3 * segment);
+    std::string ret;
+    std::set<int64_t> keys;
+
+    // The second value does not fit what is left of the first segment: the
+    // rest of it is filler, and the value starts the next one
+    std::string first(segment / 2, 'a');
+    std::string second = "start" + std::string(segment / 2, 'b') + "end";
+    assert(kv_log_store.append(first) == 0);
+    assert(kv_log_store.append(second) == 1);
+    assert(kv_log_store.size() == segment + second.length());
+    assert(kv_log_store.append("small") == 2);
+    kv_log_store.get_value(ret, 1);
+    assert(ret == second);
+    kv_log_store.get_value(ret, 2);
+    assert(ret == "small");
+
+    // Matches are reported for the values they are in, never the filler;
+    // short queries scan the segments
+    kv_log_store.search(keys, "start");
+    assert_eq(keys, { 1 });
+    kv_log_store.search(keys, "aab");
+    assert_eq(keys, { });
+    kv_log_store.search(keys, "ab");
+    assert_eq(keys, { });
+    kv_log_store.search(keys, "b");
+    assert_eq(keys, { 1 });
+    kv_log_store.search(keys, "sm");
+    assert_eq(keys, { 2 });
+
+    // A value longer than a segment, or past the capacity, is refused
+    assert(kv_log_store.append(std::string(segment + 1, 'c')) == -1);
+    assert(kv_log_store.append(std::string(segment, 'd')) == 3);
+    assert(kv_log_store.append("tiny") == -1);
+    kv_log_store.get_value(ret, 3);
+    assert(ret == std::string(segment, 'd'));
+    kv_log_store.search(keys, "ddd");
+    assert_eq(keys, { 3 });
+    kv_log_store.search(keys, "small");
+    assert_eq(keys, { 2 });
+}
+
+void test_kv_log_store_search() {
+    // Values over a small alphabet, so that the n-grams of a query have
+    // long, overlapping posting lists; '#' ends each value, so that no match
+    // spans two
+    std::mt19937 rng(11);
+    std::vector<std::string> values;
+    KVLogStore kv_log_store(0, KVLogStore::kSegmentSize);
+    for (int64_t key = 0; key < 3000; ++key) {
+        std::string value;
+        size_t length = 1 + rng() % 40;
+        for (size_t i = 0; i < length; ++i) {
+            value += "abcd"[rng() % 4];
+        }
+        value += '#';
+        assert(kv_log_store.append(value) == key);
+        values.push_back(value);
+    }
+
+    std::set<int64_t> keys;
+    for (size_t max_ngrams : { 1, 2, 4, 16 }) {
+        kv_log_store.set_search_ngrams(max_ngrams);
+        for (int trial = 0; trial < 200; ++trial) {
+            // Substrings of a value, and random strings, of every length
+            const std::string& from = values[rng() % values.size()];
+            size_t length = 1 + trial % 12;
+            std::string query;
+            if (trial % 2 == 0 && length < from.length()) {
+                query = from.substr(rng() % (from.length() - length),
+                                    length);
+            } else {
+                for (size_t i = 0; i < length; ++i) {
+                    query += "abcd"[rng() % 4];
+                }
+                if (trial % 4 == 1) {
+                    query.back() = '#';
+                }
+            }
+            std::set<int64_t> expected;
+            for (size_t key = 0; key < values.size(); ++key) {
+                if (values[key].find(query) != std::string::npos) {
+                    expected.insert(key);
+                }
+            }
+            kv_log_store.search(keys, query);
+            assert(keys == expected);
+        }
+    }
+}
+
+void test_ngram_index() {
+    // Postings spanning many blocks, with gaps of every varint length
+    std::mt19937 rng(5);
+    std::vector<uint64_t> postings;
+    PostingList list;
+    uint64_t pos = 0;
+    for (int i = 0; i < 1000; ++i) {
+        pos += 1 + (rng() % 3 == 0 ? rng() % 100000 : rng() % 100);
+        list.append(pos);
+        postings.push_back(pos);
+    }
+    assert(list.size() == postings.size());
+
+    PostingList::Iterator it(list);
+    for (uint64_t expected : postings) {
+        assert(it.valid() && it.value() == expected);
+        it.next();
+    }
+    assert(!it.valid());
+
+    // Seeks land on the first posting at or after their target, forward only
+    for (int trial = 0; trial < 100; ++trial) {
+        PostingList::Iterator seeker(list);
+        uint64_t target = 0;
+        for (int step = 0; step < 5; ++step) {
+            target += rng() % (pos / 4);
+            seeker.seek(target);
+            auto expected = std::lower_bound(postings.begin(),
+                                             postings.end(), target);
+            if (expected == postings.end()) {
+                assert(!seeker.valid());
+                break;
+            }
+            assert(seeker.valid() && seeker.value() == *expected);
+        }
+    }
+
+    // The index round trips through serialize()
+    NGramIndex index(3);
+    const char* text = "abcabcabd";
+    for (uint64_t i = 0; i + 3 <= strlen(text); ++i) {
+        index.add(index.key(text + i), i);
+    }
+    std::ostringstream out;
+    size_t size = index.serialize(out);
+    std::string bytes = out.str();
+    assert(size == bytes.size());
+
+    NGramIndex loaded(2);
+    assert(loaded.deserialize(
+        reinterpret_cast<const uint8_t*>(bytes.data())) == size);
+    assert(loaded.n() == 3);
+    const PostingList* abc = loaded.find(loaded.key("abc"));
+    assert(abc != nullptr && abc->size() == 2);
+    PostingList::Iterator abc_it(*abc);
+    assert(abc_it.value() == 0);
+    abc_it.next();
+    assert(abc_it.value() == 3);
+    assert(loaded.find(loaded.key("abd"))->size() == 1);
+    assert(loaded.find(loaded.key("bda")) == nullptr);
+}
+
+void test_kv_log_store_concurrent() {
+    // Writers append values that tell their own length; readers check that
+    // every value they see is whole
+    KVLogStore kv_log_store(0, 4 * KVLogStore::kSegmentSize);
+    const int kWriters = 4, kValues = 5000;
+    std::atomic<int64_t> max_key(-1);
+    std::atomic<bool> done(false);
+    std::vector<std::vector<int64_t>> written(kWriters);
+
+    auto make_value = [](int writer, int i) {
+        std::string value = "w" + std::to_string(writer) + "-"
+            + std::to_string(i) + ":";
+        return value + std::string(i % 300, 'a' + writer) + "#";
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < kWriters; ++w) {
+        threads.emplace_back([&, w] {
+            for (int i = 0; i < kValues; ++i) {
+                int64_t key = kv_log_store.append(make_value(w, i));
+                assert(key >= 0);
+                written[w].push_back(key);
+                int64_t seen = max_key.load();
+                while (key > seen && !max_key.compare_exchange_weak(seen, key)) {
+                }
+            }
+        });
+    }
+    std::atomic<uint64_t> reads(0);
+    for (int r = 0; r < 2; ++r) {
+        threads.emplace_back([&, r] {
+            std::mt19937 rng(r);
+            std::string value;
+            while (!done.load()) {
+                int64_t max = max_key.load();
+                if (max < 0) {
+                    continue;
+                }
+                kv_log_store.get_value(value, rng() % (max + 1));
+                if (value.empty()) {
+                    continue;  // Appended, but not published yet
+                }
+                int writer, i;
+                assert(sscanf(value.c_str(), "w%d-%d:", &writer, &i) == 2);
+                assert(value == make_value(writer, i));
+                reads++;
+            }
+        });
+    }
+    for (int w = 0; w < kWriters; ++w) {
+        threads[w].join();
+    }
+    done = true;
+    for (size_t t = kWriters; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    assert(reads > 0);
+
+    std::string value;
+    std::set<int64_t> keys;
+    for (int w = 0; w < kWriters; ++w) {
+        for (int i = 0; i < kValues; ++i) {
+            kv_log_store.get_value(value, written[w][i]);
+            assert(value == make_value(w, i));
+        }
+        kv_log_store.search(keys, "w" + std::to_string(w) + "-1234:");
+        assert_eq(keys, { written[w][1234] });
+    }
+}
+
+void test_kv_log_store_snapshot() {
+    std::string path = "tests/kv_log_store_snapshot";
+    std::string ret;
+    std::set<int64_t> keys;
+    std::vector<std::string> values;
+    {
+        KVLogStore kv_log_store(100, 3 * KVLogStore::kSegmentSize);
+        for (int i = 0; i < 1000; ++i) {
+            std::string value = "value" + std::to_string(i) + "#";
+            if (i % 250 == 0) {
+                value += std::string(KVLogStore::kSegmentSize / 3, 'x');
+            }
+            assert(kv_log_store.append(value) == 100 + i);
+            values.push_back(value);
+        }
+        kv_log_store.insert(1LL << 40, "far");
+        kv_log_store.insert(150, "replaced");
+        kv_log_store.remove(151);
+        assert(kv_log_store.save(path));
+    }
+
+    {
+        KVLogStore restored(100, 3 * KVLogStore::kSegmentSize);
+        assert(restored.load(path));
+        assert(!restored.load(path));
+        for (int i = 0; i < 1000; ++i) {
+            restored.get_value(ret, 100 + i);
+            assert(ret == (i == 50 ? "replaced" : i == 51 ? "" : values[i]));
+        }
+        restored.get_value(ret, 1LL << 40);
+        assert(ret == "far");
+        restored.search(keys, "value37#");
+        assert_eq(keys, { 137 });
+        restored.search(keys, "value51#");
+        assert_eq(keys, { });
+
+        // Appends go on after the restored keys and values
+        assert(restored.append("fresh") == 1100);
+        restored.get_value(ret, 1100);
+        assert(ret == "fresh");
+        restored.search(keys, "fresh");
+        assert_eq(keys, { 1100 });
+        restored.get_value(ret, 137);
+        assert(ret == values[37]);
+    }
+
+    // Snapshots of other stores, and truncated ones, are refused
+    KVLogStore other(7, 3 * KVLogStore::kSegmentSize);
+    assert(!other.load(path));
+    truncate(path.c_str(), 4096);
+    KVLogStore truncated(100, 3 * KVLogStore::kSegmentSize);
+    assert(!truncated.load(path));
+    truncated.get_value(ret, 100);
+    assert(ret == "");
+    std::remove(path.c_str());
 }
 
 void test_kv_suffix_store() {
@@ -409,6 +756,175 @@ void test_structured_edge_table() {
 
     assocs = edge_table.assoc_range(0, 0, 0, 100);
     assert_eq(assocs, { { 0, 1, 0, 0, "newer" }, { 0, 0, 0, 0, "" } });
+
+    // An older edge goes in time order
+    edge_table.add_assoc(0, 2, 0, 20, "b");
+    edge_table.add_assoc(0, 3, 0, 10, "a");
+    assocs = edge_table.assoc_range(0, 0, 0, 2);
+    assert_eq(assocs, { { 0, 2, 0, 20, "b" }, { 0, 3, 0, 10, "a" } });
+
+    assocs = edge_table.assoc_time_range(0, 0, 5, 15, 100);
+    assert_eq(assocs, { { 0, 3, 0, 10, "a" } });
+
+    assocs = edge_table.assoc_time_range(0, 0, 0, 10, 2);
+    assert_eq(assocs, { { 0, 3, 0, 10, "a" }, { 0, 1, 0, 0, "newer" } });
+
+    assocs = edge_table.assoc_time_range(0, 0, 21, 30, 100);
+    assert_eq(assocs, { });
+
+    assocs = edge_table.assoc_get(0, 0, { 1, 2, 3 }, 0, 15);
+    assert_eq(assocs, { { 0, 3, 0, 10, "a" }, { 0, 1, 0, 0, "newer" } });
+
+    // Enough edges for the list to index its destinations
+    for (int64_t dst = 100; dst < 200; ++dst) {
+        edge_table.add_assoc(0, dst, 0, 100 + dst, "");
+    }
+    assocs = edge_table.assoc_get(0, 0, { 3, 150 }, 0, 1000);
+    assert_eq(assocs, { { 0, 150, 0, 250, "" }, { 0, 3, 0, 10, "a" } });
+
+    // A snapshot restores every list; a truncated one restores nothing
+    std::string path = "tests/edge_table_snapshot";
+    assert(edge_table.save(path));
+    StructuredEdgeTable restored;
+    assert(restored.load(path));
+    assert(restored.num_edges() == edge_table.num_edges());
+    assocs = restored.assoc_range(0, 0, 0, 104);
+    std::vector<SuccinctGraph::Assoc> saved =
+        edge_table.assoc_range(0, 0, 0, 104);
+    assert(assocs.size() == saved.size());
+    for (size_t i = 0; i < saved.size(); ++i) {
+        assert(assocs[i].dst_id == saved[i].dst_id);
+        assert(assocs[i].time == saved[i].time);
+        assert(assocs[i].attr == saved[i].attr);
+    }
+    assocs = restored.assoc_get(0, 0, { 3, 150 }, 0, 1000);
+    assert_eq(assocs, { { 0, 150, 0, 250, "" }, { 0, 3, 0, 10, "a" } });
+
+    std::string snapshot;
+    {
+        std::ifstream in(path, std::ios::binary);
+        snapshot.assign(std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>());
+    }
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(snapshot.data(), snapshot.size() - 1);
+    StructuredEdgeTable truncated;
+    assert(!truncated.load(path));
+    assert(truncated.num_edges() == 0);
+    assert_eq(truncated.assoc_range(0, 0, 0, 104), { });
+    std::remove(path.c_str());
+
+    // Deleting a destination erases all of its edges, wherever they are in
+    // the list, and leaves the others and their attributes in order
+    edge_table.add_assoc(0, 7, 0, 120, "x");
+    edge_table.add_assoc(0, 7, 0, 1000, "y");
+    edge_table.add_assoc(0, 7, 0, 5, "z");
+    assert(edge_table.assoc_count(0, 0) == 107);
+    assert(edge_table.deleteLink(0, 0, 7));
+    assert(!edge_table.deleteLink(0, 0, 7));
+    assert(edge_table.assoc_count(0, 0) == 104);
+    assert(edge_table.num_edges() == 104);
+    assocs = edge_table.assoc_range(0, 0, 0, 104);
+    for (size_t i = 0; i < saved.size(); ++i) {
+        assert(assocs[i].dst_id == saved[i].dst_id);
+        assert(assocs[i].time == saved[i].time);
+        assert(assocs[i].attr == saved[i].attr);
+    }
+    assert(edge_table.deleteLink(0, 0, 150));
+    assocs = edge_table.assoc_get(0, 0, { 3, 149, 150, 151 }, 0, 1000);
+    assert_eq(assocs, { { 0, 151, 0, 251, "" }, { 0, 149, 0, 249, "" },
+                        { 0, 3, 0, 10, "a" } });
+
+    // Every list with edges left goes under the shard of its source, for
+    // the update pointers rebuilt after a restore
+    edge_table.add_assoc(3, 1, 2, 0, "");
+    edge_table.add_assoc(4, 1, 0, 0, "");
+    edge_table.add_assoc(5, 1, 0, 0, "");
+    assert(edge_table.deleteLink(5, 0, 1));
+    std::unordered_map<int, GraphFormatter::AssocSet> edge_updates;
+    edge_table.build_backfill_edge_updates(edge_updates, ModuloShardRouter(2));
+    assert(edge_updates.size() == 2);
+    assert(edge_updates[0] == GraphFormatter::AssocSet({ { 0, 0 }, { 4, 0 } }));
+    assert(edge_updates[1] == GraphFormatter::AssocSet({ { 3, 2 } }));
+}
+
+void test_deleted_edges() {
+    // Lists of several sizes, spanning several directory blocks, and
+    // straddling their boundaries
+    std::vector<DeletedEdges::edge_record_id> record_ids;
+    std::vector<int64_t> offsets;
+    const int64_t sizes[] = { 300, 700, 1, 1000, 5, 600 };
+    int64_t num_edges = 0;
+    for (int64_t i = 0; i < 6; ++i) {
+        record_ids.push_back({ i, i % 2 });
+        offsets.push_back(num_edges);
+        num_edges += sizes[i];
+    }
+    assert(num_edges > 4 * (int64_t) DeletedEdges::kBlockBits);
+
+    std::string log_file = "tests/deleted_edges_log";
+    std::remove(log_file.c_str());
+    DeletedEdges deleted(record_ids, offsets, num_edges);
+    assert(deleted.OpenLog(log_file));
+
+    // Deletes a third of the edges of each list, some of them twice; the
+    // first list loses a whole block's worth
+    std::mt19937 rng(7);
+    std::vector<bool> expected(num_edges, false);
+    for (int64_t i = 0; i < 6; ++i) {
+        for (int64_t e = 0; e < sizes[i]; ++e) {
+            bool del = i == 0 ? e < 200 : rng() % 3 == 0;
+            if (del) {
+                assert(deleted.Delete(i, i % 2, e));
+                expected[offsets[i] + e] = true;
+                if (rng() % 4 == 0) {
+                    assert(!deleted.Delete(i, i % 2, e));
+                }
+            }
+        }
+    }
+    assert(!deleted.Delete(0, 1, 0));
+    assert(!deleted.Delete(42, 0, 0));
+
+    auto check = [&](DeletedEdges& edges) {
+        for (int64_t i = 0; i < 6; ++i) {
+            int64_t list_off = edges.ListOffset(i, i % 2);
+            assert(list_off == offsets[i]);
+            for (int64_t e = 0; e < sizes[i]; ++e) {
+                assert(edges.IsDeleted(i, i % 2, e)
+                       == expected[list_off + e]);
+            }
+            for (int trial = 0; trial < 50; ++trial) {
+                int64_t begin = rng() % (sizes[i] + 1);
+                int64_t end = begin + rng() % (sizes[i] - begin + 1);
+                int64_t count = 0;
+                std::vector<int64_t> live;
+                for (int64_t e = begin; e < end; ++e) {
+                    if (expected[list_off + e]) {
+                        ++count;
+                    } else {
+                        live.push_back(e);
+                    }
+                }
+                assert(edges.CountDeleted(list_off, begin, end) == count);
+                for (size_t k = 0; k <= live.size(); ++k) {
+                    int64_t selected = edges.SelectLive(list_off, begin, k,
+                                                        end);
+                    assert(selected == (k < live.size() ? live[k] : end));
+                }
+            }
+        }
+        assert(edges.CountDeleted(0, 0, num_edges)
+               == std::count(expected.begin(), expected.end(), true));
+    };
+    check(deleted);
+
+    // Replaying the log onto a fresh bitmap restores the same deletes
+    DeletedEdges reopened(record_ids, offsets, num_edges);
+    assert(reopened.OpenLog(log_file));
+    check(reopened);
+    assert(!reopened.Delete(0, 0, 0));
+    std::remove(log_file.c_str());
 }
 
 void test_file_suffix_store() {
@@ -510,15 +1026,132 @@ void test_file_suffix_store2() {
     std::remove(edge_table_file.c_str());
 }
 
+void test_shard_map() {
+    ShardMap shard_map(4);
+    assert(shard_map.shard_of(10) == 2);
+    assert(shard_map.local_key(10) == 2);
+    assert(shard_map.global_key(2, 2) == 10);
+
+    shard_map.move(10, 1, 7);
+    shard_map.move(3, 0, 9);
+    assert(shard_map.shard_of(10) == 1);
+    assert(shard_map.local_key(10) == 7);
+    assert(shard_map.global_key(1, 7) == 10);
+    assert(shard_map.global_key(0, 9) == 3);
+    assert(shard_map.global_key(1, 6) == 25);
+
+    std::string map_file(GraphFormatter::write_to_temp_file(""));
+    assert(shard_map.save(map_file));
+    ShardMap loaded(4);
+    assert(loaded.load(map_file));
+    assert(loaded.num_moved() == 2);
+    assert(loaded.shard_of(3) == 0);
+    assert(loaded.global_key(1, 7) == 10);
+
+    // Saved for another number of shards
+    ShardMap other(5);
+    assert(!other.load(map_file));
+    assert(other.num_moved() == 0);
+
+    std::remove(map_file.c_str());
+}
+
+void test_replica_selector() {
+    ReplicaSelector by_outstanding(3, ReplicaSelector::Policy::OUTSTANDING);
+    std::vector<int32_t> hosts = { 0, 1, 2 };
+    // Ties go to the preferred host
+    assert(by_outstanding.pick(hosts, 1) == 1);
+    {
+        ReplicaSelector::Call busy0 = by_outstanding.begin(0);
+        ReplicaSelector::Call busy1 = by_outstanding.begin(1);
+        assert(by_outstanding.outstanding(1) == 1);
+        assert(by_outstanding.pick(hosts, 1) == 2);
+    }
+    assert(by_outstanding.outstanding(0) == 0);
+    assert(by_outstanding.latency_ewma_ns(0) > 0);
+
+    ReplicaSelector by_latency(2, ReplicaSelector::Policy::LATENCY);
+    hosts = { 0, 1 };
+    {
+        ReplicaSelector::Call fast = by_latency.begin(0);
+    }
+    {
+        ReplicaSelector::Call slow = by_latency.begin(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    assert(by_latency.pick(hosts, 1) == 0);
+}
+
+void test_routers() {
+    // 10 nodes over 3 shards: 0-3, 4-6, 7-9
+    RangeShardRouter range_router(3, 10);
+    assert(range_router.shard_of(3) == 0);
+    assert(range_router.shard_of(4) == 1);
+    assert(range_router.local_key(9) == 2);
+    assert(range_router.global_key(2, 2) == 9);
+
+    std::string router_file(GraphFormatter::write_to_temp_file(""));
+    assert(range_router.save(router_file));
+    std::unique_ptr<ShardRouter> loaded(
+        ShardRouter::load(router_file, 3));
+    assert(loaded != nullptr);
+    assert(loaded->shard_of(7) == 2);
+    assert(ShardRouter::load(router_file, 4) == nullptr);
+    std::remove(router_file.c_str());
+
+    std::vector<std::string> hosts = { "host0", "host1", "host2" };
+    std::unique_ptr<HostRouter> host_router(
+        HostRouter::create("modulo", 9, hosts));
+    assert(host_router->host_of(7) == 1);
+    assert(host_router->shards_of(1) == std::vector<int32_t>({ 1, 4, 7 }));
+    host_router = HostRouter::create("range", 9, hosts);
+    assert(host_router->host_of(2) == 0);
+    assert(host_router->host_of(3) == 1);
+
+    // Replicas follow the primary, wrapping around
+    std::string repl_file(GraphFormatter::write_to_temp_file(
+        "# shard copies\n8 2\n4 3\n"));
+    assert(host_router->load_replication(repl_file));
+    assert(host_router->replication(0) == 1);
+    assert(host_router->hosts_of(8) == std::vector<int32_t>({ 2, 0 }));
+    assert(host_router->hosts_of(4) == std::vector<int32_t>({ 1, 2, 0 }));
+    assert(host_router->shards_of(0)
+        == std::vector<int32_t>({ 0, 1, 2, 4, 8 }));
+    std::remove(repl_file.c_str());
+    repl_file = GraphFormatter::write_to_temp_file("4 4\n");
+    assert(!host_router->load_replication(repl_file));
+    assert(host_router->replication(4) == 3);
+    std::remove(repl_file.c_str());
+
+    // Adding a host only moves shards to it
+    std::unique_ptr<HostRouter> consistent(
+        HostRouter::create("consistent", 100, hosts));
+    hosts.push_back("host3");
+    std::unique_ptr<HostRouter> grown(
+        HostRouter::create("consistent", 100, hosts));
+    for (int32_t shard = 0; shard < 100; ++shard) {
+        assert(grown->host_of(shard) == consistent->host_of(shard)
+            || grown->host_of(shard) == 3);
+    }
+}
 
 int main(int argc, char **argv) {
 
     test_kv_log_store();
+    test_kv_log_store_segments();
+    test_kv_log_store_search();
+    test_kv_log_store_concurrent();
+    test_kv_log_store_snapshot();
+    test_ngram_index();
     test_kv_suffix_store();
 
     test_structured_edge_table();
+    test_deleted_edges();
     test_file_suffix_store();
     test_file_suffix_store2();
+    test_shard_map();
+    test_routers();
+    test_replica_selector();
 
     test_graph_log_store();
     test_graph_suffix_store();
@@ -8,6 +8,57 @@ export SHARDS_PER_SERVER=4
 export NUM_SUFFIXSTORE_PARTS=0
 export NUM_LOGSTORE_PARTS=0
 
+# How handlers fault in memory mapped shards on startup: eager (populate while
+# mapping), lazy, eager-parallel, or hot-set (everything but the SA samples).
+export LOAD_POLICY=eager
+
+# T to pin each shard, its memory and the threads querying it to one NUMA
+# node (shards are dealt round-robin to the nodes), anything else disabled.
+export NUMA_PLACEMENT=F
+
+# Huge pages for the succinct data structures: none, thp (transparent huge
+# pages via madvise), or hugetlb (the vm.nr_hugepages pool, falling back to
+# thp when it runs out).
+export HUGE_PAGES=none
+
+# Most bytes of node data the LogStore holds before it rejects appends, in
+# MB; 0 for the default (16GB).  Memory is allocated in 8MB segments as the
+# log grows.
+export LOGSTORE_CAPACITY_MB=0
+
+# Directory the LogStore handler snapshots its nodes and edges to, and
+# restores them from on restart; empty to start from scratch every time.
+# Snapshots are taken every LOGSTORE_SNAPSHOT_SECS seconds (0 for never), and
+# whenever the handler gets SIGUSR1.
+export LOGSTORE_SNAPSHOT_DIR=
+export LOGSTORE_SNAPSHOT_SECS=0
+
+# How sbin/partition-input.sh splits the input: hash (node K to shard K % N),
+# range (consecutive ids), or degree (hash, but nodes with many edges, or many
+# queries in PARTITION_QUERY_LOG if set, are moved to balance the shards).
+# range and degree save how they placed the nodes to "$NODE_FILE-shardmap".
+# Handlers route nodes to shards by the file in SHARD_MAP, if set; it must be
+# the one saved with the shards they load.
+export PARTITIONER=hash
+export PARTITION_QUERY_LOG=
+export SHARD_MAP=
+
+# Which host serves each shard: modulo (shard S on host S % num_hosts), range
+# (consecutive shards per host), consistent[:points] (consistent hashing of
+# the host names: adding or removing a host moves only about 1/num_hosts of
+# the shards), or table:<file> ("<shard> <host id>" lines, for shards moved
+# off their modulo host).  The shards move as encoded files: copy them with
+# scripts/download_data.sh, which places them the same way, and restart.
+export HOST_ROUTING=modulo
+
+# Read replicas of hot shards: a file of "<shard> <copies>" lines (see
+# conf/repl), or empty for one copy of every shard.  The copies beyond the
+# first go on the hosts following the shard's own, which load them too, and
+# reads of the shard's nodes go to whichever copy REPLICA_POLICY ranks least
+# loaded: outstanding (fewest reads in flight) or latency (latency EWMA).
+export REPLICATION=
+export REPLICA_POLICY=outstanding
+
 currDir=$(cd $(dirname $0); pwd)
 export LD_LIBRARY_PATH=${currDir}/external/succinct-cpp/lib:${LD_LIBRARY_PATH}
 
@@ -1,14 +1,28 @@
 #ifndef DELETEDEDGES_H_
 #define DELETEDEDGES_H_
 
+#include <fcntl.h>
 #include <unistd.h>
 #include <cstdlib>
 #include <cstdio>
+#include <algorithm>
+#include <string>
 #include <tuple>
+#include <vector>
 #include <cassert>
 
+#include "bitmap.h"
+#include "utils.h"
+
+// Tombstones of the edges of an edge table: one bit per edge, with the bits
+// of each (src, atype) list contiguous.  The records, offsets and bitmap are
+// flat arrays that are memory mapped as is; the hashed record index and the
+// per-block deletion counts are derived from them on load.
 class DeletedEdges {
  public:
+  // Bits per block of the deletion count directory.
+  static const uint64_t kBlockBits = 512;
+
   struct edge_record_id {
     int64_t src;
     int64_t atype;
@@ -40,14 +54,7 @@ class DeletedEdges {
     offsets_ = NULL;
     num_entries_ = 0;
     num_edges_ = 0;
-  }
-
-  DeletedEdges(size_t num_entries, size_t num_edges) {
-    bitmap_ = new bitmap::Bitmap(num_edges);
-    record_ids_ = new edge_record_id[num_entries];
-    offsets_ = new int64_t[num_entries];
-    num_entries_ = num_entries;
-    num_edges_ = num_edges;
+    log_fd_ = -1;
   }
 
   DeletedEdges(std::vector<edge_record_id>& record_ids, std::vector<int64_t>& offsets, int64_t num_edges) {
@@ -57,16 +64,106 @@ class DeletedEdges {
     offsets_ = &offsets[0];
     num_entries_ = record_ids.size();
     num_edges_ = num_edges;
+    log_fd_ = -1;
+    BuildIndex();
+  }
+
+  // Position of the first tombstone bit of edge list (src, atype), or -1 if
+  // the list is unknown.  Readers look it up once per list and then test or
+  // count the bits of the list's edges by index.
+  int64_t ListOffset(int64_t src, int64_t atype) {
+    int64_t idx = FindRecordIdx(src, atype);
+    return idx == -1 ? -1 : offsets_[idx];
   }
 
   bool IsDeleted(int64_t src, int64_t atype, int64_t edge_idx) {
-    int64_t off = offsets_[FindRecordIdx(src, atype)];
-    return bitmap_->GetBit(off + edge_idx);
+    int64_t list_off = ListOffset(src, atype);
+    return list_off != -1 && IsDeletedAt(list_off, edge_idx);
+  }
+
+  bool IsDeletedAt(int64_t list_off, int64_t edge_idx) {
+    return bitmap_->GetBit(list_off + edge_idx);
+  }
+
+  // Number of deleted edges with index in [begin, end) in the list.  Whole
+  // blocks are counted from the directory, only the ends from the bitmap.
+  int64_t CountDeleted(int64_t list_off, int64_t begin, int64_t end) {
+    uint64_t lo = list_off + begin, hi = list_off + end;
+    uint64_t lo_block = (lo + kBlockBits - 1) / kBlockBits;
+    uint64_t hi_block = hi / kBlockBits;
+    if (lo_block >= hi_block) {
+      return bitmap_->Count(lo, hi);
+    }
+    int64_t count = bitmap_->Count(lo, lo_block * kBlockBits)
+        + bitmap_->Count(hi_block * kBlockBits, hi);
+    for (uint64_t block = lo_block; block < hi_block; ++block) {
+      count += block_deleted_[block];
+    }
+    return count;
+  }
+
+  // Index of the k-th (0-based) live edge with index in [begin, end) in the
+  // list, or end if there are not that many.  Skips whole blocks by their
+  // counts, and selects within the block that holds the edge.
+  int64_t SelectLive(int64_t list_off, int64_t begin, int64_t k,
+                     int64_t end) {
+    uint64_t pos = list_off + begin, hi = list_off + end;
+    while (pos < hi) {
+      uint64_t block = pos / kBlockBits;
+      uint64_t block_end = std::min((block + 1) * kBlockBits, hi);
+      uint64_t live = block_end - pos;
+      if (pos % kBlockBits == 0 && live == kBlockBits) {
+        live -= block_deleted_[block];
+      } else {
+        live -= bitmap_->Count(pos, block_end);
+      }
+      if (static_cast<uint64_t>(k) < live) {
+        return bitmap_->SelectUnset(pos, k, block_end) - list_off;
+      }
+      k -= live;
+      pos = block_end;
+    }
+    return end;
+  }
+
+  // Marks the edge deleted, and logs it if a log is open.  Returns false if
+  // the list is unknown or the edge was already deleted.
+  bool Delete(int64_t src, int64_t atype, int64_t edge_idx) {
+    int64_t list_off = ListOffset(src, atype);
+    if (list_off == -1) {
+      return false;
+    }
+    if (!SetDeleted(list_off + edge_idx)) {
+      return false;
+    }
+    if (log_fd_ != -1) {
+      int64_t rec[3] = { src, atype, edge_idx };
+      if (write(log_fd_, rec, sizeof(rec)) != sizeof(rec)
+          || fdatasync(log_fd_) != 0) {
+        LOG_E("Could not log delete of edge %" PRId64 " of (%" PRId64 ", %"
+              PRId64 ")\n", edge_idx, src, atype);
+      }
+    }
+    return true;
   }
 
-  void Delete(int64_t src, int64_t atype, int64_t edge_idx) {
-    int64_t off = offsets_[FindRecordIdx(src, atype)];
-    bitmap_->SetBit(off + edge_idx);
+  // Replays the deletes recorded in log_file onto the bitmap, and appends
+  // every later delete to it.  The log makes deletes durable even where the
+  // bitmap is a private copy, or a shared mapping not yet written back.
+  bool OpenLog(const std::string& log_file) {
+    int fd = open(log_file.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd == -1) {
+      return false;
+    }
+    int64_t rec[3];
+    while (read(fd, rec, sizeof(rec)) == sizeof(rec)) {
+      int64_t list_off = ListOffset(rec[0], rec[1]);
+      if (list_off != -1) {
+        SetDeleted(list_off + rec[2]);
+      }
+    }
+    log_fd_ = fd;
+    return true;
   }
 
   size_t GetNumEdges() {
@@ -120,6 +217,7 @@ class DeletedEdges {
 
     bitmap_ = new bitmap::Bitmap();
     in_size += bitmap_->Deserialize(in);
+    BuildIndex();
 
     return 0;
   }
@@ -142,24 +240,74 @@ class DeletedEdges {
 
     bitmap_ = new bitmap::Bitmap();
     data += bitmap_->MemoryMap(data);
+    BuildIndex();
 
     return data - data_beg;
   }
 
  private:
+  static uint64_t HashRecord(int64_t src, int64_t atype) {
+    uint64_t h = static_cast<uint64_t>(src) * 0x9E3779B97F4A7C15ULL;
+    h ^= static_cast<uint64_t>(atype) + 0x7F4A7C159E3779B9ULL + (h << 6)
+        + (h >> 2);
+    return h ^ (h >> 31);
+  }
+
+  // Builds the record hash table (open addressing, linear probing, at most
+  // half full) and the per-block deletion counts.
+  void BuildIndex() {
+    uint64_t num_slots = 2;
+    while (num_slots < 2 * num_entries_) {
+      num_slots <<= 1;
+    }
+    slot_mask_ = num_slots - 1;
+    slots_.assign(num_slots, -1);
+    for (uint64_t i = 0; i < num_entries_; ++i) {
+      uint64_t slot = HashRecord(record_ids_[i].src, record_ids_[i].atype)
+          & slot_mask_;
+      while (slots_[slot] != -1) {
+        slot = (slot + 1) & slot_mask_;
+      }
+      slots_[slot] = i;
+    }
+
+    uint64_t num_blocks = (num_edges_ + kBlockBits - 1) / kBlockBits;
+    block_deleted_.assign(num_blocks, 0);
+    for (uint64_t block = 0; block < num_blocks; ++block) {
+      block_deleted_[block] = bitmap_->Count(
+          block * kBlockBits, std::min((block + 1) * kBlockBits,
+                                       static_cast<uint64_t>(num_edges_)));
+    }
+  }
+
+  // Index of record (src, atype), or -1 if there is none.
   int64_t FindRecordIdx(int64_t src, int64_t atype) {
+    if (slots_.empty()) {
+      return -1;
+    }
     edge_record_id rec = { src, atype };
-    // Binary search for the offset in the list of value offsets.
-    uint32_t lo = 0, hi = num_entries_ - 1;
-    while (lo < hi) {
-      uint32_t mid = lo + (hi - lo) / 2;
-      edge_record_id val = record_ids_[mid];
-      if (val <= rec)
-        lo = mid + 1;
-      else
-        hi = mid;
+    uint64_t slot = HashRecord(src, atype) & slot_mask_;
+    while (slots_[slot] != -1) {
+      if (record_ids_[slots_[slot]] == rec) {
+        return slots_[slot];
+      }
+      slot = (slot + 1) & slot_mask_;
     }
-    return lo - 1;
+    return -1;
+  }
+
+  // Sets the bit at pos, atomically so concurrent deletes within one word
+  // are not lost; returns false if it was already set.
+  bool SetDeleted(uint64_t pos) {
+    uint64_t bit = 1ULL << (pos % 64);
+    uint64_t old = __atomic_fetch_or(&bitmap_->GetData()[pos / 64], bit,
+                                     __ATOMIC_RELAXED);
+    if (old & bit) {
+      return false;
+    }
+    __atomic_fetch_add(&block_deleted_[pos / kBlockBits], 1,
+                       __ATOMIC_RELAXED);
+    return true;
   }
 
   // One big bitmap
@@ -168,6 +316,14 @@ class DeletedEdges {
   int64_t* offsets_;
   size_t num_entries_;
   size_t num_edges_;
+  int log_fd_;
+
+  // Record index of each hash slot, or -1 if empty; slot_mask_ + 1 slots.
+  std::vector<int64_t> slots_;
+  uint64_t slot_mask_ = 0;
+
+  // Deleted edges in each kBlockBits block of the bitmap.
+  std::vector<uint16_t> block_deleted_;
 };
 
 #endif /* DELETEDEDGES_H_ */
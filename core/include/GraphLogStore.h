@@ -3,6 +3,7 @@
 
 #include "GraphFormatter.hpp"
 #include "KVLogStore.h"
+#include "Router.h"
 #include "StructuredEdgeTable.h"
 
 #include <set>
@@ -34,8 +35,17 @@ class GraphLogStore {
   }
 
   void construct();
+
+  // Starts from the snapshot taken by snapshot(), if there is one, or empty
+  // if either of its tables is missing or corrupt.
   void load();
 
+  // Saves the node and edge tables next to the node and edge files, with
+  // the "_logstore" suffix, for load() to restore them.  Appends may go on
+  // meanwhile; appended nodes are saved once they are indexed.  Returns
+  // false if there are no files to name the snapshot after, or on I/O errors.
+  bool snapshot();
+
   // TODO: think about where this key should come from; and locking.
   // Limitation: `node_id` must be larger than all current node_id's managed
   // by the current GraphLogStore (because insertion sort is not done).  Note
@@ -86,12 +96,19 @@ class GraphLogStore {
     return edge_table_.assoc_time_range(src, atype, t_low, t_high, len);
   }
 
+  // The edge lists and nodes held here, under the shard of their source
+  // and of the node, for the update pointers of those shards: what the
+  // aggregators must point at again after load() restored a snapshot.
   inline void build_backfill_edge_updates(
       std::unordered_map<int, GraphFormatter::AssocSet>& edge_updates,
-      int num_shards_to_mod) {
-    edge_table_.build_backfill_edge_updates(edge_updates, num_shards_to_mod);
+      const ShardRouter& router) {
+    edge_table_.build_backfill_edge_updates(edge_updates, router);
   }
 
+  void build_backfill_node_updates(
+      std::unordered_map<int, std::vector<int64_t>>& node_updates,
+      const ShardRouter& router);
+
   inline int32_t num_digits(int64_t number) {
     if (number == 0)
       return 1;
@@ -5,85 +5,242 @@
 #include "utils/definitions.h"
 #include "succinct_base.h"
 
+#include "NGramIndex.h"
 #include "utils.h"
 
 #include <boost/thread.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-class Hash {
- public:
-  static const uint32_t K1 = 256;
-  static const uint32_t K2 = 65536;
-  static const uint32_t K3 = 16777216;
-
-  static uint32_t simple_hash2(const char* buf) {
-    return buf[0] * K1 + buf[1];
-  }
-
-  static uint32_t simple_hash3(const char* buf) {
-    return buf[0] * K2 + buf[1] * K1 + buf[2];
-  }
-
-  static uint32_t simple_hash4(const char* buf) {
-    return buf[0] * K3 + buf[1] * K2 + buf[2] * K1 + buf[3];
-  }
-};
-
 // LogStore with a key-value interface.
-// FIXME: search() has the prefix-match bug.
+//
+// Values are appended to a log of fixed-size segments, allocated as the log
+// grows up to a capacity limit; segments are never moved, and a value never
+// straddles two of them (the rest of a segment too small for the next value
+// is left unused).  Positions in the log are 64-bit.  Segments are allocated
+// through SuccinctAllocator, so they are huge page backed under its policy.
+//
+// Writers only serialise to reserve their place at the tail (and their key,
+// for append()); they copy their values concurrently, and publish them with
+// a release store, after which get_value() reads them without locks.
+// Committed values are indexed in log order, by whichever writer completes
+// the committed prefix of the log.
+//
+// search() looks substrings up in an n-gram index of the log, intersecting
+// the posting lists of several n-grams of longer queries.  Matches may span
+// consecutive values of a segment, and are reported for the value they
+// start in.  It only sees indexed values, and briefly holds back the writers
+// indexing them.
+//
+// save() snapshots the indexed values, with their index, and load() restores
+// a snapshot by mapping its log segments rather than rebuilding anything.
 class KVLogStore {
  public:
-  static const uint32_t kLogStoreSize = 125 * 1024 * 1024;  // 125MB
+  static const uint64_t kSegmentSize = 8 * 1024 * 1024;  // 8MB
+  static const uint64_t kDefaultCapacity = 16ULL * 1024 * 1024 * 1024;  // 16GB
   static const uint32_t kMaxKeys = 16384000;
-  typedef std::unordered_map<uint32_t, std::vector<uint32_t>> NGramIdx;
-
-  KVLogStore(int64_t start_key) {
-    cur_key_ = start_key;
-    data_ = new char[kLogStoreSize];
+  static const uint32_t kDefaultNGramN = 3;
+
+  // By default, search() intersects the posting lists of up to this many
+  // n-grams of a query, out of the ones at most kIntersectRatio times longer
+  // than the shortest.
+  static const size_t kDefaultSearchNGrams = 4;
+  static const uint64_t kIntersectRatio = 4;
+
+  // `capacity` bounds the bytes of values the store holds, rounded up to a
+  // whole segment; 0 means default_capacity().  `ngram_n` is the length of
+  // the indexed n-grams, in [NGramIndex::kMinN, NGramIndex::kMaxN]: longer
+  // n-grams have shorter posting lists but more of them, and queries shorter
+  // than n scan the log.
+  explicit KVLogStore(int64_t start_key, uint64_t capacity = 0,
+                      uint32_t ngram_n = kDefaultNGramN);
+
+  ~KVLogStore();
+
+  // Capacity of the log stores constructed from here on without one.
+  static void set_default_capacity(uint64_t capacity);
+  static uint64_t default_capacity();
+
+  uint64_t capacity() const {
+    return segments_.size() * kSegmentSize;
   }
 
-  ~KVLogStore() {
-    if (data_ != nullptr) {
-      delete[] data_;
-    }
+  // Most n-grams whose posting lists search() intersects; 1 only looks up
+  // the rarest n-gram of the query.  Set it before searching.
+  void set_search_ngrams(size_t max_ngrams) {
+    max_ngrams_ = std::max<size_t>(max_ngrams, 1);
   }
 
-  // Thread-safe for concurrent writes.
+  // Bytes of values and filler reserved so far, and heap bytes held by the
+  // n-gram index.
+  uint64_t size() const;
+  size_t index_size();
+
+  // Thread-safe for concurrent writes.  Returns -1 if the value is longer
+  // than a segment or the store is full.
   int64_t append(const std::string& value);
 
+  // As append(), for a given key; replaces its value, if any.
   int64_t insert(const int64_t key, const std::string& value);
 
   // Clears `_return` for caller.
   void search(std::set<int64_t> &_return, const std::string& substring);
 
-  // Clears `value` for caller.
+  // Clears `value` for caller.  Lock-free for appended keys.
   void get_value(std::string &value, uint64_t key);
 
   bool remove(const int64_t key);
 
+  // Clears `keys` for caller, and lists the keys with a value: appended keys
+  // ascending, then inserted ones.
+  void keys(std::vector<int64_t>& keys);
+
+  // Writes a snapshot of the indexed values and their n-gram index to
+  // `path`, replacing it atomically.  Writers may go on meanwhile; values not
+  // indexed yet are left out.  Returns false on I/O errors.
+  bool save(const std::string& path);
+
+  // Restores a snapshot written by save() into this new, empty store.  The
+  // log segments are mapped from the file copy-on-write, so they are paged
+  // in as they are read; only the records and the index are copied.  Returns
+  // false if there is no snapshot at `path`, or it does not fit this store.
+  bool load(const std::string& path);
+
  private:
-  char* data_;
+  // Records and dense key slots live in chunks of kChunkSize entries, listed
+  // in a fixed directory of kMaxChunks, so they never move.
+  static const uint64_t kChunkBits = 16;
+  static const uint64_t kChunkSize = 1ULL << kChunkBits;
+  static const uint64_t kMaxChunks = 1ULL << 16;
+  static const uint64_t kMaxEntries = kChunkSize * kMaxChunks;
+
+  // A value, or the unused tail of a segment.  pos, len and filler are set
+  // when the record is reserved; done is released once the value is copied.
+  struct Record {
+    uint64_t pos;
+    uint64_t len;
+    std::atomic<int64_t> key;  // -1 once removed, and for fillers
+    std::atomic<bool> done;
+    bool filler;
+  };
+
+  // Array of zero-initialised entries, allocated a chunk at a time; readers
+  // may access any entry below one whose index they acquired.
+  template<typename T>
+  class ChunkedArray {
+   public:
+    ChunkedArray()
+        : chunks_(new std::atomic<T*>[kMaxChunks]) {
+      for (uint64_t i = 0; i < kMaxChunks; i++) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
 
-  // Only for log store
-  uint64_t tail_ = static_cast<uint64_t>(0);
+    ~ChunkedArray() {
+      for (uint64_t i = 0; i < kMaxChunks; i++) {
+        delete[] chunks_[i].load(std::memory_order_relaxed);
+      }
+    }
+
+    // Allocates the chunk of entry i, if needed.  Calls are serialised.
+    void ensure(uint64_t i) {
+      std::atomic<T*>& chunk = chunks_[i >> kChunkBits];
+      if (chunk.load(std::memory_order_relaxed) == nullptr) {
+        chunk.store(new T[kChunkSize](), std::memory_order_release);
+      }
+    }
+
+    T& operator[](uint64_t i) const {
+      return chunks_[i >> kChunkBits].load(std::memory_order_acquire)[i
+          & (kChunkSize - 1)];
+    }
+
+   private:
+    std::unique_ptr<std::atomic<T*>[]> chunks_;
+  };
+
+  // Reserves a record for `len` bytes at the tail, allocating its segment if
+  // needed, and for append()s (key == -1) assigns the key; returns the
+  // record, or -1 if it does not fit.
+  int64_t reserve(int64_t& key, uint64_t len);
+
+  // Writes `value` for `key` (-1 to append) and publishes it; -1 if it does
+  // not fit.
+  int64_t write(int64_t key, const std::string& value);
 
-  // Index to speed up searches
-  // Note: Index only works when logstore data is < 2GB; for larger log
-  // stores, switch to long offsets.
-  NGramIdx ngram_idx_;
-  uint32_t ngram_n_ = 3;
+  // Makes `record` the value of `key`, and removes the value it replaces.
+  void publish(int64_t key, uint64_t record);
 
-  typedef std::map<int64_t, int32_t> FwdMap;
-  typedef std::map<int32_t, int64_t> BwdMap;
-  FwdMap k2v;
-  BwdMap v2k;
+  // Indexes the records committed after the indexed prefix of the log.
+  void index_committed();
 
-  int64_t cur_key_;
+  inline char* at(uint64_t pos) const {
+    return segments_[pos / kSegmentSize] + pos % kSegmentSize;
+  }
+
+  // Whether `key` has a dense slot.
+  inline bool is_dense(int64_t key) const {
+    return key >= start_key_
+        && key < cur_key_.load(std::memory_order_acquire);
+  }
+
+  // One slot per segment of the capacity, so it is never reallocated;
+  // nullptr until the log reaches the segment.
+  std::vector<char*> segments_;
+
+  // Snapshot mapped by load(), whose segments are not to be freed.
+  char* mapped_ = nullptr;
+  size_t mapped_size_ = 0;
+
+  inline bool is_mapped(const char* segment) const {
+    return segment >= mapped_ && segment < mapped_ + mapped_size_;
+  }
 
-  boost::shared_mutex mutex_;
+  // Positions at which `query` (at least n bytes) starts, in the log up to
+  // `tail`, ascending.  Caller holds the index lock.
+  void find_matches(std::vector<uint64_t>& matches, const std::string& query,
+                    uint64_t tail);
+
+  // As find_matches(), for queries shorter than n, by scanning the log.
+  void scan_matches(std::vector<uint64_t>& matches, const std::string& query,
+                    uint64_t tail);
+
+  // Whether `query` occurs at `pos`, within one segment and below `tail`.
+  bool matches_at(uint64_t pos, const std::string& query, uint64_t tail);
+
+  // Index of the record of `key`, or -1.
+  int64_t find_record(int64_t key);
+
+  // Serialises reservations: tail_, num_records_, cur_key_ and the
+  // allocation of segments and chunks only change under it.
+  std::mutex reserve_mutex_;
+  std::atomic<uint64_t> tail_;
+  std::atomic<uint64_t> num_records_;
+
+  // Records in log order, so their positions ascend.
+  ChunkedArray<Record> records_;
+
+  // Record + 1 of each key in [start_key_, cur_key_), or 0; inserted keys
+  // outside that range are in sparse_records_.
+  ChunkedArray<std::atomic<uint64_t>> dense_records_;
+  std::unordered_map<int64_t, uint64_t> sparse_records_;
+  boost::shared_mutex sparse_mutex_;
+
+  const int64_t start_key_;
+  std::atomic<int64_t> cur_key_;
+
+  // Index to speed up searches, of the first indexed_records_ records, which
+  // end at indexed_tail_; both only change under the exclusive index lock.
+  boost::shared_mutex index_mutex_;
+  NGramIndex ngram_idx_;
+  size_t max_ngrams_ = kDefaultSearchNGrams;
+  uint64_t indexed_records_ = 0;
+  uint64_t indexed_tail_ = 0;
 };
 
 #endif
@@ -0,0 +1,151 @@
+#ifndef SUCCINCT_GRAPH_METRICS_H
+#define SUCCINCT_GRAPH_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Process-wide registry of named counters and latency histograms, cheap
+// enough for query hot paths.
+//
+// Metrics are registered once by name, typically into a function-local or
+// file-level static, and then updated through the returned id:
+//
+//   static const Metrics::Id kSearches = Metrics::counter("graph.searches");
+//   Metrics::add(kSearches);
+//
+// Every thread updates its own slots, with plain relaxed loads and stores
+// (no locks, no locked read-modify-writes, no shared cache lines).  Readers
+// (to_json()) sum the slots of all live threads plus the totals folded in by
+// threads that have exited.
+class Metrics {
+ public:
+  typedef int Id;
+
+  static const int MAX_COUNTERS = 64;
+  static const int MAX_HISTOGRAMS = 96;
+
+  // Log-linear histogram buckets: values below 2^(SUB_BUCKET_BITS + 1) are
+  // exact, larger ones fall into one of 2^SUB_BUCKET_BITS buckets per power
+  // of two (<= 3.125% relative error); values >= 2^MAX_VALUE_BITS are clamped.
+  static const int SUB_BUCKET_BITS = 5;
+  static const int MAX_VALUE_BITS = 40;
+  static const int NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1)
+      << SUB_BUCKET_BITS;
+
+  // Returns the id of the counter / histogram with this name, registering it
+  // on first use.  Takes a lock: call once and keep the id.  Aborts if the
+  // registry is full.
+  static Id counter(const std::string& name);
+  static Id histogram(const std::string& name);
+
+  static inline void add(Id counter, uint64_t delta = 1) {
+    bump(local()->counters[counter], delta);
+  }
+
+  static inline void record(Id histogram, uint64_t value) {
+    ThreadSlots* slots = local();
+    HistogramSlots* h_ptr =
+        slots->histograms[histogram].load(std::memory_order_relaxed);
+    if (h_ptr == nullptr) {
+      h_ptr = add_histogram(*slots, histogram);
+    }
+    HistogramSlots& h = *h_ptr;
+    bump(h.buckets[bucket_of(value)], 1);
+    bump(h.count, 1);
+    bump(h.sum, value);
+    if (value > h.max.load(std::memory_order_relaxed)) {
+      h.max.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  static inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Records the lifetime of the enclosing scope, in ns, into a histogram.
+  class ScopedLatency {
+   public:
+    explicit ScopedLatency(Id histogram)
+        : histogram_(histogram),
+          start_(now_ns()) {
+    }
+    ~ScopedLatency() {
+      record(histogram_, now_ns() - start_);
+    }
+   private:
+    Id histogram_;
+    uint64_t start_;
+  };
+
+  // Snapshot of all metrics as a JSON object:
+  //   {"counters": {name: value, ...},
+  //    "histograms": {name: {"count", "mean", "p50", "p90", "p99", "p999",
+  //                          "max"}, ...}}
+  static std::string to_json();
+
+  // Value of a counter summed over all threads (0 if unknown).
+  static uint64_t counter_value(const std::string& name);
+
+ private:
+  struct HistogramSlots {
+    HistogramSlots();
+    std::atomic<uint64_t> buckets[NUM_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+  };
+
+  // A thread's histograms are allocated as it first records into each, as
+  // the buckets of all of them would take most of a MB per thread; nullptr
+  // until then.
+  struct ThreadSlots {
+    ThreadSlots();
+    ~ThreadSlots();
+    std::atomic<uint64_t> counters[MAX_COUNTERS];
+    std::atomic<HistogramSlots*> histograms[MAX_HISTOGRAMS];
+  };
+
+  // Allocates and publishes histogram `histogram` of `slots`, which has none.
+  static HistogramSlots* add_histogram(ThreadSlots& slots, Id histogram);
+
+  // Metric names, live threads' slots and the totals of exited threads.
+  struct Registry;
+  static Registry& registry();
+
+  // Registers and unregisters a thread's slots; see Metrics.cpp.
+  friend class ThreadSlotsHolder;
+
+  static inline void bump(std::atomic<uint64_t>& slot, uint64_t delta) {
+    slot.store(slot.load(std::memory_order_relaxed) + delta,
+               std::memory_order_relaxed);
+  }
+
+  static inline int bucket_of(uint64_t value) {
+    const uint64_t max_value = (1ULL << MAX_VALUE_BITS) - 1;
+    if (value > max_value) {
+      value = max_value;
+    }
+    if (value < (2ULL << SUB_BUCKET_BITS)) {
+      return value;
+    }
+    int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return (shift << SUB_BUCKET_BITS) + (value >> shift);
+  }
+
+  // Largest value that falls into bucket `index`.
+  static uint64_t bucket_limit(int index);
+
+  static inline ThreadSlots* local() {
+    ThreadSlots* slots = thread_slots_;
+    return (slots != nullptr) ? slots : register_thread();
+  }
+
+  static ThreadSlots* register_thread();
+
+  static thread_local ThreadSlots* thread_slots_;
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef SUCCINCT_GRAPH_NGRAM_INDEX_H
+#define SUCCINCT_GRAPH_NGRAM_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// Ascending list of positions, appended in order.
+//
+// Positions are split into blocks of kBlockSize: the first position of each
+// block is kept as is in a block directory, the others as varint deltas from
+// their predecessor.  Dense lists take one or two bytes per posting instead
+// of eight, and an iterator can skip whole blocks through the directory
+// without decoding them, which is what makes intersecting lists cheap.  The
+// deltas grow by a quarter at a time, to keep the unused capacity small.
+class PostingList {
+ public:
+  static const uint64_t kBlockSize = 128;
+
+  void append(uint64_t pos);
+
+  uint64_t size() const {
+    return size_;
+  }
+
+  // Heap bytes held by the list.
+  size_t storage_size() const;
+
+  // Writes the list to `out`, returning the bytes written.
+  size_t serialize(std::ostream& out) const;
+
+  // Reads a list written by serialize() from `buf` into this (empty) list,
+  // returning the bytes read.
+  size_t deserialize(const uint8_t* buf);
+
+  // Forward iterator over the postings present when it was constructed.
+  // Reads the list in place; the list must not be appended to meanwhile.
+  class Iterator {
+   public:
+    explicit Iterator(const PostingList& list)
+        : list_(&list),
+          size_(list.size_),
+          idx_(0),
+          block_(0),
+          off_(0),
+          value_(0) {
+      if (size_ > 0) {
+        load_block(0);
+      }
+    }
+
+    bool valid() const {
+      return idx_ < size_;
+    }
+
+    uint64_t value() const {
+      return value_;
+    }
+
+    void next() {
+      if (++idx_ >= size_) {
+        return;
+      }
+      if (idx_ % kBlockSize == 0) {
+        load_block(block_ + 1);
+      } else {
+        value_ += decode();
+      }
+    }
+
+    // Advances to the first posting >= target, if any.
+    void seek(uint64_t target) {
+      if (!valid() || value_ >= target) {
+        return;
+      }
+      // blocks_[b] is block b + 1; skip to the last block at or before
+      // target, if it is not this one.
+      const std::vector<Block>& blocks = list_->blocks_;
+      uint64_t num_blocks = (size_ + kBlockSize - 1) / kBlockSize;
+      if (block_ + 1 < num_blocks && blocks[block_].first <= target) {
+        uint64_t block = std::upper_bound(blocks.begin() + block_ + 1,
+                                          blocks.begin() + num_blocks - 1,
+                                          target,
+                                          [](uint64_t pos, const Block& b) {
+                                            return pos < b.first;
+                                          })
+            - blocks.begin();
+        load_block(block);
+      }
+      while (valid() && value_ < target) {
+        next();
+      }
+    }
+
+   private:
+    void load_block(uint64_t block) {
+      block_ = block;
+      idx_ = block * kBlockSize;
+      if (block == 0) {
+        value_ = list_->first_;
+        off_ = 0;
+      } else {
+        value_ = list_->blocks_[block - 1].first;
+        off_ = list_->blocks_[block - 1].offset;
+      }
+    }
+
+    uint64_t decode() {
+      const uint8_t* bytes = list_->bytes_.data();
+      uint64_t delta = 0;
+      for (int shift = 0;; shift += 7) {
+        uint8_t byte = bytes[off_++];
+        delta |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+          return delta;
+        }
+      }
+    }
+
+    const PostingList* list_;
+    uint64_t size_;
+    uint64_t idx_;
+    uint64_t block_;
+    uint64_t off_;
+    uint64_t value_;
+  };
+
+ private:
+  // Varint deltas of every posting but the first of its block.
+  std::vector<uint8_t> bytes_;
+
+  // First posting of each block after the first, and the offset of its
+  // deltas in bytes_.  Short lists, most of them, need no directory.
+  struct Block {
+    uint64_t first;
+    uint64_t offset;
+  };
+  std::vector<Block> blocks_;
+
+  uint64_t first_ = 0;
+  uint64_t last_ = 0;
+  uint64_t size_ = 0;
+};
+
+// Inverted index from the n-grams of a byte log to the positions they start
+// at, for 2 <= n <= 4.  An n-gram's key packs its bytes, so distinct n-grams
+// never share a posting list.
+class NGramIndex {
+ public:
+  static const uint32_t kMinN = 2;
+  static const uint32_t kMaxN = 4;
+
+  // `n` is clamped to [kMinN, kMaxN].
+  explicit NGramIndex(uint32_t n = 3);
+
+  uint32_t n() const {
+    return n_;
+  }
+
+  // Key of the n-gram starting at `buf`, which must hold n() bytes.
+  uint32_t key(const char* buf) const {
+    uint32_t key = 0;
+    for (uint32_t i = 0; i < n_; i++) {
+      key = (key << 8) | static_cast<uint8_t>(buf[i]);
+    }
+    return key;
+  }
+
+  // Records that n-gram `key` starts at `pos`.  Positions of one n-gram must
+  // be added in ascending order.
+  void add(uint32_t key, uint64_t pos) {
+    lists_[key].append(pos);
+  }
+
+  // Postings of n-gram `key`, or nullptr if it does not occur.
+  const PostingList* find(uint32_t key) const {
+    std::unordered_map<uint32_t, PostingList>::const_iterator it =
+        lists_.find(key);
+    return it == lists_.end() ? nullptr : &it->second;
+  }
+
+  // Heap bytes held by the index, including an estimate of the hash table's.
+  size_t storage_size() const;
+
+  // Writes n and the posting lists to `out`, returning the bytes written.
+  size_t serialize(std::ostream& out) const;
+
+  // Replaces the index with one written by serialize() to `buf`, returning
+  // the bytes read.
+  size_t deserialize(const uint8_t* buf);
+
+ private:
+  uint32_t n_;
+  std::unordered_map<uint32_t, PostingList> lists_;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SUCCINCT_GRAPH_NUMA_H
+#define SUCCINCT_GRAPH_NUMA_H
+
+#include <vector>
+
+// NUMA topology and placement for multi-socket hosts, read from sysfs and
+// applied with the raw scheduler / memory policy syscalls, so there is no
+// libnuma dependency.  Where the topology cannot be read (non-Linux hosts,
+// containers without sysfs) the host looks like a single node 0 and the
+// placement calls do nothing and return false.
+//
+// Both the CPU mask and the memory policy of a thread are inherited by the
+// threads it starts, so pinning a loader thread also places the page faults
+// of any prefault threads it spawns.
+class Numa {
+ public:
+  // Ids of the nodes that have CPUs, ascending; {0} if unknown.
+  static const std::vector<int>& nodes();
+
+  // CPUs of node `node`, ascending; empty if unknown.
+  static const std::vector<int>& node_cpus(int node);
+
+  // Restricts the calling thread to the CPUs of `node`.
+  static bool pin_thread(int node);
+
+  // Node the calling thread was last pinned to by pin_thread(), or -1.
+  static int pinned_node();
+
+  // Makes the calling thread allocate pages (heap, and page cache for the
+  // files it faults in) from `node` first, falling back to other nodes when
+  // it is full; -1 restores the default local allocation.
+  static bool prefer_node(int node);
+
+ private:
+  static thread_local int pinned_node_;
+};
+
+#endif
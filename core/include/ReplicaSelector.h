@@ -0,0 +1,104 @@
+#ifndef SUCCINCT_GRAPH_REPLICA_SELECTOR_H
+#define SUCCINCT_GRAPH_REPLICA_SELECTOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Picks which copy of a replicated shard a read goes to, by the load this
+// aggregator has seen on each host:
+//
+//   outstanding   the host with the fewest reads in flight
+//   latency       the host with the lowest latency EWMA, scaled by its reads
+//                 in flight + 1, so that a host which just became fast is not
+//                 flooded before its average catches up.  The EWMA of a host
+//                 that has no reads completing decays, halving every
+//                 kEwmaHalfLifeNs: a host avoided after a few slow reads is
+//                 tried again once the others are as slow, rather than never
+//
+// Every read is tracked, replicated shard or not, by holding a Call for its
+// duration; a host that is busy with its own shards thus looks busy to the
+// reads of replicated ones too.  All handlers share one selector.
+class ReplicaSelector {
+ public:
+  enum class Policy {
+    OUTSTANDING,
+    LATENCY
+  };
+
+  // Weight of the newest latency sample in the EWMA.
+  static constexpr double kEwmaAlpha = 0.125;
+  static constexpr double kEwmaHalfLifeNs = 100e6;
+
+  ReplicaSelector(int32_t num_hosts, Policy policy);
+
+  // Policy named `name`: "outstanding" or "latency".  False if neither.
+  static bool parse_policy(const std::string& name, Policy* policy);
+
+  // Least loaded of `hosts`; on a tie `preferred`, which should be this
+  // host, if it is one of them, otherwise the earliest of them.
+  int32_t pick(const std::vector<int32_t>& hosts, int32_t preferred) const;
+
+  // A read on `host`, from construction to destruction.
+  class Call {
+   public:
+    Call(ReplicaSelector* selector, int32_t host);
+    Call(Call&& other);
+    ~Call();
+
+    int32_t host() const {
+      return host_;
+    }
+
+   private:
+    Call(const Call&) = delete;
+    Call& operator=(const Call&) = delete;
+
+    ReplicaSelector* selector_;
+    int32_t host_;
+    uint64_t start_ns_;
+  };
+
+  Call begin(int32_t host) {
+    return Call(this, host);
+  }
+
+  int64_t outstanding(int32_t host) const {
+    return loads_[host].outstanding.load(std::memory_order_relaxed);
+  }
+
+  // Latency EWMA of `host`, in ns; 0 until its first read completes.
+  uint64_t latency_ewma_ns(int32_t host) const {
+    return loads_[host].ewma_ns.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // One cache line each, so that no two hosts' counters share one: each
+  // host's are updated by every handler thread that reads from it.
+  struct alignas(64) HostLoad {
+    std::atomic<int64_t> outstanding;
+    std::atomic<uint64_t> ewma_ns;
+    // When the last read completed, for decaying the EWMA.
+    std::atomic<uint64_t> last_ns;
+  };
+
+  // new[] need not honour an alignment above the default before C++17, so
+  // the loads are allocated with posix_memalign and released with free.
+  struct FreeLoads {
+    void operator()(HostLoad* loads) const;
+  };
+
+  static HostLoad* allocate_loads(int32_t num_hosts);
+
+  void end(int32_t host, uint64_t latency_ns, uint64_t now_ns);
+
+  double score(int32_t host, uint64_t now_ns) const;
+
+  const int32_t num_hosts_;
+  const Policy policy_;
+  std::unique_ptr<HostLoad[], FreeLoads> loads_;
+};
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef SUCCINCT_GRAPH_ROUTER_H
+#define SUCCINCT_GRAPH_ROUTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Where a query for a node goes: the shard holding the node, and the host
+// serving that shard.  The two are routed separately, so that shards, once
+// encoded, can be moved between hosts, or spread over more hosts, without
+// touching the node to shard placement they were encoded with.
+
+// Shard of each node, and the key of its record in that shard's node table.
+// Partitioners place nodes with one, and save it for the aggregators and
+// shards to route by.
+class ShardRouter {
+ public:
+  virtual ~ShardRouter() {
+  }
+
+  int32_t num_shards() const {
+    return num_shards_;
+  }
+
+  virtual int32_t shard_of(int64_t node) const = 0;
+
+  // Key of `node` in the node table of shard_of(node).
+  virtual int64_t local_key(int64_t node) const = 0;
+
+  // Node whose record is `local_key` in the node table of `shard`.
+  virtual int64_t global_key(int32_t shard, int64_t local_key) const = 0;
+
+  virtual bool save(const std::string& path) const = 0;
+
+  // Reads a router saved to `path`, of any kind; nullptr if the file is
+  // unreadable or was saved for another number of shards.
+  static std::unique_ptr<ShardRouter> load(const std::string& path,
+                                           int32_t num_shards);
+
+ protected:
+  explicit ShardRouter(int32_t num_shards);
+
+  int32_t num_shards_;
+};
+
+// Node K on shard K % N, under local key K / N: hash partitioning.
+class ModuloShardRouter : public ShardRouter {
+ public:
+  explicit ModuloShardRouter(int32_t num_shards)
+      : ShardRouter(num_shards) {
+  }
+
+  int32_t shard_of(int64_t node) const {
+    return node % num_shards_;
+  }
+
+  int64_t local_key(int64_t node) const {
+    return node / num_shards_;
+  }
+
+  int64_t global_key(int32_t shard, int64_t local_key) const {
+    return local_key * num_shards_ + shard;
+  }
+
+  // Writes a "modulo <num_shards>" line.
+  bool save(const std::string& path) const;
+};
+
+// Nodes 0 to num_nodes - 1 split into ranges of consecutive ids, one per
+// shard, the first num_nodes % N of them one node longer: range partitioning.
+// Nodes past the last range are on the last shard.
+class RangeShardRouter : public ShardRouter {
+ public:
+  RangeShardRouter(int32_t num_shards, int64_t num_nodes);
+
+  int64_t num_nodes() const {
+    return num_nodes_;
+  }
+
+  int32_t shard_of(int64_t node) const;
+
+  int64_t local_key(int64_t node) const {
+    return node - range_start(shard_of(node));
+  }
+
+  int64_t global_key(int32_t shard, int64_t local_key) const {
+    return range_start(shard) + local_key;
+  }
+
+  // Writes a "range <num_shards> <num_nodes>" line.
+  bool save(const std::string& path) const;
+
+ private:
+  int64_t range_start(int32_t shard) const;
+
+  int64_t num_nodes_;
+  int64_t range_size_;
+  int32_t num_longer_;
+};
+
+// Host serving each shard, one of the hosts in the hosts file.  The LogStore
+// shards are not routed: they stay on the last host.
+//
+// A shard may also be replicated, to spread the reads of its nodes over more
+// hosts: its host_of() host keeps the primary copy, and the hosts following
+// it in the hosts file one read replica each.
+class HostRouter {
+ public:
+  virtual ~HostRouter() {
+  }
+
+  int32_t num_shards() const {
+    return num_shards_;
+  }
+
+  int32_t num_hosts() const {
+    return num_hosts_;
+  }
+
+  // Host of the primary copy of `shard`.
+  virtual int32_t host_of(int32_t shard) const = 0;
+
+  // Number of hosts with a copy of `shard`; 1 unless it is replicated.
+  int32_t replication(int32_t shard) const {
+    return replication_.empty() ? 1 : replication_[shard];
+  }
+
+  // Hosts with a copy of `shard`, the primary first.
+  std::vector<int32_t> hosts_of(int32_t shard) const;
+
+  // Shards with a copy on `host`, primary or replica, in ascending order.
+  std::vector<int32_t> shards_of(int32_t host) const;
+
+  void set_replication(int32_t shard, int32_t copies);
+
+  // Replicates the shards listed in `path`, one "<shard> <copies>" line each;
+  // lines starting with '#' are skipped.  Fails, leaving the replication as
+  // is, if the file is unreadable or names a shard that does not exist or
+  // more copies than there are hosts.
+  bool load_replication(const std::string& path);
+
+  // Router described by `spec`, for the hosts listed in `hostnames`:
+  //   modulo                shard S on host S % H
+  //   range                 shards split into H ranges of consecutive ids
+  //   consistent[:points]   each shard on the host whose point on a hash ring
+  //                         follows it; a host added to or removed from the
+  //                         hosts file takes or gives up about 1/H of the
+  //                         shards, and no other shard moves
+  //   table:<file>          one "<shard> <host>" line per shard moved off
+  //                         its host by modulo, e.g. to rebalance
+  // nullptr if the spec is not one of these or the table is unreadable.
+  static std::unique_ptr<HostRouter> create(
+      const std::string& spec, int32_t num_shards,
+      const std::vector<std::string>& hostnames);
+
+ protected:
+  HostRouter(int32_t num_shards, int32_t num_hosts);
+
+  int32_t num_shards_;
+  int32_t num_hosts_;
+
+ private:
+  // Copies of each shard; empty while no shard is replicated.
+  std::vector<int32_t> replication_;
+};
+
+class ModuloHostRouter : public HostRouter {
+ public:
+  ModuloHostRouter(int32_t num_shards, int32_t num_hosts)
+      : HostRouter(num_shards, num_hosts) {
+  }
+
+  int32_t host_of(int32_t shard) const {
+    return shard % num_hosts_;
+  }
+};
+
+class RangeHostRouter : public HostRouter {
+ public:
+  RangeHostRouter(int32_t num_shards, int32_t num_hosts)
+      : HostRouter(num_shards, num_hosts) {
+  }
+
+  int32_t host_of(int32_t shard) const {
+    return static_cast<int64_t>(shard) * num_hosts_ / num_shards_;
+  }
+};
+
+class TableHostRouter : public HostRouter {
+ public:
+  TableHostRouter(int32_t num_shards, int32_t num_hosts);
+
+  int32_t host_of(int32_t shard) const {
+    return hosts_[shard];
+  }
+
+  void move(int32_t shard, int32_t host) {
+    hosts_[shard] = host;
+  }
+
+  // Moves the shards listed in `path`; fails, leaving the table as is, if
+  // the file is unreadable or names a shard or host that does not exist.
+  bool load(const std::string& path);
+
+ private:
+  std::vector<int32_t> hosts_;
+};
+
+// Ring points are hashes of the host names, not their positions in the
+// hosts file, so the file can be reordered too.
+class ConsistentHashHostRouter : public HostRouter {
+ public:
+  static const int32_t kDefaultPointsPerHost = 64;
+
+  ConsistentHashHostRouter(int32_t num_shards,
+                           const std::vector<std::string>& hostnames,
+                           int32_t points_per_host = kDefaultPointsPerHost);
+
+  int32_t host_of(int32_t shard) const {
+    return hosts_[shard];
+  }
+
+ private:
+  // Looked up once per shard, at construction.
+  std::vector<int32_t> hosts_;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef SUCCINCT_GRAPH_SHARD_MAP_H
+#define SUCCINCT_GRAPH_SHARD_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Router.h"
+
+// Hash partitioning, but for a table of moved nodes.
+//
+// Node K is on shard K % N under local key K / N, unless it was moved.  A
+// degree-aware partitioning moves the few nodes carrying the most edges or
+// queries elsewhere, and only those are recorded: the table stays small
+// enough for every aggregator and shard to hold.
+class ShardMap : public ModuloShardRouter {
+ public:
+  explicit ShardMap(int32_t num_shards)
+      : ModuloShardRouter(num_shards) {
+  }
+
+  int32_t shard_of(int64_t node) const {
+    if (!by_node_.empty()) {
+      const Entry* entry = find_node(node);
+      if (entry != nullptr) {
+        return entry->shard;
+      }
+    }
+    return node % num_shards_;
+  }
+
+  // Key of `node` in the node table of shard_of(node).
+  int64_t local_key(int64_t node) const {
+    if (!by_node_.empty()) {
+      const Entry* entry = find_node(node);
+      if (entry != nullptr) {
+        return entry->local_key;
+      }
+    }
+    return node / num_shards_;
+  }
+
+  // Node whose record is `local_key` in the node table of `shard`.
+  int64_t global_key(int32_t shard, int64_t local_key) const;
+
+  // Places `node` on `shard` under `local_key`, which no other node may use.
+  void move(int64_t node, int32_t shard, int64_t local_key);
+
+  size_t num_moved() const {
+    return by_node_.size();
+  }
+
+  // Writes the moved nodes to `path` as text: a "shardmap <num_shards>
+  // <num_moved>" line, then one "<node> <shard> <local_key>" line each.
+  bool save(const std::string& path) const;
+
+  // Replaces the moved nodes with those saved to `path`.  Fails, leaving the
+  // map as is, if the file is unreadable or was saved for another number of
+  // shards.
+  bool load(const std::string& path);
+
+ private:
+  struct Entry {
+    int64_t node;
+    int32_t shard;
+    int64_t local_key;
+  };
+
+  const Entry* find_node(int64_t node) const;
+
+  // The moved nodes, sorted by node and by (shard, local key).
+  std::vector<Entry> by_node_;
+  std::vector<Entry> by_slot_;
+};
+
+#endif
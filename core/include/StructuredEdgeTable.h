@@ -2,20 +2,24 @@
 #define STRUCTURED_EDGE_TABLE_H
 
 #include "GraphFormatter.hpp"
+#include "Router.h"
 #include "SuccinctGraph.hpp"
 
+#include <algorithm>
+#include <istream>
 #include <mutex>
+#include <ostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "boost/thread.hpp"
 
-//#include <boost/archive/text_oarchive.hpp>
-//#include <boost/archive/text_iarchive.hpp>
-//#include <boost/serialization/string.hpp>
-//#include <boost/serialization/version.hpp>
-
+// Edge table of a LogStore, kept per (src, atype) list in columns: the
+// timestamps, the destinations, and an arena of the attributes, in time
+// order.  Time ranges are binary searched and read backwards, newest first,
+// stopping at their limit.  Large lists also hash their destinations, so
+// that the edges to given destinations are found without a scan.
 class StructuredEdgeTable {
  public:
 
@@ -30,65 +34,64 @@ class StructuredEdgeTable {
 
   void load();
 
-  // Limitation: we assume timestamp for a particular (src, atype) is
-  // monotonically increasing for now (think: social network).
+  // Timestamps for a particular (src, atype) are expected to mostly
+  // increase (think: social network): appending is cheap, while an older
+  // edge is inserted in place, moving the newer ones.
   //
   // Thread-safe for concurrent writes.
   void add_assoc(int64_t src, int64_t dst, int64_t atype, int64_t timestamp,
                  const std::string& attr);
 
+  // Edges `off` to `off + len` of the list, newest first; a negative `off`
+  // starts at the newest, a negative `len` goes to the oldest.
   std::vector<SuccinctGraph::Assoc> assoc_range(int64_t src, int64_t atype,
                                                 int32_t off, int32_t len);
 
   int64_t assoc_count(int64_t src, int64_t atype) {
     boost::shared_lock<boost::shared_mutex> lk(mutex_);
-    return edges[std::make_pair(src, atype)].size();
+    const EdgeList* list = find_list(src, atype);
+    return list == nullptr ? 0 : list->size();
   }
 
+  // The edges to `dst_id_set` with t_low <= time <= t_high, newest first;
+  // -1 leaves a bound open.
   std::vector<SuccinctGraph::Assoc> assoc_get(
       int64_t src, int64_t atype, const std::set<int64_t>& dst_id_set,
       int64_t t_low, int64_t t_high);
 
+  // The newest `len` edges with t_low <= time <= t_high, newest first; -1
+  // leaves a bound open, and a negative `len` returns them all.
   std::vector<SuccinctGraph::Assoc> assoc_time_range(int64_t src, int64_t atype,
                                                      int64_t t_low,
                                                      int64_t t_high,
                                                      int32_t len);
 
+  // Adds the (src, atype) of every list with edges to `edge_updates`, under
+  // the shard of src, for the update pointers of those shards.
   void build_backfill_edge_updates(
       std::unordered_map<int, GraphFormatter::AssocSet>& edge_updates,
-      int num_shards_to_mod);
+      const ShardRouter& router);
 
   int num_edges() {
     boost::shared_lock<boost::shared_mutex> lk(mutex_);
     return num_edges_;
   }
 
-//    template<class Archive>
-//    void serialize(Archive & ar, const unsigned int version) {
-//        // read class state from archive
-//        ar & edge_file_;
-//        for (auto it = edges.begin(); it != edges.end(); ++it) {
-//            int64_t key = it->first;
-//            auto& map = it->second;
-//            ar & key;
-//            for (auto it2 = map.begin(); it2 != map.end(); ++it2) {
-//                key = it2->first; // atype
-//                auto& vec = it2->second;
-//                ar & key;
-//                for (auto& edge_data : vec) {
-//                    ar & edge_data.dst;
-//                    ar & edge_data.timestamp;
-//                    ar & edge_data.attr;
-//                }
-//            }
-//        }
-//    }
+  // Writes every edge to `path`, replacing it atomically; writers wait
+  // meanwhile.  Returns false on I/O errors.
+  bool save(const std::string& path);
+
+  // Restores the edges saved to `path` by save() into this empty table;
+  // false, leaving it empty, if there are none or they are corrupt.
+  bool load(const std::string& path);
 
   // LinkBench API
   typedef SuccinctGraph::Assoc Link;
 
+  // The oldest link to `id2`, if any.
   bool getLink(Link& link, int64_t id1, int64_t link_type, int64_t id2);
 
+  // Links are listed newest first, as by SuccinctGraph.
   void getLinkList(std::vector<Link>& assocs, int64_t id1, int64_t link_type);
 
   void getLinkList(std::vector<Link>& assocs, int64_t id1, uint64_t link_type,
@@ -98,15 +101,93 @@ class StructuredEdgeTable {
   bool deleteLink(int64_t id1, int64_t link_type, int64_t id2);
  private:
 
-  typedef Link EdgeData;
+  // Edges of one list in ascending time order, edges of equal time in the
+  // order they were added.  Edge i's attribute ends at attr_ends_[i] in
+  // attrs_, where the previous one ends.
+  //
+  // Lists of kDstIndexMinSize edges or more hash the edges by destination
+  // (open addressing, linear probing, at most half full).  Appends add to
+  // the table; inserting an older edge or erasing some renumbers the edges
+  // after them, and rebuilds it once.
+  class EdgeList {
+   public:
+    static const size_t kDstIndexMinSize = 64;
+
+    size_t size() const {
+      return times_.size();
+    }
+
+    bool empty() const {
+      return times_.empty();
+    }
+
+    int64_t time(size_t i) const {
+      return times_[i];
+    }
+
+    int64_t dst(size_t i) const {
+      return dsts_[i];
+    }
+
+    // Adds an edge after the ones at or before `time`.
+    void add(int64_t dst, int64_t time, const std::string& attr);
+
+    // Removes the edges at the indices in `edges`, given in any order (and
+    // sorted by the call), in one pass over the list.
+    void erase(std::vector<size_t>& edges);
+
+    // Appends the indices of the edges to `dst` to `found`, in no particular
+    // order.
+    void find_dst(std::vector<size_t>& found, int64_t dst) const;
 
-  struct EdgeDataComparator {
-    bool operator()(const EdgeData& lhs, const EdgeData& rhs) {
-      return lhs.time < rhs.time;
+    // Index of the first edge at or after `time`, and after `time`.
+    size_t lower_bound(int64_t time) const {
+      return std::lower_bound(times_.begin(), times_.end(), time)
+          - times_.begin();
     }
+
+    size_t upper_bound(int64_t time) const {
+      return std::upper_bound(times_.begin(), times_.end(), time)
+          - times_.begin();
+    }
+
+    Link link(int64_t src, int64_t atype, size_t i) const {
+      uint64_t attr_begin = i == 0 ? 0 : attr_ends_[i - 1];
+      return Link { src, dsts_[i], atype, times_[i], attrs_.substr(
+          attr_begin, attr_ends_[i] - attr_begin) };
+    }
+
+    // Writes the columns to `out`; load() reads them back into an empty
+    // list, returning false if they are corrupt or take more than
+    // `max_bytes`.
+    void save(std::ostream& out) const;
+    bool load(std::istream& in, uint64_t max_bytes);
+
+   private:
+    // Bytes of the columns per edge, but for its attribute.
+    static const uint64_t kColumnBytes = 2 * sizeof(int64_t) + sizeof(uint64_t);
+
+    static uint64_t hash_dst(int64_t dst) {
+      uint64_t h = static_cast<uint64_t>(dst) * 0x9E3779B97F4A7C15ULL;
+      return h ^ (h >> 31);
+    }
+
+    // Adds edge i to the destination index, growing it if needed.
+    void index_dst(size_t i);
+
+    // Rebuilds the destination index, or drops it for short lists.
+    void build_dst_index();
+
+    std::vector<int64_t> times_;
+    std::vector<int64_t> dsts_;
+    std::vector<uint64_t> attr_ends_;
+    std::string attrs_;
+
+    // Edge + 1 of each hash slot, or 0 if empty; empty for short lists.
+    // Edges of a list fit 32 bits, as a LogStore holds far fewer.
+    std::vector<uint32_t> dst_slots_;
   };
 
-  typedef std::set<EdgeData, EdgeDataComparator> EdgeDataSet;
   typedef std::pair<int64_t, int64_t> EdgeRecordId;
   struct pairhash {
    public:
@@ -116,7 +197,14 @@ class StructuredEdgeTable {
     }
   };
 
-  std::unordered_map<EdgeRecordId, EdgeDataSet, pairhash> edges;
+  // List of (src, atype), or nullptr; caller holds the lock.
+  const EdgeList* find_list(int64_t src, int64_t atype) const {
+    std::unordered_map<EdgeRecordId, EdgeList, pairhash>::const_iterator it =
+        edges.find(std::make_pair(src, atype));
+    return it == edges.end() ? nullptr : &it->second;
+  }
+
+  std::unordered_map<EdgeRecordId, EdgeList, pairhash> edges;
 
   std::string edge_file_;
 
@@ -47,6 +47,10 @@ class SuccinctGraph {
   SuccinctGraph& set_npa_sampling_rate(uint32_t sampling_rate);
   SuccinctGraph& set_sa_sampling_rate(uint32_t sampling_rate);
   SuccinctGraph& set_isa_sampling_rate(uint32_t sampling_rate);
+  SuccinctGraph& set_npa_encoding_scheme(NPA::NPAEncodingScheme scheme);
+  SuccinctGraph& set_isa_sampling_scheme(SamplingScheme scheme);
+  // How the memory mapped tables are faulted in by load(); see LoadPolicy.
+  SuccinctGraph& set_load_policy(LoadPolicy policy);
 
   // Constructs the node/edge tables and Succinct-encodes them, using
   // previously specified (possibly default) settings.
@@ -70,8 +74,14 @@ class SuccinctGraph {
   void load(std::string node_succinct_dir, std::string edge_succinct_dir);
   void load_node_table(std::string node_succinct_dir);
   void load_edge_table(std::string edge_succinct_dir);
+  // Maps the edge tombstones (built by linkbench-deletes) and replays and
+  // reopens their delete log, `deleted_edges_file` + ".log".  Without the
+  // file no edge reads as deleted and deleteLink() fails.
   void load_deleted_edges(std::string deleted_edges_file);
 
+  // Logs per-table, per-component load times for the last load().
+  void print_load_stats();
+
   std::string succinct_directory();
 
   int64_t num_nodes();
@@ -194,7 +204,8 @@ class SuccinctGraph {
                                const std::set<int64_t>& dst_id_set,
                                int64_t t_low, int64_t t_high);
 
-  // Returns number of associations in the association list (src, atype).
+  // Returns number of associations in the association list (src, atype),
+  // not counting deleted ones.
   // Undefined behavior if (src, atype) doesn't exist.
   // All arguments can be optional.
   int64_t assoc_count(int64_t src, int64_t atype);
@@ -228,6 +239,16 @@ class SuccinctGraph {
   uint32_t sa_sampling_rate = 64;
   uint32_t isa_sampling_rate = 64;
   uint32_t npa_sampling_rate = 256;
+  // NPA encoding; trades storage for random access latency (see the
+  // "npa-latency" bench in succinct-bench).  Loading picks up whichever
+  // encoding the tables were constructed with.
+  NPA::NPAEncodingScheme npa_encoding_scheme =
+      NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED;
+  // ISA sampling; HYBRID_SAMPLE_BY_INDEX additionally stores exact ISA values
+  // at every node row / edge record start, which is where most extractions
+  // begin.  Also picked up automatically on load.
+  SamplingScheme isa_sampling_scheme = SamplingScheme::FLAT_SAMPLE_BY_INDEX;
+  LoadPolicy load_policy = LoadPolicy::EAGER;
 
   // TODO: consider moving these to GraphFormatter / Serde?
 
@@ -265,7 +286,28 @@ class SuccinctGraph {
     }
   };
 
-  DeletedEdges* deleted_edges;
+  DeletedEdges* deleted_edges = nullptr;
+
+  // Tombstone offset of list (src, atype), or -1 if no edge of it can read
+  // as deleted.  Looked up once per list; edges are then tested by index.
+  inline int64_t tombstones(int64_t src, int64_t atype) {
+    return deleted_edges == nullptr ?
+        -1 : deleted_edges->ListOffset(src, atype);
+  }
+
+  inline bool is_deleted(int64_t tombstones, int64_t idx) {
+    return tombstones != -1 && deleted_edges->IsDeletedAt(tombstones, idx);
+  }
+
+  // Index of the k-th live edge at or after `begin` in a list of `cnt`, or
+  // `cnt` if there are not that many.
+  inline int64_t select_live(int64_t tombstones, int64_t begin, int64_t k,
+                             int64_t cnt) {
+    if (tombstones == -1) {
+      return std::min(begin + k, cnt);
+    }
+    return deleted_edges->SelectLive(tombstones, begin, k, cnt);
+  }
 
   KeepInputSuccinctFile* edge_table_with_input_ = nullptr;
 
@@ -277,12 +319,14 @@ class SuccinctGraph {
   // An edge table offset is -1 iff an assoc list doesn't exist.
   std::vector<int64_t> get_edge_table_offsets(NodeId id, AType atype);
 
+  // `atype` is that of all the lists at `offsets`, or -1 to read it from
+  // each list.
   void extract_neighbors(std::vector<int64_t>& result,
                          const std::vector<int64_t>& offsets,
-                         int32_t skip_length);
+                         int32_t skip_length, int64_t src, int64_t atype);
 
   void extract_edge_attrs(std::vector<std::string>& result, int64_t curr_off,
-                          int32_t skip_length);
+                          int32_t skip_length, int64_t src, int64_t atype);
 
   // Binary search: locates smallest timestamp t, such that t >= t_low.
   // Upon entry, `curr_off` must point to the start of the timestamps of the
@@ -0,0 +1,96 @@
+#ifndef SUCCINCT_GRAPH_TRACE_H
+#define SUCCINCT_GRAPH_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Sampled per-query tracing.  A traced query carries a non-zero trace id,
+// kept in a thread-local "current trace" by whichever thread is working on
+// it; spans opened while a trace is current are timed and appended, tagged
+// with its id, to a Chrome trace file (load it in chrome://tracing or
+// Perfetto).  Spans opened while no trace is current cost a thread-local
+// load.
+//
+// Hosts write their own files; spans of a query are matched across hosts by
+// args.trace_id, and timestamps are wall-clock so files can be merged.
+class Trace {
+ public:
+  // Starts tracing one in every `1 / sample_rate` queries sampled by this
+  // process (per thread), writing spans to `path`.  `pid` labels this
+  // process in the trace and keeps trace ids unique across hosts.  Returns
+  // false if the file cannot be opened.
+  static bool configure(const std::string& path, double sample_rate, int pid);
+
+  // Returns a fresh trace id if the query about to start should be traced,
+  // or 0.  Always 0 unless configured.
+  static int64_t sample();
+
+  static inline int64_t current() {
+    return current_;
+  }
+
+  static inline void set_current(int64_t trace_id) {
+    current_ = trace_id;
+  }
+
+  static inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  // Appends a complete span of trace `trace_id`.  `name` must outlive the
+  // process (e.g. a string literal).
+  static void record(const char* name, int64_t trace_id, uint64_t start_ns,
+                     uint64_t end_ns);
+
+  // Writes buffered spans to the trace file.
+  static void flush();
+
+  // Times the enclosing scope as a span of the current trace, if any.
+  class Span {
+   public:
+    explicit Span(const char* name)
+        : name_(name),
+          trace_id_(current_),
+          start_(trace_id_ != 0 ? now_ns() : 0) {
+    }
+    Span(Span&& other)
+        : name_(other.name_),
+          trace_id_(other.trace_id_),
+          start_(other.start_) {
+      other.trace_id_ = 0;
+    }
+    ~Span() {
+      if (trace_id_ != 0) {
+        record(name_, trace_id_, start_, now_ns());
+      }
+    }
+   private:
+    Span(const Span&);
+    Span& operator=(const Span&);
+
+    const char* name_;
+    int64_t trace_id_;
+    uint64_t start_;
+  };
+
+  // Makes `trace_id` the current trace for the enclosing scope.
+  class Scope {
+   public:
+    explicit Scope(int64_t trace_id)
+        : previous_(current_) {
+      current_ = trace_id;
+    }
+    ~Scope() {
+      current_ = previous_;
+    }
+   private:
+    int64_t previous_;
+  };
+
+ private:
+  static thread_local int64_t current_;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include <iostream>
 
 namespace bitmap {
@@ -160,6 +161,39 @@ class Bitmap {
     return GETBITVAL(data_, i);
   }
 
+  // Number of set bits in [begin, end).
+  size_type Count(pos_type begin, pos_type end) const {
+    size_type count = 0;
+    while (begin < end) {
+      pos_type off = begin % 64;
+      pos_type n = std::min<pos_type>(64 - off, end - begin);
+      count += __builtin_popcountll((data_[begin / 64] >> off)
+          & low_bits_set[n]);
+      begin += n;
+    }
+    return count;
+  }
+
+  // Position of the k-th (0-based) unset bit in [begin, end), or end if
+  // there are not that many.
+  pos_type SelectUnset(pos_type begin, size_type k, pos_type end) const {
+    while (begin < end) {
+      pos_type off = begin % 64;
+      pos_type n = std::min<pos_type>(64 - off, end - begin);
+      data_type unset = (~data_[begin / 64] >> off) & low_bits_set[n];
+      size_type count = __builtin_popcountll(unset);
+      if (k < count) {
+        for (; k > 0; --k) {
+          unset &= unset - 1;
+        }
+        return begin + __builtin_ctzll(unset);
+      }
+      k -= count;
+      begin += n;
+    }
+    return end;
+  }
+
   // Integer operations
   void SetValPos(pos_type pos, data_type val, width_type bits) {
     pos_type s_off = pos % 64;
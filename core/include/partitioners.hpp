@@ -6,8 +6,10 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "ShardMap.h"
 #include "utils.h"
 
 class GraphPartitioner {
@@ -51,6 +53,9 @@ public:
 
 };
 
+// Splits the nodes into ranges of consecutive ids with a RangeShardRouter,
+// and saves it to `node_file_in` + "-shardmap", for the aggregators to route
+// by.
 class RangePartitioner : public GraphPartitioner {
 public:
     RangePartitioner(int32_t num_shards) : num_shards_(num_shards) {};
@@ -80,4 +85,39 @@ public:
     int32_t num_shards_ = 1;
 };
 
+// Hash partitioning that moves the heaviest nodes off their shards, so that
+// no shard is left with much more than its share of the edges and queries.
+//
+// A node's load is its share of all edges, as their source, plus its share of
+// all queries in the query log, if one is given.  Nodes carrying more than
+// `heavy_fraction_` of a shard's average load are placed largest first, each
+// on the shard with the least load so far; every other node stays on shard
+// K % N.  A node moved to another shard is given a local key past the
+// shard's own nodes, and its old slot is left blank.
+//
+// Writes the node and edge splits like HashPartitioner, and the nodes moved
+// as a ShardMap to `node_file_in` + "-shardmap", for the aggregators to route
+// by.
+class DegreeAwarePartitioner : public GraphPartitioner {
+public:
+    DegreeAwarePartitioner(int32_t num_shards, const std::string& query_log)
+        : num_shards_(num_shards), query_log_(query_log) {};
+    ~DegreeAwarePartitioner() {};
+
+    void partition(
+        const std::string& node_file_in,
+        const std::string& edge_file_in);
+
+    // Places the nodes, given the load of every node that has one.
+    ShardMap place(
+        const std::unordered_map<int64_t, double>& loads,
+        int64_t num_nodes) const;
+
+    int32_t num_shards_ = 1;
+    double heavy_fraction_ = 0.01;
+
+    // One query per line, starting with the id of the node it reads.
+    std::string query_log_;
+};
+
 #endif
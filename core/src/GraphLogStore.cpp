@@ -10,8 +10,39 @@ void GraphLogStore::construct() {
 }
 
 void GraphLogStore::load() {
-  LOG_E("Loading GraphLogStore");
+  LOG_E("Loading GraphLogStore\n");
   node_table_ = std::make_shared<KVLogStore>(4294967296ULL);
+  if (node_file_.empty() || edge_file_.empty()
+      || !node_table_->load(node_file_ + "_logstore")) {
+    return;
+  }
+  // Both tables or neither: the nodes without their edges would be a graph
+  // half restored.
+  if (!edge_table_.load(edge_file_ + "_logstore")) {
+    LOG_E("GraphLogStore: No usable edge table snapshot, starting empty\n");
+    node_table_ = std::make_shared<KVLogStore>(4294967296ULL);
+    return;
+  }
+  LOG_E("GraphLogStore: Restored from snapshot (%d edges)\n",
+        edge_table_.num_edges());
+}
+
+bool GraphLogStore::snapshot() {
+  if (node_file_.empty() || edge_file_.empty()) {
+    return false;
+  }
+  return node_table_->save(node_file_ + "_logstore")
+      && edge_table_.save(edge_file_ + "_logstore");
+}
+
+void GraphLogStore::build_backfill_node_updates(
+    std::unordered_map<int, std::vector<int64_t>>& node_updates,
+    const ShardRouter& router) {
+  std::vector<int64_t> nodes;
+  node_table_->keys(nodes);
+  for (int64_t node : nodes) {
+    node_updates[router.shard_of(node)].push_back(node);
+  }
 }
 
 // Serialize into the "[lengths] [attrs]" format, and call append().
@@ -1,128 +1,557 @@
 #include "KVLogStore.h"
 
+#include "utils/succinct_allocator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
 
-int64_t KVLogStore::append(const std::string& value) {
-  boost::unique_lock<boost::shared_mutex> lk(mutex_);
+const uint64_t KVLogStore::kSegmentSize;
+
+namespace {
+
+std::atomic<uint64_t> default_log_capacity(KVLogStore::kDefaultCapacity);
+
+// A snapshot is a header, the n-gram index, the records, and the log
+// segments, page aligned so that they can be mapped in place.  The unused
+// part of the last segment is a hole in the file.
+const char kSnapshotMagic[8] = { 'K', 'V', 'L', 'O', 'G', 'S', 'N', 'P' };
+const uint32_t kSnapshotVersion = 1;
+const uint64_t kSnapshotAlignment = 4096;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t unused;
+  int64_t start_key;
+  int64_t cur_key;
+  uint64_t tail;
+  uint64_t num_records;
+  uint64_t index_offset;
+  uint64_t records_offset;
+  uint64_t log_offset;
+};
 
-  if (tail_ + value.length() > kLogStoreSize) {
-    return -1;   // Data exceeds max chunk size
+struct SnapshotRecord {
+  uint64_t pos;
+  uint64_t len;
+  int64_t key;
+  uint64_t filler;
+};
+
+}  // namespace
+
+KVLogStore::KVLogStore(int64_t start_key, uint64_t capacity,
+                       uint32_t ngram_n)
+    : tail_(0),
+      num_records_(0),
+      start_key_(start_key),
+      cur_key_(start_key),
+      ngram_idx_(ngram_n) {
+  if (capacity == 0) {
+    capacity = default_capacity();
+  }
+  segments_.resize((capacity + kSegmentSize - 1) / kSegmentSize, nullptr);
+}
+
+KVLogStore::~KVLogStore() {
+  SuccinctAllocator allocator;
+  for (char* segment : segments_) {
+    if (!is_mapped(segment)) {
+      allocator.s_free(segment);
+    }
+  }
+  if (mapped_ != nullptr) {
+    munmap(mapped_, mapped_size_);
   }
+}
+
+void KVLogStore::set_default_capacity(uint64_t capacity) {
+  default_log_capacity = capacity;
+}
 
-  int64_t key = cur_key_;
-  cur_key_++;
+uint64_t KVLogStore::default_capacity() {
+  return default_log_capacity;
+}
 
-  uint64_t end = tail_;
-  memcpy(data_ + end, value.c_str(), value.length());
+uint64_t KVLogStore::size() const {
+  return tail_.load(std::memory_order_relaxed);
+}
+
+size_t KVLogStore::index_size() {
+  boost::shared_lock<boost::shared_mutex> lk(index_mutex_);
+  return ngram_idx_.storage_size();
+}
 
-  k2v[key] = end;
-  v2k[end] = key;
+int64_t KVLogStore::reserve(int64_t& key, uint64_t len) {
+  if (len > kSegmentSize) {
+    return -1;  // Would straddle segments
+  }
 
-  // min with 0, since data_pos can be small (or zero) initially
-  for (int64_t i = std::max(static_cast<int64_t>(0),
-                            static_cast<int64_t>(end - ngram_n_));
-      i < end + value.length() - ngram_n_; i++) {
-    uint32_t ngram = Hash::simple_hash3(data_ + i);
-    ngram_idx_[ngram].push_back(i);
+  std::lock_guard<std::mutex> lk(reserve_mutex_);
+  uint64_t tail = tail_.load(std::memory_order_relaxed);
+  uint64_t pos = tail;
+  uint64_t seg_off = pos % kSegmentSize;
+  if (seg_off != 0 && seg_off + len > kSegmentSize) {
+    pos += kSegmentSize - seg_off;  // Start a new segment
+  }
+  uint64_t record = num_records_.load(std::memory_order_relaxed);
+  uint64_t num_new = (pos != tail) ? 2 : 1;
+  if (pos + len > capacity() || pos / kSegmentSize >= segments_.size()
+      || record + num_new > kMaxEntries) {
+    return -1;  // Store is full
+  }
+  if (key == -1) {
+    key = cur_key_.load(std::memory_order_relaxed);
+    if (static_cast<uint64_t>(key - start_key_) >= kMaxEntries) {
+      return -1;  // Out of keys
+    }
+  }
+  char*& segment = segments_[pos / kSegmentSize];
+  if (segment == nullptr) {
+    segment = static_cast<char*>(SuccinctAllocator().s_malloc(kSegmentSize));
+    if (segment == nullptr) {
+      LOG_E("[LOGSTORE] Could not allocate a segment\n");
+      return -1;
+    }
   }
-  tail_ += value.length();
 
+  if (pos != tail) {
+    // The unused tail of the last segment is zeroed, so that no search
+    // matches in it.
+    memset(at(tail), 0, pos - tail);
+    records_.ensure(record);
+    Record& filler = records_[record++];
+    filler.pos = tail;
+    filler.len = pos - tail;
+    filler.filler = true;
+    filler.key.store(-1, std::memory_order_relaxed);
+    filler.done.store(true, std::memory_order_relaxed);
+  }
+  records_.ensure(record);
+  Record& r = records_[record];
+  r.pos = pos;
+  r.len = len;
+  r.key.store(key, std::memory_order_relaxed);
+  if (key == cur_key_.load(std::memory_order_relaxed)) {
+    dense_records_.ensure(key - start_key_);
+    cur_key_.store(key + 1, std::memory_order_release);
+  }
+  num_records_.store(record + 1, std::memory_order_release);
+  tail_.store(pos + len, std::memory_order_relaxed);
+  return record;
+}
+
+int64_t KVLogStore::find_record(int64_t key) {
+  if (is_dense(key)) {
+    return static_cast<int64_t>(dense_records_[key - start_key_].load(
+        std::memory_order_acquire)) - 1;
+  }
+  boost::shared_lock<boost::shared_mutex> lk(sparse_mutex_);
+  std::unordered_map<int64_t, uint64_t>::const_iterator it =
+      sparse_records_.find(key);
+  return it == sparse_records_.end() ? -1 : it->second;
+}
+
+void KVLogStore::publish(int64_t key, uint64_t record) {
+  uint64_t replaced;
+  if (is_dense(key)) {
+    replaced = dense_records_[key - start_key_].exchange(
+        record + 1, std::memory_order_acq_rel);
+  } else {
+    boost::unique_lock<boost::shared_mutex> lk(sparse_mutex_);
+    std::unordered_map<int64_t, uint64_t>::iterator it =
+        sparse_records_.find(key);
+    replaced = (it == sparse_records_.end()) ? 0 : it->second + 1;
+    sparse_records_[key] = record;
+  }
+  if (replaced != 0) {
+    records_[replaced - 1].key.store(-1, std::memory_order_relaxed);
+  }
+}
+
+int64_t KVLogStore::write(int64_t key, const std::string& value) {
+  int64_t reserved = reserve(key, value.length());
+  if (reserved == -1) {
+    return -1;
+  }
+  uint64_t record = reserved;
+  Record& r = records_[record];
+  memcpy(at(r.pos), value.c_str(), value.length());
+
+  COND_LOG_E("[LOGSTORE] Record (%" PRId64 ", %" PRIu64 ")\n", key, r.pos);
+
+  r.done.store(true, std::memory_order_release);
+  publish(key, record);
+  index_committed();
   return key;
 }
 
+void KVLogStore::index_committed() {
+  // Every writer gets here after its record is done, so whichever completes
+  // the committed prefix indexes it.
+  boost::unique_lock<boost::shared_mutex> lk(index_mutex_);
+  uint64_t n = ngram_idx_.n();
+  uint64_t num_records = num_records_.load(std::memory_order_acquire);
+  while (indexed_records_ < num_records
+      && records_[indexed_records_].done.load(std::memory_order_acquire)) {
+    const Record& r = records_[indexed_records_];
+    if (!r.filler) {
+      // Index every n-gram ending in the value, including the ones that
+      // start in the previous value of the same segment.
+      uint64_t seg_begin = r.pos - r.pos % kSegmentSize;
+      uint64_t end = r.pos + r.len;
+      uint64_t first = std::max(seg_begin, r.pos < n ? 0 : r.pos - n + 1);
+      for (uint64_t i = first; i + n <= end; i++) {
+        ngram_idx_.add(ngram_idx_.key(at(i)), i);
+      }
+    }
+    indexed_tail_ = r.pos + r.len;
+    indexed_records_++;
+  }
+}
+
+int64_t KVLogStore::append(const std::string& value) {
+  return write(-1, value);
+}
+
 int64_t KVLogStore::insert(const int64_t key, const std::string& value) {
-  boost::unique_lock<boost::shared_mutex> lk(mutex_);
+  if (key < 0) {
+    return -1;
+  }
+  return write(key, value);
+}
 
-  uint64_t end = tail_;
-  memcpy(data_ + end, value.c_str(), value.length());
+bool KVLogStore::matches_at(uint64_t pos, const std::string& query,
+                            uint64_t tail) {
+  return pos + query.length() <= tail
+      && pos % kSegmentSize + query.length() <= kSegmentSize
+      && memcmp(at(pos), query.data(), query.length()) == 0;
+}
 
-  COND_LOG_E("[LOGSTORE] K2V mapping (%lld, %llu)\n", key, end);
-  COND_LOG_E("[LOGSTORE] V2K mapping (%llu, %lld)\n", end, key);
+void KVLogStore::find_matches(std::vector<uint64_t>& matches,
+                              const std::string& query, uint64_t tail) {
+  // The n-grams at offsets 0, n, 2n, ... and the last one cover the query;
+  // a match starts at p only if each n-gram at offset j occurs at p + j.
+  uint64_t n = ngram_idx_.n();
+  std::vector<std::pair<const PostingList*, uint64_t>> ngrams;
+  for (uint64_t j = 0; j < query.length(); j += n) {
+    j = std::min(j, query.length() - n);
+    const PostingList* list = ngram_idx_.find(ngram_idx_.key(&query[j]));
+    if (list == nullptr) {
+      return;
+    }
+    ngrams.push_back(std::make_pair(list, j));
+  }
 
-  k2v[key] = end;
-  v2k[end] = key;
+  // Candidates come from the shortest list.  Lists at most
+  // kIntersectRatio times longer filter them before the (random access)
+  // comparison with the log; seeking through a much longer list costs more
+  // than the comparisons it saves.
+  std::sort(ngrams.begin(), ngrams.end(),
+            [](const std::pair<const PostingList*, uint64_t>& a,
+               const std::pair<const PostingList*, uint64_t>& b) {
+              return a.first->size() < b.first->size();
+            });
+  uint64_t max_filter_size = ngrams[0].first->size() * kIntersectRatio;
+  std::vector<PostingList::Iterator> filters;
+  for (size_t i = 1; i < ngrams.size() && filters.size() + 1 < max_ngrams_
+      && ngrams[i].first->size() <= max_filter_size; i++) {
+    filters.push_back(PostingList::Iterator(*ngrams[i].first));
+  }
 
-  // min with 0, since data_pos can be small (or zero) initially
-  for (int64_t i = std::max(static_cast<int64_t>(0),
-                            static_cast<int64_t>(end - ngram_n_));
-      i < end + value.length() - ngram_n_; i++) {
-    uint32_t ngram = Hash::simple_hash3(data_ + i);
-    ngram_idx_[ngram].push_back(i);
+  uint64_t driver_offset = ngrams[0].second;
+  for (PostingList::Iterator it(*ngrams[0].first); it.valid(); it.next()) {
+    if (it.value() < driver_offset) {
+      continue;
+    }
+    uint64_t candidate = it.value() - driver_offset;
+    bool found = true;
+    for (size_t i = 0; i < filters.size() && found; i++) {
+      uint64_t target = candidate + ngrams[i + 1].second;
+      filters[i].seek(target);
+      if (!filters[i].valid()) {
+        return;
+      }
+      found = filters[i].value() == target;
+    }
+    if (found && matches_at(candidate, query, tail)) {
+      matches.push_back(candidate);
+    }
   }
-  tail_ += value.length();
+}
 
-  return key;
+void KVLogStore::scan_matches(std::vector<uint64_t>& matches,
+                              const std::string& query, uint64_t tail) {
+  for (uint64_t seg_begin = 0; seg_begin < tail; seg_begin += kSegmentSize) {
+    const char* begin = at(seg_begin);
+    const char* end = begin
+        + std::min<uint64_t>(kSegmentSize, tail - seg_begin);
+    const char* it = begin;
+    while ((it = std::search(it, end, query.begin(), query.end())) != end) {
+      matches.push_back(seg_begin + (it - begin));
+      it++;
+    }
+  }
 }
 
 void KVLogStore::search(std::set<int64_t> &_return, const std::string& query) {
   _return.clear();
-  COND_LOG_E("[LOGSTORE] search string '%s' (size %d)\n", query.c_str(),
+  COND_LOG_E("[LOGSTORE] search string '%s' (size %zu)\n", query.c_str(),
              query.length());
+  if (query.empty()) {
+    return;
+  }
 
-  char *substr = (char *) query.c_str();
-  char *suffix = substr + ngram_n_;
-  bool skip_filter = (query.length() <= ngram_n_);
-  size_t suffix_len = skip_filter ? 0 : query.length() - ngram_n_;
-  uint32_t prefix_ngram = Hash::simple_hash3(substr);
-
-  boost::shared_lock<boost::shared_mutex> lk(mutex_);
-  std::vector<uint32_t> idx_off = ngram_idx_[prefix_ngram];
-
-  COND_LOG_E("[LOGSTORE] idx sizes: %d, substring '%s'\n", idx_off.size(),
-             substr);
-  for (uint32_t i = 0; i < idx_off.size(); i++) {
-    if (skip_filter
-        || strncmp(data_ + idx_off[i] + ngram_n_, suffix, suffix_len) == 0) {
-      // TODO: Take care of query.length() < ngram_n_ case
-      BwdMap::iterator it = std::prev(v2k.upper_bound(idx_off[i]));
-      if (it->second > 0) {
-        _return.insert(it->second);
+  boost::shared_lock<boost::shared_mutex> lk(index_mutex_);
+  std::vector<uint64_t> matches;
+  if (query.length() < ngram_idx_.n()) {
+    scan_matches(matches, query, indexed_tail_);
+  } else {
+    find_matches(matches, query, indexed_tail_);
+  }
+
+  COND_LOG_E("[LOGSTORE] %zu matches\n", matches.size());
+  // Matches are ascending, so the record search gallops forward from the
+  // record of the previous match.
+  uint64_t record = 0;
+  for (size_t i = 0; i < matches.size(); i++) {
+    uint64_t step = 1;
+    while (record + step < indexed_records_
+        && records_[record + step].pos <= matches[i]) {
+      record += step;
+      step *= 2;
+    }
+    // The match is in [record, hi), and in its last record at or before it.
+    uint64_t hi = std::min(record + step, indexed_records_);
+    while (hi - record > 1) {
+      uint64_t mid = record + (hi - record) / 2;
+      if (records_[mid].pos <= matches[i]) {
+        record = mid;
+      } else {
+        hi = mid;
       }
     }
+    // Appended keys ascend with their records, so hint at the end.
+    int64_t key = records_[record].key.load(std::memory_order_relaxed);
+    if (key >= 0) {
+      _return.insert(_return.end(), key);
+    }
   }
 }
 
 void KVLogStore::get_value(std::string &value, uint64_t key) {
   value.clear();
 
-  boost::shared_lock<boost::shared_mutex> lk(mutex_);
+  COND_LOG_E("[LOGSTORE] Get request for key %" PRIu64 "\n", key);
 
-  COND_LOG_E("[LOGSTORE] Get request for key %llu\n", key);
-
-  FwdMap::iterator it = k2v.find(key);
-  if (it == k2v.end()) {
-    COND_LOG_E("[LOGSTORE] Key not found!\n", key);
+  int64_t record = find_record(key);
+  if (record == -1) {
+    COND_LOG_E("[LOGSTORE] Key not found!\n");
     return;
   }
 
-  int32_t start = it->second;
-  BwdMap::iterator bwd_it = v2k.find(start);
-  bwd_it++;
-  int32_t end;
-  if (bwd_it != v2k.end())
-    end = bwd_it->first;
-  else
-    end = tail_;
-  int32_t len = end - start;
-  COND_LOG_E("[LOGSTORE] start = %u, end = %u, len = %u, tail_ = %u\n", start,
-             end, len, tail_);
-
-  value.assign(data_ + start, len);
+  const Record& r = records_[record];
+  COND_LOG_E("[LOGSTORE] pos = %" PRIu64 ", len = %" PRIu64 "\n", r.pos,
+             r.len);
+  value.assign(at(r.pos), r.len);
 }
 
 bool KVLogStore::remove(int64_t key) {
-  FwdMap::iterator fwd_it;
-  BwdMap::iterator bwd_it;
-  {
-    boost::shared_lock<boost::shared_mutex> lk(mutex_);
-    fwd_it = k2v.find(key);
-    if (fwd_it == k2v.end())
+  uint64_t removed;
+  if (is_dense(key)) {
+    removed = dense_records_[key - start_key_].exchange(
+        0, std::memory_order_acq_rel);
+  } else {
+    boost::unique_lock<boost::shared_mutex> lk(sparse_mutex_);
+    std::unordered_map<int64_t, uint64_t>::iterator it =
+        sparse_records_.find(key);
+    if (it == sparse_records_.end()) {
       return false;
-    bwd_it = v2k.find(fwd_it->second);
+    }
+    removed = it->second + 1;
+    sparse_records_.erase(it);
+  }
+  if (removed == 0) {
+    return false;
+  }
+
+  // Tombstone: the value keeps its place in the log, but searches no longer
+  // report it.
+  records_[removed - 1].key.store(-1, std::memory_order_relaxed);
+  return true;
+}
+
+void KVLogStore::keys(std::vector<int64_t>& keys) {
+  keys.clear();
+  int64_t end_key = cur_key_.load(std::memory_order_acquire);
+  for (int64_t key = start_key_; key < end_key; key++) {
+    if (dense_records_[key - start_key_].load(std::memory_order_acquire)
+        != 0) {
+      keys.push_back(key);
+    }
+  }
+  boost::shared_lock<boost::shared_mutex> lk(sparse_mutex_);
+  for (const auto& entry : sparse_records_) {
+    keys.push_back(entry.first);
+  }
+}
+
+bool KVLogStore::save(const std::string& path) {
+  std::string tmp_path = path + ".tmp";
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    LOG_E("[LOGSTORE] Could not create %s\n", tmp_path.c_str());
+    return false;
+  }
+
+  SnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+  header.version = kSnapshotVersion;
+  header.start_key = start_key_;
+  header.index_offset = sizeof(header);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  {
+    // The index is the only part that changes in place; the records and log
+    // below the indexed tail are immutable, but for the keys of records.
+    boost::shared_lock<boost::shared_mutex> lk(index_mutex_);
+    header.num_records = indexed_records_;
+    header.tail = indexed_tail_;
+    ngram_idx_.serialize(out);
+  }
+  header.cur_key = cur_key_.load(std::memory_order_acquire);
+
+  header.records_offset = out.tellp();
+  for (uint64_t i = 0; i < header.num_records; i++) {
+    const Record& r = records_[i];
+    SnapshotRecord record = { r.pos, r.len, r.key.load(
+        std::memory_order_relaxed), r.filler };
+    out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  }
+
+  uint64_t end = out.tellp();
+  header.log_offset = (end + kSnapshotAlignment - 1) / kSnapshotAlignment
+      * kSnapshotAlignment;
+  out.write(std::string(header.log_offset - end, '\0').data(),
+            header.log_offset - end);
+  uint64_t num_segments = (header.tail + kSegmentSize - 1) / kSegmentSize;
+  for (uint64_t seg = 0; seg < num_segments; seg++) {
+    uint64_t seg_begin = seg * kSegmentSize;
+    out.write(at(seg_begin), std::min(kSegmentSize, header.tail - seg_begin));
+  }
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.close();
+
+  // Extend the last segment to its full size, for load() to map it whole.
+  uint64_t file_size = header.log_offset + num_segments * kSegmentSize;
+  int fd = open(tmp_path.c_str(), O_WRONLY);
+  bool ok = !out.fail() && fd != -1 && ftruncate(fd, file_size) == 0
+      && fsync(fd) == 0;
+  if (fd != -1) {
+    close(fd);
+  }
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG_E("[LOGSTORE] Could not write snapshot %s\n", path.c_str());
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  LOG_E("[LOGSTORE] Saved %" PRIu64 " records (%" PRIu64 " bytes) to %s\n",
+        header.num_records, header.tail, path.c_str());
+  return true;
+}
+
+bool KVLogStore::load(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0
+      || static_cast<uint64_t>(st.st_size) < sizeof(SnapshotHeader)) {
+    close(fd);
+    return false;
+  }
+  void* data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                    0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG_E("[LOGSTORE] Could not map %s\n", path.c_str());
+    return false;
+  }
+
+  const uint8_t* buf = static_cast<const uint8_t*>(data);
+  SnapshotHeader header;
+  memcpy(&header, buf, sizeof(header));
+  uint64_t num_segments = (header.tail + kSegmentSize - 1) / kSegmentSize;
+  // The index, the records and the log follow one another within the file;
+  // the counts are bounded before the offsets, so that nothing overflows.
+  if (memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0
+      || header.version != kSnapshotVersion || header.start_key != start_key_
+      || num_segments > segments_.size() || header.num_records > kMaxEntries
+      || header.cur_key < start_key_
+      || static_cast<uint64_t>(header.cur_key - start_key_) > kMaxEntries
+      || header.index_offset < sizeof(SnapshotHeader)
+      || header.records_offset < header.index_offset
+      || header.log_offset > static_cast<uint64_t>(st.st_size)
+      || header.records_offset > header.log_offset
+      || header.num_records
+          > (header.log_offset - header.records_offset) / sizeof(SnapshotRecord)
+      || num_segments * kSegmentSize
+          > static_cast<uint64_t>(st.st_size) - header.log_offset
+      || num_records_.load() != 0) {
+    LOG_E("[LOGSTORE] %s is not a snapshot of this store\n", path.c_str());
+    munmap(data, st.st_size);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> reserve_lk(reserve_mutex_);
+  boost::unique_lock<boost::shared_mutex> index_lk(index_mutex_);
+  mapped_ = static_cast<char*>(data);
+  mapped_size_ = st.st_size;
+  for (uint64_t seg = 0; seg < num_segments; seg++) {
+    segments_[seg] = mapped_ + header.log_offset + seg * kSegmentSize;
+  }
+  ngram_idx_.deserialize(buf + header.index_offset);
+
+  for (uint64_t i = 0; i < header.num_records; i++) {
+    SnapshotRecord record;
+    memcpy(&record, buf + header.records_offset + i * sizeof(record),
+           sizeof(record));
+    records_.ensure(i);
+    Record& r = records_[i];
+    r.pos = record.pos;
+    r.len = record.len;
+    r.filler = record.filler != 0;
+    r.key.store(record.key, std::memory_order_relaxed);
+    r.done.store(true, std::memory_order_relaxed);
+  }
+  for (int64_t key = start_key_; key < header.cur_key;
+      key += static_cast<int64_t>(kChunkSize)) {
+    dense_records_.ensure(key - start_key_);
+  }
+  cur_key_.store(header.cur_key, std::memory_order_release);
+  for (uint64_t i = 0; i < header.num_records; i++) {
+    int64_t key = records_[i].key.load(std::memory_order_relaxed);
+    if (key >= 0) {
+      publish(key, i);
+    }
   }
+  tail_.store(header.tail, std::memory_order_relaxed);
+  num_records_.store(header.num_records, std::memory_order_release);
+  indexed_records_ = header.num_records;
+  indexed_tail_ = header.tail;
 
-  boost::unique_lock<boost::shared_mutex> lk(mutex_);
-  v2k[fwd_it->second] = -1;
-  k2v.erase(fwd_it);
+  // The index and records were copied out; only the log stays mapped.
+  madvise(mapped_, header.log_offset, MADV_DONTNEED);
+  LOG_E("[LOGSTORE] Loaded %" PRIu64 " records (%" PRIu64 " bytes) from %s\n",
+        header.num_records, header.tail, path.c_str());
   return true;
 }
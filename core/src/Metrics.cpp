@@ -0,0 +1,261 @@
+#include "Metrics.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+inline uint64_t load(const std::atomic<uint64_t>& slot) {
+  return slot.load(std::memory_order_relaxed);
+}
+
+inline void json_string(std::ostream& out, const std::string& s) {
+  out << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+Metrics::Id find_or_register(std::mutex& mutex, std::vector<std::string>& names,
+                             const std::string& name, int max_size) {
+  std::lock_guard<std::mutex> lk(mutex);
+  auto it = std::find(names.begin(), names.end(), name);
+  if (it != names.end()) {
+    return it - names.begin();
+  }
+  if (names.size() >= (size_t) max_size) {
+    LOG_E("[FATAL] Metrics: too many metrics registering '%s'\n",
+          name.c_str());
+    abort();
+  }
+  names.push_back(name);
+  return names.size() - 1;
+}
+
+}  // namespace
+
+struct Metrics::Registry {
+  Registry() : retired(nullptr) {
+  }
+
+  std::mutex mutex;
+  std::vector<std::string> counter_names;
+  std::vector<std::string> histogram_names;
+  std::vector<ThreadSlots*> live_threads;
+  ThreadSlots* retired;
+};
+
+thread_local Metrics::ThreadSlots* Metrics::thread_slots_ = nullptr;
+
+// Allocated once and never freed, so that threads exiting during static
+// destruction can still fold their slots into it.
+Metrics::Registry& Metrics::registry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+Metrics::HistogramSlots::HistogramSlots() {
+  for (int b = 0; b < NUM_BUCKETS; ++b) {
+    buckets[b].store(0, std::memory_order_relaxed);
+  }
+  count.store(0, std::memory_order_relaxed);
+  sum.store(0, std::memory_order_relaxed);
+  max.store(0, std::memory_order_relaxed);
+}
+
+Metrics::ThreadSlots::ThreadSlots() {
+  for (int i = 0; i < MAX_COUNTERS; ++i) {
+    counters[i].store(0, std::memory_order_relaxed);
+  }
+  for (int i = 0; i < MAX_HISTOGRAMS; ++i) {
+    histograms[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+Metrics::ThreadSlots::~ThreadSlots() {
+  for (int i = 0; i < MAX_HISTOGRAMS; ++i) {
+    delete histograms[i].load(std::memory_order_relaxed);
+  }
+}
+
+// Readers load the pointer with acquire, so they see the zeroed buckets.
+Metrics::HistogramSlots* Metrics::add_histogram(ThreadSlots& slots,
+                                                Id histogram) {
+  HistogramSlots* h = new HistogramSlots();
+  slots.histograms[histogram].store(h, std::memory_order_release);
+  return h;
+}
+
+// Owns a thread's slots: on thread exit, folds them into the registry's
+// retired totals and unregisters them.
+class ThreadSlotsHolder {
+ public:
+  ThreadSlotsHolder() : slots_(nullptr) {
+  }
+
+  ~ThreadSlotsHolder() {
+    if (slots_ == nullptr) {
+      return;
+    }
+    Metrics::Registry& r = Metrics::registry();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    if (r.retired == nullptr) {
+      r.retired = new Metrics::ThreadSlots();
+    }
+    fold(*r.retired, *slots_);
+    r.live_threads.erase(
+        std::find(r.live_threads.begin(), r.live_threads.end(), slots_));
+    Metrics::thread_slots_ = nullptr;
+    delete slots_;
+  }
+
+  Metrics::ThreadSlots* slots_;
+
+  // dst += src, taking the max of the histogram maxima.
+  static void fold(Metrics::ThreadSlots& dst,
+                   const Metrics::ThreadSlots& src) {
+    for (int i = 0; i < Metrics::MAX_COUNTERS; ++i) {
+      Metrics::bump(dst.counters[i], load(src.counters[i]));
+    }
+    for (int i = 0; i < Metrics::MAX_HISTOGRAMS; ++i) {
+      const Metrics::HistogramSlots* s_ptr =
+          src.histograms[i].load(std::memory_order_acquire);
+      if (s_ptr == nullptr) {
+        continue;
+      }
+      Metrics::HistogramSlots* d_ptr =
+          dst.histograms[i].load(std::memory_order_relaxed);
+      if (d_ptr == nullptr) {
+        d_ptr = Metrics::add_histogram(dst, i);
+      }
+      Metrics::HistogramSlots& d = *d_ptr;
+      const Metrics::HistogramSlots& s = *s_ptr;
+      for (int b = 0; b < Metrics::NUM_BUCKETS; ++b) {
+        Metrics::bump(d.buckets[b], load(s.buckets[b]));
+      }
+      Metrics::bump(d.count, load(s.count));
+      Metrics::bump(d.sum, load(s.sum));
+      d.max.store(std::max(load(d.max), load(s.max)),
+                  std::memory_order_relaxed);
+    }
+  }
+};
+
+Metrics::Id Metrics::counter(const std::string& name) {
+  Registry& r = registry();
+  return find_or_register(r.mutex, r.counter_names, name, MAX_COUNTERS);
+}
+
+Metrics::Id Metrics::histogram(const std::string& name) {
+  Registry& r = registry();
+  return find_or_register(r.mutex, r.histogram_names, name, MAX_HISTOGRAMS);
+}
+
+Metrics::ThreadSlots* Metrics::register_thread() {
+  static thread_local ThreadSlotsHolder holder;
+  assert(holder.slots_ == nullptr);
+  holder.slots_ = new ThreadSlots();
+  thread_slots_ = holder.slots_;
+
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lk(r.mutex);
+  r.live_threads.push_back(holder.slots_);
+  return holder.slots_;
+}
+
+uint64_t Metrics::bucket_limit(int index) {
+  if (index < (2 << SUB_BUCKET_BITS)) {
+    return index;
+  }
+  int shift = (index >> SUB_BUCKET_BITS) - 1;
+  uint64_t lowest = (uint64_t) (index - (shift << SUB_BUCKET_BITS)) << shift;
+  return lowest + (1ULL << shift) - 1;
+}
+
+std::string Metrics::to_json() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lk(r.mutex);
+
+  // Sum of all threads, dead or alive.
+  std::unique_ptr<ThreadSlots> total_ptr(new ThreadSlots());
+  ThreadSlots& total = *total_ptr;
+  if (r.retired != nullptr) {
+    ThreadSlotsHolder::fold(total, *r.retired);
+  }
+  for (ThreadSlots* slots : r.live_threads) {
+    ThreadSlotsHolder::fold(total, *slots);
+  }
+
+  std::ostringstream out;
+  out << "{\"counters\": {";
+  for (size_t i = 0; i < r.counter_names.size(); ++i) {
+    out << (i == 0 ? "" : ", ");
+    json_string(out, r.counter_names[i]);
+    out << ": " << load(total.counters[i]);
+  }
+  out << "}, \"histograms\": {";
+  const double percentiles[] = { 50, 90, 99, 99.9 };
+  const char* percentile_names[] = { "p50", "p90", "p99", "p999" };
+  const HistogramSlots empty;
+  for (size_t i = 0; i < r.histogram_names.size(); ++i) {
+    const HistogramSlots* h_ptr =
+        total.histograms[i].load(std::memory_order_relaxed);
+    const HistogramSlots& h = h_ptr == nullptr ? empty : *h_ptr;
+    uint64_t count = load(h.count);
+    out << (i == 0 ? "" : ", ");
+    json_string(out, r.histogram_names[i]);
+    out << ": {\"count\": " << count << ", \"mean\": "
+        << (count == 0 ? 0 : load(h.sum) / count);
+
+    int bucket = 0;
+    uint64_t cumulative = 0;
+    for (int p = 0; p < 4; ++p) {
+      uint64_t target = std::max<uint64_t>(
+          1, (uint64_t) std::ceil(percentiles[p] / 100. * count));
+      uint64_t value = 0;
+      if (count > 0) {
+        // Racing writers may have bumped count before the bucket.
+        while (cumulative + load(h.buckets[bucket]) < target
+            && bucket < NUM_BUCKETS - 1) {
+          cumulative += load(h.buckets[bucket]);
+          ++bucket;
+        }
+        value = std::min(bucket_limit(bucket), load(h.max));
+      }
+      out << ", \"" << percentile_names[p] << "\": " << value;
+    }
+    out << ", \"max\": " << load(h.max) << "}";
+  }
+  out << "}}";
+  return out.str();
+}
+
+uint64_t Metrics::counter_value(const std::string& name) {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lk(r.mutex);
+  auto it = std::find(r.counter_names.begin(), r.counter_names.end(), name);
+  if (it == r.counter_names.end()) {
+    return 0;
+  }
+  int id = it - r.counter_names.begin();
+  uint64_t value = 0;
+  if (r.retired != nullptr) {
+    value += load(r.retired->counters[id]);
+  }
+  for (ThreadSlots* slots : r.live_threads) {
+    value += load(slots->counters[id]);
+  }
+  return value;
+}
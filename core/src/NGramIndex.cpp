@@ -0,0 +1,120 @@
+#include "NGramIndex.h"
+
+#include <cstring>
+
+namespace {
+
+const size_t kMaxVarintBytes = 10;
+
+template<typename T>
+size_t write_pod(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  return sizeof(T);
+}
+
+// Snapshot buffers need not be aligned, so fields are copied out.
+template<typename T>
+size_t read_pod(T& value, const uint8_t* buf) {
+  memcpy(&value, buf, sizeof(T));
+  return sizeof(T);
+}
+
+}  // namespace
+
+void PostingList::append(uint64_t pos) {
+  if (size_ == 0) {
+    first_ = pos;
+  } else if (size_ % kBlockSize == 0) {
+    Block block = { pos, bytes_.size() };
+    blocks_.push_back(block);
+  } else {
+    if (bytes_.capacity() - bytes_.size() < kMaxVarintBytes) {
+      bytes_.reserve(bytes_.size() + bytes_.size() / 4 + 16);
+    }
+    uint64_t delta = pos - last_;
+    while (delta >= 0x80) {
+      bytes_.push_back(static_cast<uint8_t>(delta) | 0x80);
+      delta >>= 7;
+    }
+    bytes_.push_back(static_cast<uint8_t>(delta));
+  }
+  last_ = pos;
+  size_++;
+}
+
+size_t PostingList::storage_size() const {
+  return bytes_.capacity() + blocks_.capacity() * sizeof(Block);
+}
+
+size_t PostingList::serialize(std::ostream& out) const {
+  size_t out_size = write_pod(out, size_);
+  out_size += write_pod(out, first_);
+  out_size += write_pod(out, last_);
+  out_size += write_pod(out, static_cast<uint64_t>(bytes_.size()));
+  out_size += write_pod(out, static_cast<uint64_t>(blocks_.size()));
+  out.write(reinterpret_cast<const char*>(bytes_.data()), bytes_.size());
+  out_size += bytes_.size();
+  out.write(reinterpret_cast<const char*>(blocks_.data()),
+            blocks_.size() * sizeof(Block));
+  out_size += blocks_.size() * sizeof(Block);
+  return out_size;
+}
+
+size_t PostingList::deserialize(const uint8_t* buf) {
+  const uint8_t* data = buf;
+  uint64_t num_bytes, num_blocks;
+  data += read_pod(size_, data);
+  data += read_pod(first_, data);
+  data += read_pod(last_, data);
+  data += read_pod(num_bytes, data);
+  data += read_pod(num_blocks, data);
+  bytes_.assign(data, data + num_bytes);
+  data += num_bytes;
+  blocks_.resize(num_blocks);
+  memcpy(blocks_.data(), data, num_blocks * sizeof(Block));
+  data += num_blocks * sizeof(Block);
+  return data - buf;
+}
+
+const uint32_t NGramIndex::kMinN;
+const uint32_t NGramIndex::kMaxN;
+
+NGramIndex::NGramIndex(uint32_t n)
+    : n_(std::min(std::max(n, kMinN), kMaxN)) {
+}
+
+size_t NGramIndex::storage_size() const {
+  // One heap node per entry, plus the bucket array.
+  size_t size = lists_.bucket_count() * sizeof(void*)
+      + lists_.size() * (sizeof(std::pair<const uint32_t, PostingList>)
+          + 2 * sizeof(void*));
+  for (const auto& entry : lists_) {
+    size += entry.second.storage_size();
+  }
+  return size;
+}
+
+size_t NGramIndex::serialize(std::ostream& out) const {
+  size_t out_size = write_pod(out, n_);
+  out_size += write_pod(out, static_cast<uint64_t>(lists_.size()));
+  for (const auto& entry : lists_) {
+    out_size += write_pod(out, entry.first);
+    out_size += entry.second.serialize(out);
+  }
+  return out_size;
+}
+
+size_t NGramIndex::deserialize(const uint8_t* buf) {
+  const uint8_t* data = buf;
+  uint64_t num_lists;
+  data += read_pod(n_, data);
+  data += read_pod(num_lists, data);
+  lists_.clear();
+  lists_.reserve(num_lists);
+  for (uint64_t i = 0; i < num_lists; i++) {
+    uint32_t key;
+    data += read_pod(key, data);
+    data += lists_[key].deserialize(data);
+  }
+  return data - buf;
+}
@@ -0,0 +1,143 @@
+#include "Numa.h"
+
+#include "utils.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// From <numaif.h>, which is only installed with libnuma.
+const int kMpolDefault = 0;
+const int kMpolPreferred = 1;
+
+const char* kNodeDir = "/sys/devices/system/node";
+
+// Parses a sysfs cpu / node list such as "0-3,8-11".
+std::vector<int> parse_list(const std::string& list) {
+  std::vector<int> result;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    size_t dash = range.find('-');
+    try {
+      int lo = std::stoi(range.substr(0, dash));
+      int hi = dash == std::string::npos ?
+          lo : std::stoi(range.substr(dash + 1));
+      for (int i = lo; i <= hi; ++i) {
+        result.push_back(i);
+      }
+    } catch (const std::exception&) {
+      // Empty or malformed entry (e.g. a trailing newline): skip it.
+    }
+  }
+  return result;
+}
+
+std::string read_line(const std::string& path) {
+  std::ifstream in(path);
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+struct Topology {
+  Topology() {
+#ifdef __linux__
+    std::string dir(kNodeDir);
+    for (int node : parse_list(read_line(dir + "/online"))) {
+      std::vector<int> cpus = parse_list(read_line(
+          dir + "/node" + std::to_string(node) + "/cpulist"));
+      if (!cpus.empty()) {
+        nodes.push_back(node);
+        cpus_of[node] = cpus;
+      }
+    }
+#endif
+    if (nodes.empty()) {
+      nodes.push_back(0);
+    }
+  }
+
+  std::vector<int> nodes;
+  std::map<int, std::vector<int>> cpus_of;
+};
+
+const Topology& topology() {
+  static Topology topology;
+  return topology;
+}
+
+}  // namespace
+
+thread_local int Numa::pinned_node_ = -1;
+
+const std::vector<int>& Numa::nodes() {
+  return topology().nodes;
+}
+
+const std::vector<int>& Numa::node_cpus(int node) {
+  static const std::vector<int> none;
+  auto it = topology().cpus_of.find(node);
+  return it == topology().cpus_of.end() ? none : it->second;
+}
+
+bool Numa::pin_thread(int node) {
+#ifdef __linux__
+  const std::vector<int>& cpus = node_cpus(node);
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &mask);
+    }
+  }
+  if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+    LOG_E("Numa: could not pin thread to node %d\n", node);
+    return false;
+  }
+  pinned_node_ = node;
+  return true;
+#else
+  return false;
+#endif
+}
+
+int Numa::pinned_node() {
+  return pinned_node_;
+}
+
+bool Numa::prefer_node(int node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  if (node < 0) {
+    return syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0) == 0;
+  }
+  if (node_cpus(node).empty()) {
+    return false;
+  }
+  const int bits = 8 * sizeof(unsigned long);
+  std::vector<unsigned long> mask(node / bits + 1, 0);
+  mask[node / bits] |= 1UL << (node % bits);
+  // maxnode counts one past the last bit the kernel reads.
+  if (syscall(SYS_set_mempolicy, kMpolPreferred, mask.data(),
+              mask.size() * bits + 1) != 0) {
+    LOG_E("Numa: could not set memory policy to node %d\n", node);
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,127 @@
+#include "ReplicaSelector.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#include "Metrics.h"
+
+constexpr double ReplicaSelector::kEwmaAlpha;
+constexpr double ReplicaSelector::kEwmaHalfLifeNs;
+
+ReplicaSelector::ReplicaSelector(int32_t num_hosts, Policy policy)
+    : num_hosts_(num_hosts),
+      policy_(policy),
+      loads_(allocate_loads(num_hosts)) {
+  assert(num_hosts_ > 0 && "num_hosts <= 0");
+  for (int32_t host = 0; host < num_hosts_; ++host) {
+    loads_[host].outstanding.store(0, std::memory_order_relaxed);
+    loads_[host].ewma_ns.store(0, std::memory_order_relaxed);
+    loads_[host].last_ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+ReplicaSelector::HostLoad* ReplicaSelector::allocate_loads(int32_t num_hosts) {
+  void* memory = nullptr;
+  if (posix_memalign(&memory, alignof(HostLoad),
+                     num_hosts * sizeof(HostLoad)) != 0) {
+    throw std::bad_alloc();
+  }
+  HostLoad* loads = static_cast<HostLoad*>(memory);
+  for (int32_t host = 0; host < num_hosts; ++host) {
+    new (&loads[host]) HostLoad;
+  }
+  return loads;
+}
+
+void ReplicaSelector::FreeLoads::operator()(HostLoad* loads) const {
+  free(loads);
+}
+
+bool ReplicaSelector::parse_policy(const std::string& name, Policy* policy) {
+  if (name == "outstanding") {
+    *policy = Policy::OUTSTANDING;
+  } else if (name == "latency") {
+    *policy = Policy::LATENCY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+double ReplicaSelector::score(int32_t host, uint64_t now_ns) const {
+  double in_flight = outstanding(host);
+  if (policy_ == Policy::OUTSTANDING) {
+    return in_flight;
+  }
+  uint64_t last_ns = loads_[host].last_ns.load(std::memory_order_relaxed);
+  double idle_ns = now_ns > last_ns ? now_ns - last_ns : 0;
+  return latency_ewma_ns(host) * std::exp2(-idle_ns / kEwmaHalfLifeNs)
+      * (in_flight + 1);
+}
+
+int32_t ReplicaSelector::pick(const std::vector<int32_t>& hosts,
+                              int32_t preferred) const {
+  assert(!hosts.empty() && "no hosts to pick from");
+  if (hosts.size() == 1) {
+    return hosts[0];
+  }
+
+  uint64_t now_ns = policy_ == Policy::LATENCY ? Metrics::now_ns() : 0;
+  int32_t best = hosts[0];
+  double best_score = score(best, now_ns);
+  for (size_t i = 1; i < hosts.size(); ++i) {
+    double host_score = score(hosts[i], now_ns);
+    if (host_score < best_score
+        || (host_score == best_score && hosts[i] == preferred)) {
+      best = hosts[i];
+      best_score = host_score;
+    }
+  }
+  return best;
+}
+
+void ReplicaSelector::end(int32_t host, uint64_t latency_ns,
+                          uint64_t now_ns) {
+  HostLoad& load = loads_[host];
+  load.outstanding.fetch_sub(1, std::memory_order_relaxed);
+
+  // The average decayed while no reads completed, as score() saw it.
+  uint64_t last_ns = load.last_ns.exchange(now_ns, std::memory_order_relaxed);
+  double idle_ns = now_ns > last_ns ? now_ns - last_ns : 0;
+  double decay = std::exp2(-idle_ns / kEwmaHalfLifeNs);
+
+  // Racing updates may each start from the same average; retry, so that
+  // every sample is folded in.
+  uint64_t ewma = load.ewma_ns.load(std::memory_order_relaxed);
+  uint64_t updated;
+  do {
+    double decayed = ewma * decay;
+    updated = ewma == 0 ? latency_ns
+        : static_cast<uint64_t>(decayed + kEwmaAlpha * (latency_ns - decayed));
+  } while (!load.ewma_ns.compare_exchange_weak(ewma, updated,
+                                               std::memory_order_relaxed));
+}
+
+ReplicaSelector::Call::Call(ReplicaSelector* selector, int32_t host)
+    : selector_(selector),
+      host_(host),
+      start_ns_(Metrics::now_ns()) {
+  selector_->loads_[host_].outstanding.fetch_add(1,
+                                                 std::memory_order_relaxed);
+}
+
+ReplicaSelector::Call::Call(Call&& other)
+    : selector_(other.selector_),
+      host_(other.host_),
+      start_ns_(other.start_ns_) {
+  other.selector_ = nullptr;
+}
+
+ReplicaSelector::Call::~Call() {
+  if (selector_ != nullptr) {
+    uint64_t now_ns = Metrics::now_ns();
+    selector_->end(host_, now_ns - start_ns_, now_ns);
+  }
+}
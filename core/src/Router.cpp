@@ -0,0 +1,278 @@
+#include "Router.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include "ShardMap.h"
+#include "utils.h"
+
+namespace {
+
+// FNV-1a, then a final mix: every aggregator has to place the ring points
+// identically, so std::hash, which is up to the library, will not do.
+uint64_t hash_string(const std::string& s) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (char c : s) {
+    h = (h ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+bool write_line(const std::string& path, const std::string& line) {
+  std::ofstream out(path);
+  out << line << "\n";
+  out.close();
+  if (!out) {
+    LOG_E("Could not write shard router to %s\n", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+ShardRouter::ShardRouter(int32_t num_shards)
+    : num_shards_(num_shards) {
+  assert(num_shards_ > 0 && "num_shards <= 0");
+}
+
+std::unique_ptr<ShardRouter> ShardRouter::load(const std::string& path,
+                                               int32_t num_shards) {
+  std::ifstream in(path);
+  std::string kind;
+  int32_t saved_num_shards;
+  if (!(in >> kind >> saved_num_shards)) {
+    LOG_E("Could not read shard router from %s\n", path.c_str());
+    return nullptr;
+  }
+  if (saved_num_shards != num_shards) {
+    LOG_E("Shard router %s is for %d shards, not %d\n", path.c_str(),
+          saved_num_shards, num_shards);
+    return nullptr;
+  }
+
+  if (kind == "modulo") {
+    return std::unique_ptr<ShardRouter>(new ModuloShardRouter(num_shards));
+  }
+  if (kind == "range") {
+    int64_t num_nodes;
+    if (in >> num_nodes) {
+      return std::unique_ptr<ShardRouter>(
+          new RangeShardRouter(num_shards, num_nodes));
+    }
+  } else if (kind == "shardmap") {
+    in.close();
+    std::unique_ptr<ShardMap> shard_map(new ShardMap(num_shards));
+    if (shard_map->load(path)) {
+      return std::move(shard_map);
+    }
+    return nullptr;
+  }
+  LOG_E("Shard router %s is corrupt\n", path.c_str());
+  return nullptr;
+}
+
+bool ModuloShardRouter::save(const std::string& path) const {
+  return write_line(path, "modulo " + std::to_string(num_shards_));
+}
+
+RangeShardRouter::RangeShardRouter(int32_t num_shards, int64_t num_nodes)
+    : ShardRouter(num_shards),
+      num_nodes_(num_nodes),
+      range_size_(num_nodes / num_shards),
+      num_longer_(num_nodes % num_shards) {
+}
+
+int32_t RangeShardRouter::shard_of(int64_t node) const {
+  // The first num_longer_ ranges hold range_size_ + 1 nodes.
+  int64_t longer_end = num_longer_ * (range_size_ + 1);
+  int64_t shard;
+  if (node < longer_end) {
+    shard = node / (range_size_ + 1);
+  } else if (range_size_ == 0) {
+    shard = num_shards_ - 1;
+  } else {
+    shard = num_longer_ + (node - longer_end) / range_size_;
+  }
+  return std::min<int64_t>(shard, num_shards_ - 1);
+}
+
+int64_t RangeShardRouter::range_start(int32_t shard) const {
+  return shard * range_size_ + std::min(shard, num_longer_);
+}
+
+bool RangeShardRouter::save(const std::string& path) const {
+  return write_line(
+      path, "range " + std::to_string(num_shards_) + " "
+          + std::to_string(num_nodes_));
+}
+
+HostRouter::HostRouter(int32_t num_shards, int32_t num_hosts)
+    : num_shards_(num_shards),
+      num_hosts_(num_hosts) {
+  assert(num_hosts_ > 0 && "num_hosts <= 0");
+}
+
+std::vector<int32_t> HostRouter::hosts_of(int32_t shard) const {
+  int32_t primary = host_of(shard);
+  std::vector<int32_t> hosts(replication(shard));
+  for (size_t i = 0; i < hosts.size(); ++i) {
+    hosts[i] = (primary + i) % num_hosts_;
+  }
+  return hosts;
+}
+
+std::vector<int32_t> HostRouter::shards_of(int32_t host) const {
+  std::vector<int32_t> shards;
+  for (int32_t shard = 0; shard < num_shards_; ++shard) {
+    // Copies are on consecutive hosts from the primary, wrapping around.
+    int32_t distance = (host - host_of(shard) + num_hosts_) % num_hosts_;
+    if (distance < replication(shard)) {
+      shards.push_back(shard);
+    }
+  }
+  return shards;
+}
+
+void HostRouter::set_replication(int32_t shard, int32_t copies) {
+  assert(shard >= 0 && shard < num_shards_ && "shard out of range");
+  assert(copies >= 1 && copies <= num_hosts_ && "copies out of range");
+  if (replication_.empty()) {
+    replication_.assign(num_shards_, 1);
+  }
+  replication_[shard] = copies;
+}
+
+bool HostRouter::load_replication(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    LOG_E("Could not read replication file %s\n", path.c_str());
+    return false;
+  }
+  std::vector<std::pair<int32_t, int32_t>> copies;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    int32_t shard, num_copies;
+    if (!(fields >> shard >> num_copies)) {
+      LOG_E("Replication file %s is corrupt: '%s'\n", path.c_str(),
+            line.c_str());
+      return false;
+    }
+    if (shard < 0 || shard >= num_shards_ || num_copies < 1
+        || num_copies > num_hosts_) {
+      LOG_E("Replication file %s asks for %d copies of shard %d, "
+            "with %d shards on %d hosts\n", path.c_str(), num_copies, shard,
+            num_shards_, num_hosts_);
+      return false;
+    }
+    copies.push_back(std::make_pair(shard, num_copies));
+  }
+  for (const auto& shard_copies : copies) {
+    set_replication(shard_copies.first, shard_copies.second);
+  }
+  return true;
+}
+
+std::unique_ptr<HostRouter> HostRouter::create(
+    const std::string& spec, int32_t num_shards,
+    const std::vector<std::string>& hostnames) {
+  int32_t num_hosts = hostnames.size();
+  std::string kind = spec.substr(0, spec.find(':'));
+  std::string arg = kind.size() < spec.size() ? spec.substr(kind.size() + 1)
+      : "";
+
+  if (kind == "modulo" || kind.empty()) {
+    return std::unique_ptr<HostRouter>(
+        new ModuloHostRouter(num_shards, num_hosts));
+  }
+  if (kind == "range") {
+    return std::unique_ptr<HostRouter>(
+        new RangeHostRouter(num_shards, num_hosts));
+  }
+  if (kind == "consistent") {
+    int32_t points = arg.empty() ?
+        ConsistentHashHostRouter::kDefaultPointsPerHost : atoi(arg.c_str());
+    if (points > 0) {
+      return std::unique_ptr<HostRouter>(
+          new ConsistentHashHostRouter(num_shards, hostnames, points));
+    }
+  } else if (kind == "table") {
+    std::unique_ptr<TableHostRouter> router(
+        new TableHostRouter(num_shards, num_hosts));
+    if (router->load(arg)) {
+      return std::move(router);
+    }
+    return nullptr;
+  }
+  LOG_E("Unknown host routing '%s'\n", spec.c_str());
+  return nullptr;
+}
+
+TableHostRouter::TableHostRouter(int32_t num_shards, int32_t num_hosts)
+    : HostRouter(num_shards, num_hosts),
+      hosts_(num_shards) {
+  for (int32_t shard = 0; shard < num_shards; ++shard) {
+    hosts_[shard] = shard % num_hosts;
+  }
+}
+
+bool TableHostRouter::load(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    LOG_E("Could not read host table %s\n", path.c_str());
+    return false;
+  }
+  std::vector<int32_t> hosts(hosts_);
+  int32_t shard, host;
+  while (in >> shard >> host) {
+    if (shard < 0 || shard >= num_shards_ || host < 0 || host >= num_hosts_) {
+      LOG_E("Host table %s moves shard %d to host %d, which does not exist\n",
+            path.c_str(), shard, host);
+      return false;
+    }
+    hosts[shard] = host;
+  }
+  if (!in.eof()) {
+    LOG_E("Host table %s is corrupt\n", path.c_str());
+    return false;
+  }
+  hosts_.swap(hosts);
+  return true;
+}
+
+const int32_t ConsistentHashHostRouter::kDefaultPointsPerHost;
+
+ConsistentHashHostRouter::ConsistentHashHostRouter(
+    int32_t num_shards, const std::vector<std::string>& hostnames,
+    int32_t points_per_host)
+    : HostRouter(num_shards, hostnames.size()),
+      hosts_(num_shards) {
+  // (point, host) pairs, sorted around the ring.
+  std::vector<std::pair<uint64_t, int32_t>> ring;
+  ring.reserve(num_hosts_ * points_per_host);
+  for (int32_t host = 0; host < num_hosts_; ++host) {
+    for (int32_t i = 0; i < points_per_host; ++i) {
+      ring.push_back(std::make_pair(
+          hash_string(hostnames[host] + "#" + std::to_string(i)), host));
+    }
+  }
+  std::sort(ring.begin(), ring.end());
+
+  for (int32_t shard = 0; shard < num_shards; ++shard) {
+    std::pair<uint64_t, int32_t> key(
+        hash_string("shard-" + std::to_string(shard)), -1);
+    auto it = std::lower_bound(ring.begin(), ring.end(), key);
+    hosts_[shard] = (it == ring.end() ? ring.front() : *it).second;
+  }
+}
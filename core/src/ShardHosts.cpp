@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "Router.h"
+
+// Prints "<shard id> <host id> <hostname>" for every copy of every shard,
+// primary first, as the aggregators route them, so that scripts can place
+// the shard files.
+int main(int argc, char** argv) {
+  int c;
+  int num_shards = 1;
+  std::string hostsfile, host_routing("modulo"), replication_file;
+  while ((c = getopt(argc, argv, "n:h:R:P:")) != -1) {
+    switch (c) {
+      case 'n': {
+        num_shards = std::stoi(optarg);
+        break;
+      }
+      case 'h': {
+        hostsfile = optarg;
+        break;
+      }
+      case 'R': {
+        host_routing = optarg;
+        break;
+      }
+      case 'P': {
+        replication_file = optarg;
+        break;
+      }
+      default: {
+        fprintf(stderr, "Usage: %s [-n nshards] -h hostsfile "
+                "[-R host_routing] [-P replication_file]\n", argv[0]);
+        return -1;
+      }
+    }
+  }
+
+  std::ifstream hosts(hostsfile);
+  std::string host;
+  std::vector<std::string> hostnames;
+  while (std::getline(hosts, host)) {
+    hostnames.push_back(host);
+  }
+  if (hostnames.empty()) {
+    fprintf(stderr, "No hosts in '%s'\n", hostsfile.c_str());
+    return -1;
+  }
+
+  std::unique_ptr<HostRouter> router = HostRouter::create(host_routing,
+                                                          num_shards,
+                                                          hostnames);
+  if (router == nullptr) {
+    return -1;
+  }
+  if (!replication_file.empty()
+      && !router->load_replication(replication_file)) {
+    return -1;
+  }
+  for (int shard = 0; shard < num_shards; ++shard) {
+    for (int host_id : router->hosts_of(shard)) {
+      printf("%d %d %s\n", shard, host_id, hostnames[host_id].c_str());
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,108 @@
+#include "ShardMap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+#include "utils.h"
+
+namespace {
+
+template<typename Entry>
+bool node_less(const Entry& entry, int64_t node) {
+  return entry.node < node;
+}
+
+template<typename Entry>
+bool slot_less(const Entry& lhs, const Entry& rhs) {
+  return lhs.shard < rhs.shard
+      || (lhs.shard == rhs.shard && lhs.local_key < rhs.local_key);
+}
+
+}  // namespace
+
+const ShardMap::Entry* ShardMap::find_node(int64_t node) const {
+  std::vector<Entry>::const_iterator it = std::lower_bound(
+      by_node_.begin(), by_node_.end(), node, node_less<Entry>);
+  return it != by_node_.end() && it->node == node ? &*it : nullptr;
+}
+
+int64_t ShardMap::global_key(int32_t shard, int64_t local_key) const {
+  if (!by_slot_.empty()) {
+    Entry slot = { 0, shard, local_key };
+    std::vector<Entry>::const_iterator it = std::lower_bound(
+        by_slot_.begin(), by_slot_.end(), slot, slot_less<Entry>);
+    if (it != by_slot_.end() && it->shard == shard
+        && it->local_key == local_key) {
+      return it->node;
+    }
+  }
+  return local_key * num_shards_ + shard;
+}
+
+void ShardMap::move(int64_t node, int32_t shard, int64_t local_key) {
+  assert(shard >= 0 && shard < num_shards_ && "shard out of range");
+  Entry entry = { node, shard, local_key };
+
+  std::vector<Entry>::iterator it = std::lower_bound(
+      by_node_.begin(), by_node_.end(), node, node_less<Entry>);
+  if (it != by_node_.end() && it->node == node) {
+    Entry old_slot = *it;
+    by_slot_.erase(std::lower_bound(by_slot_.begin(), by_slot_.end(),
+                                    old_slot, slot_less<Entry>));
+    *it = entry;
+  } else {
+    by_node_.insert(it, entry);
+  }
+  by_slot_.insert(std::upper_bound(by_slot_.begin(), by_slot_.end(), entry,
+                                   slot_less<Entry>),
+                  entry);
+}
+
+bool ShardMap::save(const std::string& path) const {
+  std::ofstream out(path);
+  out << "shardmap " << num_shards_ << " " << by_node_.size() << "\n";
+  for (const Entry& entry : by_node_) {
+    out << entry.node << " " << entry.shard << " " << entry.local_key << "\n";
+  }
+  out.close();
+  if (!out) {
+    LOG_E("Could not write shard map to %s\n", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ShardMap::load(const std::string& path) {
+  std::ifstream in(path);
+  std::string magic;
+  int32_t num_shards;
+  size_t num_moved;
+  if (!(in >> magic >> num_shards >> num_moved) || magic != "shardmap") {
+    LOG_E("Could not read shard map from %s\n", path.c_str());
+    return false;
+  }
+  if (num_shards != num_shards_) {
+    LOG_E("Shard map %s is for %d shards, not %d\n", path.c_str(),
+          num_shards, num_shards_);
+    return false;
+  }
+
+  std::vector<Entry> entries(num_moved);
+  for (Entry& entry : entries) {
+    if (!(in >> entry.node >> entry.shard >> entry.local_key)
+        || entry.shard < 0 || entry.shard >= num_shards_) {
+      LOG_E("Shard map %s is truncated or corrupt\n", path.c_str());
+      return false;
+    }
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& lhs, const Entry& rhs) {
+              return lhs.node < rhs.node;
+            });
+  by_node_ = entries;
+  std::sort(entries.begin(), entries.end(), slot_less<Entry>);
+  by_slot_.swap(entries);
+  return true;
+}
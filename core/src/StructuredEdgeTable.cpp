@@ -3,10 +3,180 @@
 #include "GraphFormatter.hpp"
 #include "utils.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 
 constexpr char SERDE_DELIM = '\x02';
 
+namespace {
+
+// A snapshot is the magic, the number of edge lists, and for each list its
+// (src, atype), its size n, and its columns: n times, n destinations, n
+// attribute ends, and the attributes.
+const uint64_t kSnapshotMagic = 0x32504e5345474445ULL;  // "EDGESNP2"
+
+template<typename T>
+void write_pod(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool read_pod(std::istream& in, T& value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value),
+                                   sizeof(T)));
+}
+
+template<typename T>
+void write_column(std::ostream& out, const std::vector<T>& column) {
+  out.write(reinterpret_cast<const char*>(column.data()),
+            column.size() * sizeof(T));
+}
+
+template<typename T>
+bool read_column(std::istream& in, std::vector<T>& column, uint64_t size) {
+  column.resize(size);
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(column.data()),
+                                   size * sizeof(T)));
+}
+
+}  // namespace
+
+void StructuredEdgeTable::EdgeList::add(int64_t dst, int64_t time,
+                                        const std::string& attr) {
+  size_t i = times_.size();
+  if (i > 0 && times_.back() > time) {
+    i = upper_bound(time);
+  }
+  uint64_t attr_begin = i == 0 ? 0 : attr_ends_[i - 1];
+  times_.insert(times_.begin() + i, time);
+  dsts_.insert(dsts_.begin() + i, dst);
+  attr_ends_.insert(attr_ends_.begin() + i, attr_begin + attr.length());
+  attrs_.insert(attr_begin, attr);
+  for (size_t j = i + 1; j < attr_ends_.size(); j++) {
+    attr_ends_[j] += attr.length();
+  }
+
+  if (i + 1 == times_.size() && !dst_slots_.empty()) {
+    index_dst(i);
+  } else if (times_.size() >= kDstIndexMinSize) {
+    build_dst_index();
+  }
+}
+
+void StructuredEdgeTable::EdgeList::erase(std::vector<size_t>& edges) {
+  if (edges.empty()) {
+    return;
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  // Moves the kept edges after the first erased one down over the gaps, in
+  // one pass; attr_begin is where edge i's attribute began before the move.
+  size_t out = edges.front();
+  uint64_t attr_begin = out == 0 ? 0 : attr_ends_[out - 1];
+  uint64_t attr_out = attr_begin;
+  std::vector<size_t>::const_iterator next = edges.begin();
+  for (size_t i = out; i < times_.size(); i++) {
+    uint64_t attr_end = attr_ends_[i];
+    if (next != edges.end() && *next == i) {
+      ++next;
+    } else {
+      std::copy(attrs_.begin() + attr_begin, attrs_.begin() + attr_end,
+                attrs_.begin() + attr_out);
+      attr_out += attr_end - attr_begin;
+      times_[out] = times_[i];
+      dsts_[out] = dsts_[i];
+      attr_ends_[out] = attr_out;
+      out++;
+    }
+    attr_begin = attr_end;
+  }
+  times_.resize(out);
+  dsts_.resize(out);
+  attr_ends_.resize(out);
+  attrs_.resize(attr_out);
+  build_dst_index();
+}
+
+void StructuredEdgeTable::EdgeList::index_dst(size_t i) {
+  if (2 * (i + 1) > dst_slots_.size()) {
+    build_dst_index();
+    return;
+  }
+  uint64_t mask = dst_slots_.size() - 1;
+  uint64_t slot = hash_dst(dsts_[i]) & mask;
+  while (dst_slots_[slot] != 0) {
+    slot = (slot + 1) & mask;
+  }
+  dst_slots_[slot] = i + 1;
+}
+
+void StructuredEdgeTable::EdgeList::build_dst_index() {
+  if (times_.size() < kDstIndexMinSize) {
+    std::vector<uint32_t>().swap(dst_slots_);
+    return;
+  }
+  // Room to double before the next rebuild.
+  uint64_t num_slots = 2;
+  while (num_slots < 4 * times_.size()) {
+    num_slots <<= 1;
+  }
+  dst_slots_.assign(num_slots, 0);
+  for (size_t i = 0; i < times_.size(); i++) {
+    index_dst(i);
+  }
+}
+
+void StructuredEdgeTable::EdgeList::find_dst(std::vector<size_t>& found,
+                                             int64_t dst) const {
+  if (dst_slots_.empty()) {
+    for (size_t i = 0; i < dsts_.size(); i++) {
+      if (dsts_[i] == dst) {
+        found.push_back(i);
+      }
+    }
+    return;
+  }
+  uint64_t mask = dst_slots_.size() - 1;
+  for (uint64_t slot = hash_dst(dst) & mask; dst_slots_[slot] != 0;
+      slot = (slot + 1) & mask) {
+    if (dsts_[dst_slots_[slot] - 1] == dst) {
+      found.push_back(dst_slots_[slot] - 1);
+    }
+  }
+}
+
+void StructuredEdgeTable::EdgeList::save(std::ostream& out) const {
+  write_pod(out, static_cast<uint64_t>(size()));
+  write_column(out, times_);
+  write_column(out, dsts_);
+  write_column(out, attr_ends_);
+  out.write(attrs_.data(), attrs_.length());
+}
+
+bool StructuredEdgeTable::EdgeList::load(std::istream& in,
+                                         uint64_t max_bytes) {
+  // A size or attribute length beyond the bytes left is corrupt, and is not
+  // allocated.
+  uint64_t size;
+  if (!read_pod(in, size) || size > max_bytes / kColumnBytes
+      || !read_column(in, times_, size) || !read_column(in, dsts_, size)
+      || !read_column(in, attr_ends_, size)
+      || !std::is_sorted(times_.begin(), times_.end())
+      || !std::is_sorted(attr_ends_.begin(), attr_ends_.end())
+      || (size > 0 && attr_ends_.back() > max_bytes - size * kColumnBytes)) {
+    return false;
+  }
+  attrs_.resize(size == 0 ? 0 : attr_ends_.back());
+  build_dst_index();
+  return static_cast<bool>(in.read(&attrs_[0], attrs_.length()));
+}
+
 void StructuredEdgeTable::construct() {
   // Do nothing
 }
@@ -15,13 +185,88 @@ void StructuredEdgeTable::load() {
   // Do nothing
 }
 
+bool StructuredEdgeTable::save(const std::string& path) {
+  std::string tmp_path = path + ".tmp";
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    LOG_E("StructuredEdgeTable: could not create %s\n", tmp_path.c_str());
+    return false;
+  }
+  {
+    boost::shared_lock<boost::shared_mutex> lk(mutex_);
+    write_pod(out, kSnapshotMagic);
+    write_pod(out, static_cast<uint64_t>(edges.size()));
+    for (const auto& list : edges) {
+      write_pod(out, list.first.first);
+      write_pod(out, list.first.second);
+      list.second.save(out);
+    }
+  }
+  out.close();
+
+  // Durable before it replaces the previous snapshot.
+  int fd = open(tmp_path.c_str(), O_WRONLY);
+  bool ok = !out.fail() && fd != -1 && fsync(fd) == 0;
+  if (fd != -1) {
+    close(fd);
+  }
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG_E("StructuredEdgeTable: could not write snapshot %s\n", path.c_str());
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool StructuredEdgeTable::load(const std::string& path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    return false;
+  }
+  uint64_t file_size = in.tellg();
+  in.seekg(0);
+  uint64_t magic, num_lists;
+  if (!read_pod(in, magic) || magic != kSnapshotMagic
+      || !read_pod(in, num_lists)) {
+    return false;
+  }
+
+  // Read into a table of our own, so that a corrupt snapshot leaves this one
+  // as it was.  Each list takes at least its (src, atype) and size.
+  const uint64_t kListBytes = 3 * sizeof(int64_t);
+  std::unordered_map<EdgeRecordId, EdgeList, pairhash> loaded;
+  int64_t loaded_edges = 0;
+  bool ok = num_lists <= file_size / kListBytes;
+  if (ok) {
+    loaded.reserve(num_lists);
+  }
+  for (uint64_t i = 0; ok && i < num_lists; i++) {
+    int64_t src, atype;
+    ok = read_pod(in, src) && read_pod(in, atype);
+    if (ok) {
+      EdgeList& list = loaded[std::make_pair(src, atype)];
+      ok = list.empty()
+          && list.load(in, file_size - static_cast<uint64_t>(in.tellg()));
+      loaded_edges += list.size();
+    }
+  }
+  if (!ok) {
+    LOG_E("StructuredEdgeTable: snapshot %s is corrupt\n", path.c_str());
+    return false;
+  }
+
+  boost::unique_lock<boost::shared_mutex> lk(mutex_);
+  edges.swap(loaded);
+  num_edges_ = loaded_edges;
+  return true;
+}
+
 void StructuredEdgeTable::add_assoc(int64_t src, int64_t dst, int64_t atype,
                                     int64_t timestamp,
                                     const std::string& attr) {
   boost::unique_lock<boost::shared_mutex> lock(mutex_);
 
-  edges[std::make_pair(src, atype)].insert(EdgeData { src, dst, atype,
-      timestamp, attr });
+  edges[std::make_pair(src, atype)].add(dst, timestamp, attr);
   ++num_edges_;
 }
 
@@ -30,11 +275,21 @@ std::vector<SuccinctGraph::Assoc> StructuredEdgeTable::assoc_range(
   COND_LOG_E("GraphLogStore assoc_range(src = %lld, atype = %lld, off = %d, len = %d)\n",
       src, atype, off, len);
 
-  assert(false && "Should not be here.");
-  return std::vector<SuccinctGraph::Assoc>();
+  std::vector<SuccinctGraph::Assoc> result;
+  boost::shared_lock<boost::shared_mutex> lk(mutex_);
+  const EdgeList* list = find_list(src, atype);
+  if (list == nullptr) {
+    return result;
+  }
+  // Newest first: edge `off` is the off-th from the end.
+  int64_t hi = static_cast<int64_t>(list->size()) - std::max(off, 0);
+  int64_t lo = len < 0 ? 0 : std::max<int64_t>(hi - len, 0);
+  for (int64_t i = hi - 1; i >= lo; i--) {
+    result.push_back(list->link(src, atype, i));
+  }
+  return result;
 }
 
-// FIXME: scan for now...
 std::vector<SuccinctGraph::Assoc> StructuredEdgeTable::assoc_get(
     int64_t src, int64_t atype, const std::set<int64_t>& dst_id_set,
     int64_t t_low, int64_t t_high) {
@@ -42,26 +297,72 @@ std::vector<SuccinctGraph::Assoc> StructuredEdgeTable::assoc_get(
       " dstIdSet = ..., tLow = %" PRId64 ", tHigh = %" PRId64 ")\n",
       src, atype, t_low, t_high);
 
-  assert(false && "Should not be here.");
-  return std::vector<SuccinctGraph::Assoc>();
+  std::vector<SuccinctGraph::Assoc> result;
+  boost::shared_lock<boost::shared_mutex> lk(mutex_);
+  const EdgeList* list = find_list(src, atype);
+  if (list == nullptr) {
+    return result;
+  }
+  size_t hi = t_high == -1 ? list->size() : list->upper_bound(t_high);
+  size_t lo = t_low == -1 ? 0 : list->lower_bound(t_low);
+  if (lo >= hi) {
+    return result;
+  }
+  std::vector<size_t> found;
+  if (dst_id_set.size() < hi - lo) {
+    // Look the destinations up, rather than scan the time range.
+    for (int64_t dst : dst_id_set) {
+      list->find_dst(found, dst);
+    }
+    std::sort(found.begin(), found.end(), std::greater<size_t>());
+  } else {
+    for (size_t i = hi; i-- > lo;) {
+      if (dst_id_set.count(list->dst(i))) {
+        found.push_back(i);
+      }
+    }
+  }
+  for (size_t i : found) {
+    if (i >= lo && i < hi) {
+      result.push_back(list->link(src, atype, i));
+    }
+  }
+  return result;
 }
 
-// FIXME: scan for now...
 std::vector<SuccinctGraph::Assoc> StructuredEdgeTable::assoc_time_range(
     int64_t src, int64_t atype, int64_t t_low, int64_t t_high, int32_t len) {
   COND_LOG_E("GraphLogStore assoc_time_range(src = %lld, atype = %lld, tLow = %lld, "
       "tHigh = %lld, len = %d)\n",
       src, atype, t_low, t_high, len);
 
-  assert(false && "Should not be here.");
-  return std::vector<SuccinctGraph::Assoc>();
+  std::vector<SuccinctGraph::Assoc> result;
+  boost::shared_lock<boost::shared_mutex> lk(mutex_);
+  const EdgeList* list = find_list(src, atype);
+  if (list == nullptr) {
+    return result;
+  }
+  int64_t hi = t_high == -1 ? list->size() : list->upper_bound(t_high);
+  int64_t lo = t_low == -1 ? 0 : list->lower_bound(t_low);
+  if (len >= 0) {
+    lo = std::max<int64_t>(lo, hi - len);
+  }
+  for (int64_t i = hi - 1; i >= lo; i--) {
+    result.push_back(list->link(src, atype, i));
+  }
+  return result;
 }
 
 void StructuredEdgeTable::build_backfill_edge_updates(
     std::unordered_map<int, GraphFormatter::AssocSet>& edge_updates,
-    int num_shards_to_mod) {
-
-  LOG_E("StructuredEdgeTable::build_backfill_edge_updates: %d shards\n",
+    const ShardRouter& router) {
+  boost::shared_lock<boost::shared_mutex> lk(mutex_);
+  for (const auto& entry : edges) {
+    if (!entry.second.empty()) {
+      edge_updates[router.shard_of(entry.first.first)].insert(entry.first);
+    }
+  }
+  LOG_E("StructuredEdgeTable::build_backfill_edge_updates: %zu shards\n",
         edge_updates.size());
 }
 
@@ -69,20 +370,26 @@ void StructuredEdgeTable::build_backfill_edge_updates(
 bool StructuredEdgeTable::getLink(Link& link, int64_t id1, int64_t link_type,
                                   int64_t id2) {
   boost::shared_lock<boost::shared_mutex> lk(mutex_);
-  for (EdgeData edge_data : edges[std::make_pair(id1, link_type)]) {
-    if (edge_data.dst_id == id2) {
-      link = edge_data;
-      return true;
-    }
+  const EdgeList* list = find_list(id1, link_type);
+  if (list == nullptr) {
+    return false;
+  }
+  std::vector<size_t> found;
+  list->find_dst(found, id2);
+  if (found.empty()) {
+    return false;
   }
-  return false;
+  link = list->link(id1, link_type,
+                    *std::min_element(found.begin(), found.end()));
+  return true;
 }
 
 void StructuredEdgeTable::getLinkList(std::vector<Link>& assocs, int64_t id1,
                                       int64_t link_type) {
   boost::shared_lock<boost::shared_mutex> lk(mutex_);
-  for (EdgeData edge_data : edges[std::make_pair(id1, link_type)]) {
-    assocs.push_back(edge_data);
+  const EdgeList* list = find_list(id1, link_type);
+  for (size_t i = list == nullptr ? 0 : list->size(); i-- > 0;) {
+    assocs.push_back(list->link(id1, link_type, i));
   }
 }
 
@@ -94,42 +401,32 @@ void StructuredEdgeTable::getLinkList(std::vector<Link>& assocs, int64_t id1,
   if (min_timestamp > max_timestamp)
     return;
 
-  EdgeData min, max;
-  min.src_id = max.src_id = id1;
-  min.atype = max.atype = link_type;
-  min.time = min_timestamp;
-  max.time = max_timestamp;
-  EdgeDataSet edge_set;
-  {
-    boost::shared_lock<boost::shared_mutex> lk(mutex_);
-    edge_set = edges[std::make_pair(id1, link_type)];
-  }
-  EdgeDataSet::iterator begin = edge_set.lower_bound(min);
-  EdgeDataSet::iterator end = edge_set.upper_bound(max);
-
-  EdgeDataSet::iterator it = begin;
-  while (offset-- && it != end) {
-    it++;
+  boost::shared_lock<boost::shared_mutex> lk(mutex_);
+  const EdgeList* list = find_list(id1, link_type);
+  if (list == nullptr) {
+    return;
   }
-
-  for (; it != end && assocs.size() <= limit; it++) {
-    if (it->time > max_timestamp)
-      break;
-    assocs.push_back(*it);
+  // Seek to the newest link at or before max_timestamp, skip `offset` links
+  // and read backwards.
+  int64_t lo = list->lower_bound(min_timestamp);
+  int64_t hi = list->upper_bound(max_timestamp) - std::max<int64_t>(offset, 0);
+  for (int64_t i = hi - 1;
+      i >= lo && static_cast<int64_t>(assocs.size()) < limit; i--) {
+    assocs.push_back(list->link(id1, link_type, i));
   }
 }
 
 bool StructuredEdgeTable::deleteLink(int64_t id1, int64_t link_type,
                                      int64_t id2) {
-  boost::shared_lock<boost::shared_mutex> lk(mutex_);
-  EdgeDataSet::iterator it = edges[std::make_pair(id1, link_type)].begin();
-  bool deleted = false;
-  while (it != edges[std::make_pair(id1, link_type)].end()) {
-    EdgeDataSet::iterator current = it++;
-    if (current->dst_id == id2) {
-      edges[std::make_pair(id1, link_type)].erase(current);
-      deleted = true;
-    }
+  boost::unique_lock<boost::shared_mutex> lk(mutex_);
+  std::unordered_map<EdgeRecordId, EdgeList, pairhash>::iterator it =
+      edges.find(std::make_pair(id1, link_type));
+  if (it == edges.end()) {
+    return false;
   }
-  return deleted;
+  std::vector<size_t> found;
+  it->second.find_dst(found, id2);
+  num_edges_ -= found.size();
+  it->second.erase(found);
+  return !found.empty();
 }
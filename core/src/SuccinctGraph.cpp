@@ -1,11 +1,16 @@
 #include "SuccinctGraph.hpp"
 
+#include <sys/stat.h>
+
 #include <limits>
 #include <sstream>
 #include <thread>
 
 #include "GraphFormatter.hpp"
+#include "Metrics.h"
 #include "SuccinctGraphSerde.hpp"
+#include "Trace.h"
+#include "npa/npa.h"
 #include "utils.h"
 
 // Controls whether we keep the unstructured input edge table in memory.
@@ -24,6 +29,51 @@
 // Hacky: represents not-specified query arguments
 #define NONE -1
 
+namespace {
+
+const Metrics::Id kSearchLatency = Metrics::histogram("graph.search_ns");
+const Metrics::Id kSearchResults = Metrics::histogram("graph.search_results");
+const Metrics::Id kExtractLatency = Metrics::histogram("graph.extract_ns");
+const Metrics::Id kBytesExtracted = Metrics::counter("graph.bytes_extracted");
+const Metrics::Id kNpaSteps = Metrics::counter("graph.npa_steps");
+
+// Searches `table` for `key`, recording the latency and the size of the
+// matching suffix array range.
+template<typename Table, typename Result>
+inline void search(Table* table, Result& result, const std::string& key) {
+  {
+    Trace::Span span("search");
+    Metrics::ScopedLatency latency(kSearchLatency);
+    table->Search(result, key);
+  }
+  Metrics::record(kSearchResults, result.size());
+}
+
+inline std::vector<int64_t> decode_node_ids(const std::string& str,
+                                            int32_t width) {
+  Trace::Span span("decode");
+  return SuccinctGraphSerde::decode_multi_node_ids(str, width);
+}
+
+// Records the latency of an extraction and the NPA steps it walked.
+class ExtractMetrics {
+ public:
+  ExtractMetrics()
+      : span_("extract"),
+        latency_(kExtractLatency),
+        npa_steps_(NPA::WalkSteps()) {
+  }
+  ~ExtractMetrics() {
+    Metrics::add(kNpaSteps, NPA::WalkSteps() - npa_steps_);
+  }
+ private:
+  Trace::Span span_;
+  Metrics::ScopedLatency latency_;
+  uint64_t npa_steps_;
+};
+
+}  // namespace
+
 // Used in edge table layout only.
 const char SuccinctGraph::NODE_ID_DELIM = '\x02';
 const char SuccinctGraph::ATYPE_DELIM = '\x03';
@@ -68,8 +118,15 @@ void SuccinctGraph::load(std::string node_succinct_dir,
 
 void SuccinctGraph::load_node_table(std::string node_succinct_dir) {
   LOG_E("In SuccinctGraph::load_node_table\n");
+  // Sampling and encoding schemes are picked up from the serialized table
   this->node_table = new SuccinctShard(0, node_succinct_dir,
-                                       SuccinctMode::LOAD_MEMORY_MAPPED);
+                                       SuccinctMode::LOAD_MEMORY_MAPPED,
+                                       sa_sampling_rate, isa_sampling_rate,
+                                       npa_sampling_rate,
+                                       SamplingScheme::FLAT_SAMPLE_BY_INDEX,
+                                       isa_sampling_scheme,
+                                       npa_encoding_scheme, 3, 1024, "\n",
+                                       load_policy);
   LOG_E("Done SuccinctGraph::load_node_table\n");
 }
 
@@ -81,19 +138,35 @@ void SuccinctGraph::load_edge_table(std::string edge_succinct_dir) {
       edge_succinct_dir, SuccinctMode::LOAD_MEMORY_MAPPED);
 #else
   edge_table = new SuccinctFile(edge_succinct_dir,
-                                SuccinctMode::LOAD_MEMORY_MAPPED);
+                                SuccinctMode::LOAD_MEMORY_MAPPED,
+                                sa_sampling_rate, isa_sampling_rate,
+                                npa_sampling_rate,
+                                SamplingScheme::FLAT_SAMPLE_BY_INDEX,
+                                isa_sampling_scheme,
+                                npa_encoding_scheme, 3, 1024,
+                                std::string(1, NODE_ID_DELIM), load_policy);
+#endif
   // Deserialize deleted edges bitmap
   load_deleted_edges(edge_succinct_dir + ".deletes");
-#endif
   LOG_E("Done SuccinctGraph::load_edge_table\n");
 }
 
 void SuccinctGraph::load_deleted_edges(std::string deleted_edges_file) {
   LOG_E("In SuccinctGraph::load_deleted_edges\n");
+  struct stat st;
+  if (stat(deleted_edges_file.c_str(), &st) != 0) {
+    LOG_E("No deleted edges file %s; edges cannot be deleted\n",
+          deleted_edges_file.c_str());
+    return;
+  }
   uint8_t* data = (uint8_t*) SuccinctUtils::MemoryMapMutable(
       deleted_edges_file);
   deleted_edges = new DeletedEdges();
   deleted_edges->MemoryMap(data);
+  if (!deleted_edges->OpenLog(deleted_edges_file + ".log")) {
+    LOG_E("Could not open %s.log; deletes will not persist\n",
+          deleted_edges_file.c_str());
+  }
   LOG_E("Done SuccinctGraph::load_deleted_edges\n");
 }
 
@@ -112,9 +185,37 @@ SuccinctGraph& SuccinctGraph::set_isa_sampling_rate(uint32_t sampling_rate) {
   return *this;
 }
 
+SuccinctGraph& SuccinctGraph::set_npa_encoding_scheme(
+    NPA::NPAEncodingScheme scheme) {
+  this->npa_encoding_scheme = scheme;
+  return *this;
+}
+
+SuccinctGraph& SuccinctGraph::set_isa_sampling_scheme(SamplingScheme scheme) {
+  this->isa_sampling_scheme = scheme;
+  return *this;
+}
+
+SuccinctGraph& SuccinctGraph::set_load_policy(LoadPolicy policy) {
+  this->load_policy = policy;
+  return *this;
+}
+
+void SuccinctGraph::print_load_stats() {
+  if (node_table != nullptr) {
+    LOG_E("Node table load stats:\n");
+    node_table->PrintLoadStats();
+  }
+  if (edge_table != nullptr) {
+    LOG_E("Edge table load stats:\n");
+    edge_table->PrintLoadStats();
+  }
+}
+
 void SuccinctGraph::construct_node_table(std::string node_file) {
-  LOG_E("Constructing node table with npa %d, sa %d, isa %d\n",
-        npa_sampling_rate, sa_sampling_rate, isa_sampling_rate);
+  LOG_E("Constructing node table with npa %d, sa %d, isa %d, npa enc %d\n",
+        npa_sampling_rate, sa_sampling_rate, isa_sampling_rate,
+        npa_encoding_scheme);
 
   // TODO: correct thing to do is use a temp file for this
   // TODO: also, the Succinct dir will have the postfix in it -- not clean?
@@ -141,7 +242,10 @@ void SuccinctGraph::construct_node_table(std::string node_file) {
   this->node_table = new SuccinctShard(0, formatted_node_file,
                                        SuccinctMode::CONSTRUCT_IN_MEMORY,
                                        sa_sampling_rate, isa_sampling_rate,
-                                       npa_sampling_rate);
+                                       npa_sampling_rate,
+                                       SamplingScheme::FLAT_SAMPLE_BY_INDEX,
+                                       isa_sampling_scheme,
+                                       npa_encoding_scheme);
   this->node_table->Serialize();
   LOG_E("Node table constructed and serialized\n");
 
@@ -282,7 +386,11 @@ void SuccinctGraph::construct_edge_table(std::string edge_file,
   EDGE_TABLE = new SuccinctFile(edge_file_name,
                                 SuccinctMode::CONSTRUCT_IN_MEMORY,
                                 sa_sampling_rate, isa_sampling_rate,
-                                npa_sampling_rate);
+                                npa_sampling_rate,
+                                SamplingScheme::FLAT_SAMPLE_BY_INDEX,
+                                isa_sampling_scheme,
+                                npa_encoding_scheme, 3, 1024,
+                                std::string(1, NODE_ID_DELIM));
 #endif
   size_t num_bytes = EDGE_TABLE->Serialize();
   LOG_E("Succinct-encoded edge table, number of bytes written: %zu\n",
@@ -330,12 +438,12 @@ std::vector<int64_t> SuccinctGraph::get_edge_table_offsets(NodeId id,
   COND_LOG_E("In get_edge_table_offsets(%lld, %lld)\n", id, atype);
 
   if (id == NONE && atype == NONE) {
-    EDGE_TABLE->Search(res, key);
+    search(EDGE_TABLE, res, key);
   } else if (atype == NONE) {
-    EDGE_TABLE->Search(res, key + std::to_string(id) + ATYPE_DELIM);
+    search(EDGE_TABLE, res, key + std::to_string(id) + ATYPE_DELIM);
   } else if (id == NONE) {
     // NOTE: since srcIds are variable-length, this case is same as first
-    EDGE_TABLE->Search(res, key);
+    search(EDGE_TABLE, res, key);
     // filter by atype
     std::string atype_str;
     uint64_t suf_arr_idx;
@@ -357,7 +465,7 @@ std::vector<int64_t> SuccinctGraph::get_edge_table_offsets(NodeId id,
     key = mk_edge_table_search_key(id, atype);
     COND_LOG_E("About to search for '%s' (size %d) in edge table\n",
                key.c_str(), key.size());
-    EDGE_TABLE->Search(res, key);
+    search(EDGE_TABLE, res, key);
 #ifdef LOG_DEBUG
     COND_LOG_E("search size for (id %lld, atype %lld): %d\n", id, atype,
                res.size());
@@ -436,17 +544,18 @@ std::vector<SuccinctGraph::Assoc> SuccinctGraph::assoc_range(int64_t src,
     edge_width = std::stoi(str);
     LOG("extracted edge width = '%s'\n", str.c_str());
 
-    // if len is wildcard, extract all that's left
-    len = std::min(static_cast<int64_t>(len_saved), cnt - off);
-    if (len_saved == NONE) {
-      len = cnt - off;
-    }
-    assert(off + len <= cnt);
+    // `off` and `len` count live edges: map them to the span [lo, lo + len)
+    // of edge indexes covering them, deleted edges included.
+    int64_t list = tombstones(src, atype);
+    int64_t lo = select_live(list, 0, off, cnt);
+    int64_t hi = len_saved == NONE ?
+        cnt : select_live(list, lo, len_saved, cnt);
+    len = hi - lo;
     if (len <= 0) {
       continue;
     }
 
-    EDGE_TABLE->Extract(str, curr_off + off * timestamp_width,
+    EDGE_TABLE->Extract(str, curr_off + lo * timestamp_width,
                         len * timestamp_width);
 
     std::vector<int64_t> decoded_timestamps =
@@ -455,15 +564,14 @@ std::vector<SuccinctGraph::Assoc> SuccinctGraph::assoc_range(int64_t src,
     LOG("extracted timestamps = '%s'\n", str.c_str());
 
     curr_off += cnt * timestamp_width;
-    EDGE_TABLE->Extract(str, curr_off + off * dst_id_width, len * dst_id_width);
+    EDGE_TABLE->Extract(str, curr_off + lo * dst_id_width, len * dst_id_width);
 
-    std::vector<int64_t> decoded_dst_ids =
-        SuccinctGraphSerde::decode_multi_node_ids(str, dst_id_width);
+    std::vector<int64_t> decoded_dst_ids = decode_node_ids(str, dst_id_width);
 
     LOG("extracted dst ids: '%s'\n", str.c_str());
 
     curr_off += cnt * dst_id_width;
-    EDGE_TABLE->Extract(str, curr_off + off * edge_width, len * edge_width);
+    EDGE_TABLE->Extract(str, curr_off + lo * edge_width, len * edge_width);
 
     LOG("extracted attrs = '%s'\n", str.c_str());
 
@@ -472,6 +580,9 @@ std::vector<SuccinctGraph::Assoc> SuccinctGraph::assoc_range(int64_t src,
     // https://goo.gl/ckAnB0 - add ctor to Assoc struct, emplace_back w/ it
     // https://goo.gl/zcLovO - don't add ctor, emplace_back() no arg
     for (size_t i = 0; i < decoded_timestamps.size(); ++i) {
+      if (is_deleted(list, lo + i)) {
+        continue;
+      }
       result.emplace_back();
       result.back().src_id = src;
       result.back().dst_id = decoded_dst_ids[i];
@@ -645,15 +756,16 @@ std::vector<SuccinctGraph::Assoc> SuccinctGraph::assoc_get(
                         (range_right - range_left + 1) * dst_id_width);
     LOG("extracted dst ids: '%s'\n", str.c_str());
 
-    std::vector<int64_t> decoded_dst_ids =
-        SuccinctGraphSerde::decode_multi_node_ids(str, dst_id_width);
+    std::vector<int64_t> decoded_dst_ids = decode_node_ids(str, dst_id_width);
 
     // filter
+    int64_t list = tombstones(src, atype);
     std::vector<int64_t> in_set_indexes;
     for (size_t i = 0; i < decoded_dst_ids.size(); ++i) {
       LOG("decoded_dst_id[i=%d] = %lld\n", i, decoded_dst_ids[i]);
 
-      if (dst_id_set.count(decoded_dst_ids[i]) != 0) {
+      if (dst_id_set.count(decoded_dst_ids[i]) != 0
+          && !is_deleted(list, range_left + i)) {
         in_set_indexes.push_back(range_left + i);
         LOG("pass filter id: %d, decoded_dst_id[i] = %lld\n", range_left + i,
             decoded_dst_ids[i]);
@@ -687,8 +799,19 @@ int64_t SuccinctGraph::assoc_count(int64_t src, int64_t atype) {
 
   for (int64_t curr_off : eoffs) {
     suf_arr_idx = -1ULL;
-    curr_off = EDGE_TABLE->SkippingExtractUntil(suf_arr_idx, curr_off,
-                                                TIMESTAMP_WIDTH_DELIM);
+    int64_t list_src = src, list_atype = atype;
+    if (deleted_edges != nullptr && (src == NONE || atype == NONE)) {
+      // Wildcard: the list is only known once its header is extracted
+      curr_off = EDGE_TABLE->ExtractUntil(str, suf_arr_idx, curr_off + 1,
+                                          ATYPE_DELIM);
+      list_src = std::stoll(str);
+      curr_off = EDGE_TABLE->ExtractUntil(str, suf_arr_idx, curr_off,
+                                          TIMESTAMP_WIDTH_DELIM);
+      list_atype = std::stoll(str);
+    } else {
+      curr_off = EDGE_TABLE->SkippingExtractUntil(suf_arr_idx, curr_off,
+                                                  TIMESTAMP_WIDTH_DELIM);
+    }
 
     // "Skip" over the padded timestamp width & padded dst id width anyway
     // This is useful when SuccinctFile is used: saves a sampled ISA lookup
@@ -709,7 +832,12 @@ int64_t SuccinctGraph::assoc_count(int64_t src, int64_t atype) {
             + SuccinctGraphSerde::WIDTH_DST_ID_WIDTH_PADDED,
         EDGE_WIDTH_DELIM);
 
-    total_cnt += std::stoll(str);
+    int64_t cnt = std::stoll(str);
+    int64_t list = tombstones(list_src, list_atype);
+    if (list != -1) {
+      cnt -= deleted_edges->CountDeleted(list, 0, cnt);
+    }
+    total_cnt += cnt;
   }
   return total_cnt;
 }
@@ -800,8 +928,13 @@ std::vector<SuccinctGraph::Assoc> SuccinctGraph::assoc_time_range(
     if (len_saved == NONE) {
       len = cnt;
     }
-    // limit to first `len` edges
-    range_right = std::min(range_right, range_left + len - 1);
+    // limit to first `len` live edges
+    int64_t list = tombstones(src, atype);
+    if (len <= 0) {
+      continue;
+    }
+    range_right = std::min<int64_t>(
+        range_right, select_live(list, range_left, len - 1, cnt));
 
     LOG("range left: %d, range right: %d, cnt: %lld\n", range_left, range_right,
         cnt);
@@ -821,13 +954,15 @@ std::vector<SuccinctGraph::Assoc> SuccinctGraph::assoc_time_range(
     EDGE_TABLE->Extract(str, curr_off + range_left * dst_id_width,
                         (range_right - range_left + 1) * dst_id_width);
     LOG("extracted dst ids: '%s'\n", str.c_str());
-    std::vector<int64_t> decoded_dst_ids =
-        SuccinctGraphSerde::decode_multi_node_ids(str, dst_id_width);
+    std::vector<int64_t> decoded_dst_ids = decode_node_ids(str, dst_id_width);
 
     // TODO: another choice is to do a single extract then filter; evaluate?
     // Now extract only the in-set (and in-range) attrs
     curr_off += cnt * dst_id_width;
     for (size_t i = 0; i < decoded_timestamps.size(); ++i) {
+      if (is_deleted(list, range_left + i)) {
+        continue;
+      }
       result.emplace_back();
       // decoded dst ids and timestamps start w/ absolute idx range_left
       result.back().src_id = src;
@@ -868,6 +1003,7 @@ size_t SuccinctGraph::serialize() {
 // This might not be most efficient as we don't jump over the lengths.
 void SuccinctGraph::get_attribute(std::string& result, int64_t node_id,
                                   int attr) {
+  ExtractMetrics metrics;
   assert(attr < MAX_NUM_NODE_ATTRS);
   uint64_t suf_arr_idx = -1ULL;
 
@@ -898,7 +1034,8 @@ void SuccinctGraph::get_attribute(std::string& result, int64_t node_id,
 
 inline void SuccinctGraph::extract_neighbors(
     std::vector<int64_t>& result, const std::vector<int64_t>& offsets,
-    int32_t skip_length) {
+    int32_t skip_length, int64_t src, int64_t atype) {
+  ExtractMetrics metrics;
   result.clear();
   std::string str;
   uint64_t suf_arr_idx;
@@ -908,9 +1045,17 @@ inline void SuccinctGraph::extract_neighbors(
   for (int64_t curr_off : offsets) {
     suf_arr_idx = -1ULL;
 
-    curr_off = EDGE_TABLE->SkippingExtractUntil(suf_arr_idx,
-                                                curr_off + skip_length,
-                                                TIMESTAMP_WIDTH_DELIM);
+    int64_t list_atype = atype;
+    if (deleted_edges != nullptr && atype == NONE) {
+      curr_off = EDGE_TABLE->ExtractUntil(str, suf_arr_idx,
+                                          curr_off + skip_length,
+                                          TIMESTAMP_WIDTH_DELIM);
+      list_atype = std::stoll(str);
+    } else {
+      curr_off = EDGE_TABLE->SkippingExtractUntil(suf_arr_idx,
+                                                  curr_off + skip_length,
+                                                  TIMESTAMP_WIDTH_DELIM);
+    }
 
     EDGE_TABLE->Extract(str, suf_arr_idx, curr_off,
                         SuccinctGraphSerde::WIDTH_TIMESTAMP_WIDTH_PADDED);
@@ -939,23 +1084,27 @@ inline void SuccinctGraph::extract_neighbors(
                         cnt * dst_id_width);
     LOG("dst ids = '%s'\n", str.c_str());
 
-#ifdef BYTES_EXTRACTED
-    bytes_extracted += cnt * dst_id_width;
-#endif
+    Metrics::add(kBytesExtracted, cnt * dst_id_width);
 
-    std::vector<int64_t> decoded(
-        SuccinctGraphSerde::decode_multi_node_ids(str, dst_id_width));
+    std::vector<int64_t> decoded(decode_node_ids(str, dst_id_width));
 
-    result.insert(result.end(), decoded.begin(), decoded.end());
+    int64_t list = tombstones(src, list_atype);
+    if (list == -1 || deleted_edges->CountDeleted(list, 0, cnt) == 0) {
+      result.insert(result.end(), decoded.begin(), decoded.end());
+      continue;
+    }
+    for (int64_t i = 0; i < cnt; ++i) {
+      if (!deleted_edges->IsDeletedAt(list, i)) {
+        result.push_back(decoded[i]);
+      }
+    }
   }
-
-#ifdef BYTES_EXTRACTED
-  printf(",%lld\n", bytes_extracted);
-#endif
 }
 
 void SuccinctGraph::extract_edge_attrs(std::vector<std::string>& result,
-                                       int64_t curr_off, int32_t skip_length) {
+                                       int64_t curr_off, int32_t skip_length,
+                                       int64_t src, int64_t atype) {
+  ExtractMetrics metrics;
   std::string str;
   uint64_t suf_arr_idx = -1ULL;
 
@@ -990,10 +1139,14 @@ void SuccinctGraph::extract_edge_attrs(std::vector<std::string>& result,
   EDGE_TABLE->Extract(str, curr_off + cnt * (timestamp_width + dst_id_width),
                       cnt * edge_attr_width);
   LOG("attrs = '%s'\n", str.c_str());
+  Metrics::add(kBytesExtracted, cnt * edge_attr_width);
 
-  result.resize(cnt);
+  int64_t list = tombstones(src, atype);
+  result.reserve(cnt);
   for (size_t i = 0; i < cnt; ++i) {
-    result[i] = std::move(str.substr(i * edge_attr_width, edge_attr_width));
+    if (!is_deleted(list, i)) {
+      result.push_back(str.substr(i * edge_attr_width, edge_attr_width));
+    }
   }
 }
 
@@ -1001,45 +1154,31 @@ void SuccinctGraph::get_edge_attrs(std::vector<std::string>& result,
                                    int64_t node, int64_t atype) {
   result.clear();
   std::vector<int64_t> offsets;
-  EDGE_TABLE->Search(
-      offsets,
+  search(
+      EDGE_TABLE, offsets,
       NODE_ID_DELIM + std::to_string(node) + ATYPE_DELIM + std::to_string(atype)
           + TIMESTAMP_WIDTH_DELIM);
   assert(offsets.size() <= 1);
   if (offsets.size() == 1) {
     // skip node delim, node, atype delim
-    extract_edge_attrs(result, offsets[0], num_digits(node) + 2);
+    extract_edge_attrs(result, offsets[0], num_digits(node) + 2, node, atype);
   }
 }
 
 void SuccinctGraph::get_neighbors(std::vector<int64_t>& result, int64_t node) {
 
-#ifdef DEBUG_TIME_NHBR1
-  auto t1 = get_timestamp();
-#endif
-
   std::vector<int64_t> offsets;
-  EDGE_TABLE->Search(offsets,
-                     NODE_ID_DELIM + std::to_string(node) + ATYPE_DELIM);
-
-#ifdef DEBUG_TIME_NHBR1
-  auto t2 = get_timestamp();
-  printf(".%lld\n", t2 - t1);
-  t1 = get_timestamp();
-#endif
+  search(EDGE_TABLE, offsets,
+         NODE_ID_DELIM + std::to_string(node) + ATYPE_DELIM);
 
   // skip node delim, node, atype delim
-  extract_neighbors(result, offsets, num_digits(node) + 2);
-
-#ifdef DEBUG_TIME_NHBR1
-  t2 = get_timestamp();
-  printf(",%lld\n", t2 - t1);
-#endif
+  extract_neighbors(result, offsets, num_digits(node) + 2, node, NONE);
 }
 
 void SuccinctGraph::filter_nodes(std::vector<int64_t>& result,
                                  const std::vector<int64_t>& node_ids, int attr,
                                  const std::string& search_key) {
+  ExtractMetrics metrics;
   COND_LOG_E("in graph filter_nodes(.., attr %d, key '%s')\n", attr,
              search_key.c_str());
 
@@ -1079,6 +1218,7 @@ void SuccinctGraph::filter_nodes(std::vector<int64_t>& result,
 }
 
 void SuccinctGraph::obj_get(std::vector<std::string>& results, int64_t obj_id) {
+  ExtractMetrics metrics;
   std::string token;
   uint64_t suf_arr_idx = -1ULL;
   int64_t start_offset = this->node_table->ExtractUntil(
@@ -1111,62 +1251,32 @@ void SuccinctGraph::obj_get(std::vector<std::string>& results, int64_t obj_id) {
 void SuccinctGraph::get_neighbors(std::vector<int64_t>& result, int64_t node_id,
                                   int attr, const std::string& search_key) {
 
-#ifdef DEBUG_TIME_NHBR2
-  auto t1 = get_timestamp();
-#endif
-
   assert(attr < SuccinctGraph::MAX_NUM_NODE_ATTRS);
   std::vector<int64_t> nbhrs;
   get_neighbors(nbhrs, node_id);
 
-#ifdef DEBUG_TIME_NHBR2
-  auto t2 = get_timestamp();
-  printf(".%lld\n", t2 - t1);
-  if (t2 - t1 == 0) assert(nbhrs.empty());
-  t1 = get_timestamp();
-#endif
-
   filter_nodes(result, nbhrs, attr, search_key);
-
-#ifdef DEBUG_TIME_NHBR2
-  t2 = get_timestamp();
-  printf(",%lld\n", t2 - t1);
-#endif
 }
 
 void SuccinctGraph::get_neighbors(std::vector<int64_t>& result, int64_t node,
                                   int64_t atype) {
 
-#ifdef DEBUG_TIME_NHBR3
-  auto t1 = get_timestamp();
-#endif
-
   std::vector<int64_t> offsets;
-  EDGE_TABLE->Search(
-      offsets,
+  search(
+      EDGE_TABLE, offsets,
       NODE_ID_DELIM + std::to_string(node) + ATYPE_DELIM + std::to_string(atype)
           + TIMESTAMP_WIDTH_DELIM);
 
-#ifdef DEBUG_TIME_NHBR3
-  auto t2 = get_timestamp();
-  printf(".%lld\n", t2 - t1);
-  t1 = get_timestamp();
-#endif
-
   // skip 2 delims & node & atype, i.e. first ISA lookup will hit dst id delim
-  extract_neighbors(result, offsets, num_digits(node) + num_digits(atype) + 2);
-
-#ifdef DEBUG_TIME_NHBR3
-  t2 = get_timestamp();
-  printf(",%lld\n", t2 - t1);
-#endif
+  extract_neighbors(result, offsets, num_digits(node) + num_digits(atype) + 2,
+                    node, atype);
 }
 
 void SuccinctGraph::get_nodes(std::set<int64_t>& result, int attr,
                               const std::string& search_key) {
 
   result.clear();
-  this->node_table->Search(result, mk_node_attr_key(attr, search_key));
+  search(this->node_table, result, mk_node_attr_key(attr, search_key));
 }
 
 void SuccinctGraph::get_nodes(std::set<int64_t>& result, int attr1,
@@ -1175,8 +1285,8 @@ void SuccinctGraph::get_nodes(std::set<int64_t>& result, int attr1,
 
   result.clear();
   std::set<int64_t> s1, s2;
-  this->node_table->Search(s1, mk_node_attr_key(attr1, search_key1));
-  this->node_table->Search(s2, mk_node_attr_key(attr2, search_key2));
+  search(this->node_table, s1, mk_node_attr_key(attr1, search_key1));
+  search(this->node_table, s2, mk_node_attr_key(attr2, search_key2));
   // result.end() is a hint that supposedly is faster than .begin()
   std::set_intersection(s1.begin(), s1.end(), s2.begin(), s2.end(),
                         std::inserter(result, result.end()));
@@ -1279,7 +1389,7 @@ bool SuccinctGraph::getLink(Link& link, int64_t id1, int64_t link_type,
         break;
     }
 
-    if (idx == cnt || deleted_edges->IsDeleted(id1, link_type, idx)) {
+    if (idx == cnt || is_deleted(tombstones(id1, link_type), idx)) {
       link.src_id = -1;
       link.atype = -1;
       link.dst_id = -1;
@@ -1287,8 +1397,7 @@ bool SuccinctGraph::getLink(Link& link, int64_t id1, int64_t link_type,
       continue;
     }
 
-    COND_LOG_E("Found edge at idx = %lld; invalid_edge_bit=%u\n", idx,
-               deleted_edges->IsDeleted(id1, link_type, idx));
+    COND_LOG_E("Found edge at idx = %lld\n", idx);
 
     // Populate link data
     link.src_id = id1;
@@ -1380,8 +1489,9 @@ bool SuccinctGraph::deleteLink(int64_t id1, int64_t link_type, int64_t id2) {
     if (idx == cnt)
       continue;
 
-    if (!deleted_edges->IsDeleted(id1, link_type, idx)) {
-      deleted_edges->Delete(id1, link_type, idx);
+    // Logged by DeletedEdges, so the delete survives a reload
+    if (deleted_edges != nullptr
+        && deleted_edges->Delete(id1, link_type, idx)) {
       return true;
     }
   }
@@ -1450,12 +1560,12 @@ void SuccinctGraph::getLinkList(std::vector<Link>& assocs, int64_t id1,
     curr_off += cnt * timestamp_width;
     EDGE_TABLE->Extract(str, curr_off, cnt * dst_id_width);
 
-    std::vector<int64_t> decoded_dst_ids =
-        SuccinctGraphSerde::decode_multi_node_ids(str, dst_id_width);
+    std::vector<int64_t> decoded_dst_ids = decode_node_ids(str, dst_id_width);
 
     COND_LOG_E("extracted dst ids: '%s'\n", str.c_str());
 
     curr_off += cnt * dst_id_width;
+    int64_t list = tombstones(id1, link_type);
     for (size_t i = 0; i < cnt; ++i) {
       assocs.emplace_back();
       assocs.back().src_id = id1;
@@ -1468,7 +1578,7 @@ void SuccinctGraph::getLinkList(std::vector<Link>& assocs, int64_t id1,
                           prop_len);
       curr_off += (edge_data_len_width + prop_len);
 
-      if (deleted_edges->IsDeleted(id1, link_type, i)) {
+      if (is_deleted(list, i)) {
         assocs.pop_back();
       }
     }
@@ -1551,7 +1661,9 @@ void SuccinctGraph::getLinkList(std::vector<Link>& assocs, int64_t id1,
     COND_LOG_E("range left: %d, range right: %d, cnt: %lld\n", range_left,
                range_right, cnt);
 
-    int64_t lo = range_left + offset;
+    // `offset` skips live edges only
+    int64_t list = tombstones(id1, link_type);
+    int64_t lo = select_live(list, range_left, offset, range_right + 1);
     int64_t hi = range_right;
     if (lo > range_right) {
       continue;
@@ -1570,8 +1682,7 @@ void SuccinctGraph::getLinkList(std::vector<Link>& assocs, int64_t id1,
                         (hi - lo + 1) * dst_id_width);
     COND_LOG_E("extracted dst ids: '%s'\n", str.c_str());
 
-    std::vector<int64_t> decoded_dst_ids =
-        SuccinctGraphSerde::decode_multi_node_ids(str, dst_id_width);
+    std::vector<int64_t> decoded_dst_ids = decode_node_ids(str, dst_id_width);
 
     curr_off += cnt * dst_id_width;
     for (size_t i = 0; i <= hi && assocs.size() < limit; ++i) {
@@ -1579,17 +1690,18 @@ void SuccinctGraph::getLinkList(std::vector<Link>& assocs, int64_t id1,
         edge_table->Extract(str, curr_off, edge_data_len_width);
         curr_off += (edge_data_len_width + std::stoll(str));
       } else {
+        // decoded dst ids and timestamps start w/ absolute idx lo
         assocs.emplace_back();
         assocs.back().src_id = id1;
-        assocs.back().dst_id = decoded_dst_ids[i];
+        assocs.back().dst_id = decoded_dst_ids[i - lo];
         assocs.back().atype = link_type;
-        assocs.back().time = decoded_timestamps[i];
+        assocs.back().time = decoded_timestamps[i - lo];
         edge_table->Extract(str, curr_off, edge_data_len_width);
         int64_t prop_len = std::stoll(str);
         edge_table->Extract(assocs.back().attr, curr_off + edge_data_len_width,
                             prop_len);
         curr_off += (edge_data_len_width + prop_len);
-        if (deleted_edges->IsDeleted(id1, link_type, i))
+        if (is_deleted(list, i))
           assocs.pop_back();
       }
     }
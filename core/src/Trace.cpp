@@ -0,0 +1,114 @@
+#include "Trace.h"
+
+#include "utils.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Event {
+  const char* name;
+  int64_t trace_id;
+  uint64_t start_ns;
+  uint64_t end_ns;
+  int tid;
+};
+
+// Buffered spans are written out once this many are pending, or once a
+// second, whichever comes first.
+const size_t kFlushEvents = 4096;
+const uint64_t kFlushIntervalNs = 1000000000ULL;
+
+std::mutex trace_mutex;
+FILE* trace_file = nullptr;
+std::vector<Event> pending_events;
+uint64_t last_flush_ns = 0;
+int trace_pid = 0;
+
+std::atomic<uint64_t> sample_every(0);
+std::atomic<int64_t> next_trace_id(0);
+std::atomic<int> next_tid(0);
+
+// Small per-thread ids make for readable track names in the viewer.
+int current_tid() {
+  static thread_local int tid = ++next_tid;
+  return tid;
+}
+
+void write_pending() {
+  for (const Event& e : pending_events) {
+    // Timestamps are in us; printed as integers plus ns, as wall-clock ns do
+    // not fit a double.
+    fprintf(trace_file, "{\"name\": \"%s\", \"cat\": \"query\", \"ph\": \"X\", "
+            "\"ts\": %" PRIu64 ".%03u, \"dur\": %.3f, \"pid\": %d, "
+            "\"tid\": %d, \"args\": {\"trace_id\": %" PRId64 "}},\n",
+            e.name, e.start_ns / 1000, (unsigned) (e.start_ns % 1000),
+            (e.end_ns - e.start_ns) / 1e3, trace_pid, e.tid, e.trace_id);
+  }
+  fflush(trace_file);
+  pending_events.clear();
+}
+
+}  // namespace
+
+thread_local int64_t Trace::current_ = 0;
+
+bool Trace::configure(const std::string& path, double sample_rate, int pid) {
+  std::lock_guard<std::mutex> lk(trace_mutex);
+  if (trace_file != nullptr) {
+    write_pending();
+    fclose(trace_file);
+  }
+  trace_file = fopen(path.c_str(), "w");
+  if (trace_file == nullptr) {
+    LOG_E("Could not open trace file %s\n", path.c_str());
+    sample_every = 0;
+    return false;
+  }
+  // JSON array format; the closing bracket is optional, so the file stays
+  // loadable however the process exits.
+  fprintf(trace_file, "[\n");
+  trace_pid = pid;
+  last_flush_ns = now_ns();
+  sample_every = sample_rate <= 0 ?
+      0 : std::max<uint64_t>(1, std::llround(1 / sample_rate));
+  return true;
+}
+
+int64_t Trace::sample() {
+  uint64_t every = sample_every.load(std::memory_order_relaxed);
+  if (every == 0) {
+    return 0;
+  }
+  static thread_local uint64_t queries = 0;
+  if (queries++ % every != 0) {
+    return 0;
+  }
+  return (static_cast<int64_t>(trace_pid + 1) << 40) | ++next_trace_id;
+}
+
+void Trace::record(const char* name, int64_t trace_id, uint64_t start_ns,
+                   uint64_t end_ns) {
+  Event event = { name, trace_id, start_ns, end_ns, current_tid() };
+  std::lock_guard<std::mutex> lk(trace_mutex);
+  if (trace_file == nullptr) {
+    return;
+  }
+  pending_events.push_back(event);
+  if (pending_events.size() >= kFlushEvents
+      || end_ns - last_flush_ns >= kFlushIntervalNs) {
+    write_pending();
+    last_flush_ns = end_ns;
+  }
+}
+
+void Trace::flush() {
+  std::lock_guard<std::mutex> lk(trace_mutex);
+  if (trace_file != nullptr) {
+    write_pending();
+  }
+}
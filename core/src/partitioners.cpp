@@ -1,6 +1,8 @@
 #include "partitioners.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <tuple>
 #include <unistd.h>
 
 #include "utils.h"
@@ -11,7 +13,7 @@ void RangePartitioner::partition(
 {
 
     std::ifstream node_file_stream(node_file_in);
-    std::string line, curr_split_filename;
+    std::string line, src_id_str;
 
     std::vector<std::string> lines;
     while (std::getline(node_file_stream, line)) {
@@ -19,56 +21,43 @@ void RangePartitioner::partition(
     }
 
     assert(static_cast<size_t>(this->num_shards_) <= lines.size()); // we can relax this assumption
-    int lines_per_split = lines.size() / this->num_shards_;
+    RangeShardRouter router(this->num_shards_, lines.size());
     int num_shards_digits = num_digits(this->num_shards_);
-    int diff = lines.size() - lines_per_split * this->num_shards_;
-    int shard_idx = 0;
-
-    size_t split_start_line = 0;
-    while (split_start_line < lines.size()) {
-        std::string s(format_out_name(
-            node_file_in, num_shards_digits, shard_idx, this->num_shards_));
-        std::ofstream curr_split_ofstream(s);
-        size_t j = split_start_line;
-        for ( ; j < split_start_line + lines_per_split && j < lines.size(); ++j)
-            curr_split_ofstream << lines.at(j) << std::endl;
-
-        // first diff shards output one more line
-        if (shard_idx < diff) {
-            ++split_start_line;
-            curr_split_ofstream << lines.at(j) << std::endl;
+
+    // Each shard's nodes are consecutive, so each split is written in one go.
+    std::ofstream curr_split_ofstream;
+    int32_t shard_idx = -1;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (router.shard_of(i) != shard_idx) {
+            shard_idx = router.shard_of(i);
+            curr_split_ofstream.close();
+            curr_split_ofstream.open(format_out_name(
+                node_file_in, num_shards_digits, shard_idx, num_shards_));
         }
-        split_start_line += lines_per_split;
-        ++shard_idx;
+        curr_split_ofstream << lines.at(i) << std::endl;
     }
+    curr_split_ofstream.close();
 
     /*********** edge file ***********/
 
+    // Sorted by src id, so the same goes for the edges; shards without any
+    // get no split.
     std::ifstream edge_file_stream(edge_file_in);
-    int64_t curr_id_limit = lines_per_split;
-    if (diff > 0) ++curr_id_limit;
-
-    std::string src_id_str;
-    shard_idx = 0;
-    std::ofstream curr_split_ofstream(format_out_name(
-        edge_file_in, num_shards_digits, 0, num_shards_));
-
+    shard_idx = -1;
     while (std::getline(edge_file_stream, line)) {
         std::stringstream ss(line);
         std::getline(ss, src_id_str, ' ');
-        while (std::stol(src_id_str) >= curr_id_limit) {
-            // initialize new stream
-            ++shard_idx;
-            curr_id_limit += lines_per_split;
-            if (shard_idx < diff) ++curr_id_limit; // leftovers
-            if (std::stol(src_id_str) < curr_id_limit) {
-                curr_split_ofstream.close();
-                curr_split_ofstream.open(format_out_name(
-                    edge_file_in, num_shards_digits, shard_idx, num_shards_));
-            }
+        int32_t shard = router.shard_of(std::stol(src_id_str));
+        if (shard != shard_idx) {
+            shard_idx = shard;
+            curr_split_ofstream.close();
+            curr_split_ofstream.open(format_out_name(
+                edge_file_in, num_shards_digits, shard_idx, num_shards_));
         }
         curr_split_ofstream << line << std::endl;
     }
+
+    router.save(node_file_in + "-shardmap");
 }
 
 // TODO: partition two files in parallel
@@ -76,8 +65,7 @@ void HashPartitioner::partition(
     const std::string& node_file_in,
     const std::string& edge_file_in)
 {
-    int32_t N = this->num_shards_;
-    auto id_to_shard = [N](int64_t node_id) { return node_id % N; };
+    ModuloShardRouter router(this->num_shards_);
     std::string line;
 
     int num_shards_digits = num_digits(this->num_shards_);
@@ -95,14 +83,13 @@ void HashPartitioner::partition(
     while (std::getline(edgefile_ifstream, line)) {
         std::stringstream ss(line);
         std::getline(ss, src_id_str, ' ');
-        *(shard_edge_outs[id_to_shard(std::stoll(src_id_str))]) << line
+        *(shard_edge_outs[router.shard_of(std::stoll(src_id_str))]) << line
             << std::endl;
     }
 }
 
 void HashPartitioner::partition_node_table(const std::string& node_file_in) {
-    int32_t N = this->num_shards_;
-    auto id_to_shard = [N](int64_t node_id) { return node_id % N; };
+    ModuloShardRouter router(this->num_shards_);
     std::string line;
 
     int num_shards_digits = num_digits(this->num_shards_);
@@ -118,22 +105,205 @@ void HashPartitioner::partition_node_table(const std::string& node_file_in) {
     int64_t node_id = 0;
     while (std::getline(file_ifstream, line)) {
         std::stringstream ss(line);
-        *(shard_edge_outs[id_to_shard(node_id)]) << line << std::endl;
+        *(shard_edge_outs[router.shard_of(node_id)]) << line << std::endl;
         ++node_id;
     }
 }
 
+ShardMap DegreeAwarePartitioner::place(
+    const std::unordered_map<int64_t, double>& loads,
+    int64_t num_nodes) const
+{
+    int32_t N = this->num_shards_;
+    ShardMap shard_map(N);
+
+    double total_load = 0;
+    std::vector<double> shard_loads(N, 0);
+    for (const auto& entry : loads) {
+        total_load += entry.second;
+        shard_loads[entry.first % N] += entry.second;
+        num_nodes = std::max(num_nodes, entry.first + 1);
+    }
+
+    // Heavy nodes are taken off their shards, and put back largest first.
+    double threshold = heavy_fraction_ * total_load / N;
+    std::vector<std::pair<double, int64_t>> heavy;
+    for (const auto& entry : loads) {
+        if (entry.second > threshold) {
+            heavy.push_back(std::make_pair(entry.second, entry.first));
+            shard_loads[entry.first % N] -= entry.second;
+        }
+    }
+    std::sort(heavy.begin(), heavy.end(),
+        [](const std::pair<double, int64_t>& lhs,
+           const std::pair<double, int64_t>& rhs) {
+            return lhs.first > rhs.first
+                || (lhs.first == rhs.first && lhs.second < rhs.second);
+        });
+
+    // Moved nodes get local keys past those of the shard's own nodes.
+    std::vector<int64_t> next_key(N);
+    for (int32_t i = 0; i < N; ++i) {
+        next_key[i] = num_nodes > i ? (num_nodes - i + N - 1) / N : 0;
+    }
+
+    for (const auto& node : heavy) {
+        int32_t home = node.second % N;
+        int32_t shard = std::min_element(shard_loads.begin(),
+                                         shard_loads.end())
+            - shard_loads.begin();
+        // Stay home if that is as good, or does not overload the shard.
+        if (shard_loads[home] <= shard_loads[shard]
+            || shard_loads[home] + node.first <= total_load / N) {
+            shard = home;
+        }
+        shard_loads[shard] += node.first;
+        if (shard != home) {
+            shard_map.move(node.second, shard, next_key[shard]++);
+        }
+    }
+    return shard_map;
+}
+
+void DegreeAwarePartitioner::partition(
+    const std::string& node_file_in,
+    const std::string& edge_file_in)
+{
+    int32_t N = this->num_shards_;
+    std::string line, id_str;
+
+    std::ifstream node_file_stream(node_file_in);
+    std::vector<std::string> lines;
+    while (std::getline(node_file_stream, line)) {
+        lines.push_back(line);
+    }
+
+    // Each node's share of the edges, plus its share of the queries.
+    std::unordered_map<int64_t, double> loads;
+    std::unordered_map<int64_t, uint64_t> counts;
+    uint64_t num_edges = 0;
+    std::ifstream edge_file_stream(edge_file_in);
+    while (std::getline(edge_file_stream, line)) {
+        std::stringstream ss(line);
+        std::getline(ss, id_str, ' ');
+        ++counts[std::stoll(id_str)];
+        ++num_edges;
+    }
+    for (const auto& entry : counts) {
+        loads[entry.first] += static_cast<double>(entry.second) / num_edges;
+    }
+
+    if (!query_log_.empty()) {
+        counts.clear();
+        size_t num_queries = 0;
+        std::ifstream query_log_stream(query_log_);
+        int64_t node_id;
+        while (std::getline(query_log_stream, line)) {
+            std::stringstream ss(line);
+            if (ss >> node_id) {
+                ++counts[node_id];
+                ++num_queries;
+            }
+        }
+        for (const auto& entry : counts) {
+            loads[entry.first] +=
+                static_cast<double>(entry.second) / num_queries;
+        }
+        LOG_E("Read %zu queries from %s\n", num_queries, query_log_.c_str());
+    }
+
+    ShardMap shard_map = place(loads, lines.size());
+
+    std::vector<double> before(N, 0), after(N, 0);
+    double total_load = 0;
+    for (const auto& entry : loads) {
+        before[entry.first % N] += entry.second;
+        after[shard_map.shard_of(entry.first)] += entry.second;
+        total_load += entry.second;
+    }
+    LOG_E("Moved %zu nodes; the largest shard now has %.2fx the average "
+        "load, down from %.2fx\n", shard_map.num_moved(),
+        *std::max_element(after.begin(), after.end()) * N / total_load,
+        *std::max_element(before.begin(), before.end()) * N / total_load);
+
+    /*********** node file ***********/
+
+    int num_shards_digits = num_digits(N);
+    std::vector<std::shared_ptr<std::ofstream>> shard_node_outs;
+    for (int i = 0; i < N; ++i) {
+        std::string out_name(
+            format_out_name(node_file_in, num_shards_digits, i, N));
+        shard_node_outs.push_back(std::make_shared<std::ofstream>(out_name));
+    }
+
+    // A moved node's old slot is left blank, so the local keys of the others
+    // do not change.
+    std::vector<int64_t> num_lines(N, 0);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        int32_t shard = i % N;
+        if (shard_map.shard_of(i) == shard) {
+            *(shard_node_outs[shard]) << lines[i] << std::endl;
+        } else {
+            *(shard_node_outs[shard]) << std::endl;
+        }
+        ++num_lines[shard];
+    }
+
+    std::vector<std::tuple<int32_t, int64_t, int64_t>> moved;
+    for (const auto& entry : loads) {
+        int32_t shard = shard_map.shard_of(entry.first);
+        if (shard != entry.first % N) {
+            moved.push_back(std::make_tuple(
+                shard, shard_map.local_key(entry.first), entry.first));
+        }
+    }
+    std::sort(moved.begin(), moved.end());
+    for (const auto& node : moved) {
+        int32_t shard = std::get<0>(node);
+        int64_t node_id = std::get<2>(node);
+        for (; num_lines[shard] < std::get<1>(node); ++num_lines[shard]) {
+            *(shard_node_outs[shard]) << std::endl;
+        }
+        if (static_cast<size_t>(node_id) < lines.size()) {
+            *(shard_node_outs[shard]) << lines[node_id];
+        }
+        *(shard_node_outs[shard]) << std::endl;
+        ++num_lines[shard];
+    }
+
+    /*********** edge file ***********/
+
+    std::vector<std::shared_ptr<std::ofstream>> shard_edge_outs;
+    for (int i = 0; i < N; ++i) {
+        std::string out_name(
+            format_out_name(edge_file_in, num_shards_digits, i, N));
+        shard_edge_outs.push_back(std::make_shared<std::ofstream>(out_name));
+    }
+
+    edge_file_stream.clear();
+    edge_file_stream.seekg(0);
+    while (std::getline(edge_file_stream, line)) {
+        std::stringstream ss(line);
+        std::getline(ss, id_str, ' ');
+        *(shard_edge_outs[shard_map.shard_of(std::stoll(id_str))]) << line
+            << std::endl;
+    }
+
+    shard_map.save(node_file_in + "-shardmap");
+}
+
 int main(int argc, char **argv) {
     if (argc < 3) {
         LOG_E("partitioners: [-n total_num_shards=1] [-t type] "
-            "node_file edge_file\n");
+            "[-p hash|range|degree] [-q query_log] node_file edge_file\n");
         return -1;
     }
 
     int c;
     int total_num_shards = 1;
     int type = 0; // 0 for edge table, 1 for node table
-    while ((c = getopt(argc, argv, "n:t:")) != -1) {
+    std::string policy("hash"), query_log;
+    while ((c = getopt(argc, argv, "n:t:p:q:")) != -1) {
         switch(c) {
         case 'n':
             total_num_shards = atoi(optarg);
@@ -141,12 +311,30 @@ int main(int argc, char **argv) {
         case 't':
             type = atoi(optarg);
             break;
+        case 'p':
+            policy = optarg;
+            break;
+        case 'q':
+            query_log = optarg;
+            break;
         }
     }
     assert(optind + 2 >= argc);
     std::string node_file(argv[optind]);
     std::string edge_file(argv[optind + 1]);
 
+    if (policy == "range") {
+        RangePartitioner partitioner(total_num_shards);
+        partitioner.partition(node_file, edge_file);
+        return 0;
+    }
+    if (policy == "degree") {
+        // Both tables, which have to agree on where the moved nodes are.
+        DegreeAwarePartitioner partitioner(total_num_shards, query_log);
+        partitioner.partition(node_file, edge_file);
+        return 0;
+    }
+
     HashPartitioner partitioner(total_num_shards);
 
     if (type == 0) {
@@ -20,6 +20,15 @@ class DeltaEncodedNPA : public NPA {
     uint8_t delta_offset_bits;
   } DeltaEncodedVector;
 
+  // Decoder state after a lookup, used to resume decoding when the next
+  // lookup falls later in the same block
+  typedef struct {
+    DeltaEncodedVector *dv;  // Vector of the last lookup; NULL if none
+    uint64_t idx;            // Index of the last lookup within dv
+    uint64_t val;            // Value at idx
+    uint64_t pos;            // Encoding specific position following idx
+  } DecoderState;
+
   virtual size_t SerializeDeltaEncodedVector(DeltaEncodedVector *dv,
                                              std::ostream& out) {
 
@@ -97,6 +106,14 @@ class DeltaEncodedNPA : public NPA {
   virtual uint64_t LookupDeltaEncodedVector(DeltaEncodedVector *dv,
                                             uint64_t i) = 0;
 
+  // Lookup delta encoded vector, resuming from and updating the decoder
+  // state of a previous lookup if the encoding supports it
+  virtual uint64_t LookupDeltaEncodedVectorWithState(DeltaEncodedVector *dv,
+                                                     uint64_t i,
+                                                     DecoderState *state) {
+    return LookupDeltaEncodedVector(dv, i);
+  }
+
  public:
   // Constructor
   DeltaEncodedNPA(uint64_t npa_size, uint64_t sigma_size, uint32_t context_len,
@@ -168,6 +185,36 @@ class DeltaEncodedNPA : public NPA {
     return npa_val;
   }
 
+  // Walk the NPA; the column of each index is computed once and serves both
+  // the emitted character and the lookup, and decoder state is carried
+  // across steps.
+  virtual uint64_t Walk(uint64_t i, uint64_t k, const char *alphabet,
+                        std::string *result, int end_char = kNoEndChar) {
+    DecoderState state;
+    state.dv = NULL;
+    uint64_t step = 0;
+    for (; step < k; step++) {
+      uint64_t column_id = SuccinctBase::GetRank1(&col_offsets_, i) - 1;
+      assert(column_id < sigma_size_);
+      bool at_end = false;
+      if (alphabet != NULL) {
+        char c = alphabet[column_id];
+        at_end = ((unsigned char) c == end_char);
+        if (!at_end && result != NULL)
+          result->push_back(c);
+      }
+      i = LookupDeltaEncodedVectorWithState(&(del_npa_[column_id]),
+                                            i - col_offsets_[column_id],
+                                            &state);
+      if (at_end) {
+        step++;
+        break;
+      }
+    }
+    WalkSteps() += step;
+    return i;
+  }
+
   virtual size_t StorageSize() {
     size_t tot_size = 3 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
     tot_size += sizeof(contexts_.size())
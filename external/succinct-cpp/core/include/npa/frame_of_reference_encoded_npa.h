@@ -0,0 +1,61 @@
+#ifndef FRAME_OF_REFERENCE_ENCODED_NPA_H
+#define FRAME_OF_REFERENCE_ENCODED_NPA_H
+
+#include "delta_encoded_npa.h"
+
+/*
+ * Frame-of-reference encoded NPA.
+ *
+ * Each column is split into blocks of sampling_rate entries. The first entry
+ * of a block is stored as a sample (the block's reference value); every other
+ * entry is stored as its difference from the reference, bit-packed at a fixed
+ * width chosen per block. Any entry can therefore be accessed in O(1) without
+ * decoding the preceding entries of the block, at the cost of a somewhat
+ * larger encoding than the elias-gamma/delta schemes.
+ *
+ * The DeltaEncodedVector fields are reused as follows:
+ *   samples:           reference value for each block
+ *   deltas:            bit-packed differences from the reference values
+ *   delta_offsets:     per-block (bit offset << kWidthBits | width) pairs
+ */
+class FrameOfReferenceEncodedNPA : public DeltaEncodedNPA {
+ public:
+  // Number of bits used to store the packing width in a block descriptor
+  static const uint32_t kWidthBits = 7;
+
+  FrameOfReferenceEncodedNPA(uint64_t npa_size, uint64_t sigma_size,
+                             uint32_t context_len, uint32_t sampling_rate,
+                             std::string& isa_file,
+                             std::vector<uint64_t>& col_offsets,
+                             std::string npa_file,
+                             SuccinctAllocator &s_allocator);
+
+  FrameOfReferenceEncodedNPA(uint32_t context_len, uint32_t sampling_rate,
+                             SuccinctAllocator &s_allocator);
+
+  // Virtual destructor
+  ~FrameOfReferenceEncodedNPA() {
+  }
+
+  virtual int64_t BinarySearch(int64_t val, uint64_t s, uint64_t e, bool flag);
+
+ protected:
+  // Create frame-of-reference encoded vector
+  virtual void CreateDeltaEncodedVector(DeltaEncodedVector *dv,
+                                        std::vector<uint64_t> &data);
+
+  // Lookup frame-of-reference encoded vector at index i
+  virtual uint64_t LookupDeltaEncodedVector(DeltaEncodedVector *dv, uint64_t i);
+
+ private:
+  // Lookup the value at offset delta_idx (> 0) within a block, given the
+  // block's reference value and descriptor
+  static inline uint64_t LookupBlock(DeltaEncodedVector *dv, uint64_t base,
+                                     uint64_t desc, uint64_t delta_idx) {
+    uint32_t width = desc & ((1ULL << kWidthBits) - 1);
+    uint64_t pos = (desc >> kWidthBits) + (delta_idx - 1) * width;
+    return base + SuccinctBase::LookupBitmapAtPos(dv->deltas, pos, width);
+  }
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef INTERLEAVED_ELIAS_GAMMA_ENCODED_NPA_H
+#define INTERLEAVED_ELIAS_GAMMA_ENCODED_NPA_H
+
+#include "delta_encoded_npa.h"
+
+/*
+ * Elias-gamma encoded NPA with an interleaved, cache-line aligned layout.
+ *
+ * Each column is stored as a sequence of blocks, one per NPA sample. A block
+ * starts on a 64-byte boundary with the 64-bit sample, immediately followed by
+ * the elias-gamma encoded deltas for the remaining (sampling_rate - 1) entries,
+ * and is zero-padded up to the next 64-byte boundary. A small per-column
+ * directory maps a block index to the cache-line the block starts at.
+ *
+ * A lookup therefore touches the directory and the (usually single) cache-line
+ * holding the block, instead of the separate samples, delta offsets, deltas
+ * and prefix-sum table used by EliasGammaEncodedNPA. Deltas are decoded using
+ * a count-leading-zeros on a 64-bit window rather than a table lookup.
+ *
+ * The DeltaEncodedVector fields are reused as follows:
+ *   deltas:            the interleaved blocks (sample + encoded deltas)
+ *   delta_offsets:     the block directory, in cache-lines
+ *   samples:           unused (NULL)
+ */
+class InterleavedEliasGammaEncodedNPA : public DeltaEncodedNPA {
+ public:
+  // Size of a block alignment unit in 64-bit words (one cache-line)
+  static const uint64_t kWordsPerLine = 8;
+
+  InterleavedEliasGammaEncodedNPA(uint64_t npa_size, uint64_t sigma_size,
+                                  uint32_t context_len, uint32_t sampling_rate,
+                                  std::string& isa_file,
+                                  std::vector<uint64_t>& col_offsets,
+                                  std::string npa_file,
+                                  SuccinctAllocator &s_allocator);
+
+  InterleavedEliasGammaEncodedNPA(uint32_t context_len, uint32_t sampling_rate,
+                                  SuccinctAllocator &s_allocator);
+
+  // Virtual destructor
+  ~InterleavedEliasGammaEncodedNPA() {
+  }
+
+  virtual int64_t BinarySearch(int64_t val, uint64_t s, uint64_t e, bool flag);
+
+  virtual size_t SerializeDeltaEncodedVector(DeltaEncodedVector *dv,
+                                             std::ostream& out);
+
+  virtual size_t DeserializeDeltaEncodedVector(DeltaEncodedVector *dv,
+                                               std::istream& in);
+
+  virtual size_t MemoryMapDeltaEncodedVector(DeltaEncodedVector *dv,
+                                             uint8_t *buf);
+
+  virtual size_t DeltaEncodedVectorSize(DeltaEncodedVector *dv);
+
+ protected:
+  // Create interleaved elias-gamma delta encoded vector
+  virtual void CreateDeltaEncodedVector(DeltaEncodedVector *dv,
+                                        std::vector<uint64_t> &data);
+
+  // Lookup interleaved elias-gamma delta encoded vector at index i
+  virtual uint64_t LookupDeltaEncodedVector(DeltaEncodedVector *dv, uint64_t i);
+
+  // Lookup, continuing to decode from the state of the previous lookup if it
+  // was earlier in the same block
+  virtual uint64_t LookupDeltaEncodedVectorWithState(DeltaEncodedVector *dv,
+                                                     uint64_t i,
+                                                     DecoderState *state);
+
+ private:
+  // Returns a pointer to the start of the block with the specified index
+  inline const uint64_t *GetBlock(DeltaEncodedVector *dv, uint64_t block_idx) {
+    uint64_t line = SuccinctBase::LookupBitmapArray(dv->delta_offsets,
+                                                    block_idx,
+                                                    dv->delta_offset_bits);
+    return dv->deltas->bitmap + line * kWordsPerLine;
+  }
+
+  // Returns 64 bits of the block starting at bit position pos
+  static inline uint64_t ReadWindow(const uint64_t *block, uint64_t pos) {
+    uint64_t word_idx = pos / 64, shift = pos % 64;
+    uint64_t window = block[word_idx] << shift;
+    if (shift != 0)
+      window |= block[word_idx + 1] >> (64 - shift);
+    return window;
+  }
+
+  // Decode the elias-gamma encoded value at bit position pos in the block,
+  // and advance pos past it
+  static inline uint64_t EliasGammaDecode(const uint64_t *block,
+                                          uint64_t *pos) {
+    uint64_t window = ReadWindow(block, *pos);
+    assert(window != 0);
+    uint32_t N = __builtin_clzll(window);
+    if (2 * N + 1 <= 64) {
+      *pos += (2 * N + 1);
+      return window >> (63 - 2 * N);
+    }
+
+    // Encoded value spans more than one window
+    *pos += N;
+    uint64_t val = ReadWindow(block, *pos) >> (63 - N);
+    *pos += (N + 1);
+    return val;
+  }
+
+  // Returns the number of bytes of padding required to align pos to a
+  // cache-line boundary
+  static inline uint64_t AlignmentPadding(uint64_t pos) {
+    uint64_t line_bytes = kWordsPerLine * sizeof(uint64_t);
+    return (line_bytes - (pos % line_bytes)) % line_bytes;
+  }
+
+  // Allocates a zeroed, cache-line aligned array of num_words 64-bit words
+  static uint64_t *AllocateAligned(uint64_t num_words);
+};
+
+#endif
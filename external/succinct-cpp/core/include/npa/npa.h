@@ -11,11 +11,16 @@ class NPA {
   typedef enum npa_encoding_scheme {
     WAVELET_TREE_ENCODED = 0,
     ELIAS_DELTA_ENCODED = 1,
-    ELIAS_GAMMA_ENCODED = 2
+    ELIAS_GAMMA_ENCODED = 2,
+    INTERLEAVED_ELIAS_GAMMA_ENCODED = 3,
+    FRAME_OF_REFERENCE_ENCODED = 4
   } NPAEncodingScheme;
 
   typedef SuccinctBase::Bitmap Bitmap;
 
+  // Passed to Walk() to walk without an end character
+  static const int kNoEndChar = -1;
+
   // Constructor
   NPA(uint64_t npa_size, uint64_t sigma_size, uint32_t context_len,
       uint32_t sampling_rate, NPAEncodingScheme encoding_scheme,
@@ -61,6 +66,42 @@ class NPA {
     return operator[](i);
   }
 
+  // Walk the NPA starting at index i for at most k steps. At each step the
+  // character at the current index (alphabet[column]) is appended to result,
+  // if result is not NULL. If end_char is a character (as an unsigned char),
+  // the walk ends after stepping past the first index holding it, without
+  // appending it. Returns the index the walk ends at.
+  virtual uint64_t Walk(uint64_t i, uint64_t k, const char *alphabet,
+                        std::string *result, int end_char = kNoEndChar) {
+    uint64_t step = 0;
+    for (; step < k; step++) {
+      if (alphabet != NULL) {
+        char c = alphabet[SuccinctBase::GetRank1(&col_offsets_, i) - 1];
+        if ((unsigned char) c == end_char) {
+          WalkSteps() += step + 1;
+          return operator[](i);
+        }
+        if (result != NULL)
+          result->push_back(c);
+      }
+      i = operator[](i);
+    }
+    WalkSteps() += step;
+    return i;
+  }
+
+  // Number of steps walked by Walk() on the calling thread, across all NPAs;
+  // callers diff it around an operation to measure its cost.
+  static uint64_t& WalkSteps() {
+    static thread_local uint64_t steps = 0;
+    return steps;
+  }
+
+  // Advance k steps along the NPA starting at index i
+  uint64_t Advance(uint64_t i, uint64_t k) {
+    return Walk(i, k, NULL, NULL);
+  }
+
   virtual size_t Serialize(std::ostream& out) = 0;
 
   virtual size_t Deserialize(std::istream& in) = 0;
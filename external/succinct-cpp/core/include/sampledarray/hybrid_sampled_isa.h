@@ -0,0 +1,59 @@
+#ifndef HYBRID_SAMPLED_ISA_H
+#define HYBRID_SAMPLED_ISA_H
+
+#include "sampled_by_index_isa.h"
+
+/*
+ * ISA sampled by index, with exact ISA values for every record start.
+ *
+ * Record starts are position 0 and every position following a record
+ * delimiter in the input (e.g., '\n' for line-oriented shards). They are
+ * marked in a compressed dictionary, and the ISA value of the k-th record
+ * start is kept in a bit-packed array at index k. Lookups at a record start
+ * are answered with two rank queries instead of an NPA walk from the
+ * preceding flat sample; all other lookups fall back to SampledByIndexISA.
+ *
+ * The record samples are stored separately from the flat samples (see
+ * Serialize/DeserializeRecordSamples), so that the flat sample layout is
+ * identical to SampledByIndexISA.
+ */
+class HybridSampledISA : public SampledByIndexISA {
+ public:
+  // Constructor; record_starts has a bit set for every record start
+  HybridSampledISA(uint32_t sampling_rate, NPA *npa, ArrayStream& sa_stream,
+                   uint64_t sa_n, bitmap_t *record_starts,
+                   SuccinctAllocator &s_allocator);
+
+  HybridSampledISA(uint32_t sampling_rate, NPA *npa,
+                   SuccinctAllocator &s_allocator);
+
+  // Access element at index i
+  virtual uint64_t operator[](uint64_t i);
+
+  // Returns true if position i is a record start
+  bool IsRecordStart(uint64_t i);
+
+  uint64_t NumRecords() {
+    return num_records_;
+  }
+
+  size_t SerializeRecordSamples(std::ostream& out);
+
+  size_t DeserializeRecordSamples(std::istream& in);
+
+  size_t MemoryMapRecordSamples(std::string filename);
+
+  virtual size_t StorageSize();
+
+ private:
+  // Sample ISA values at record starts using original SA
+  void SampleRecords(ArrayStream& sa_stream, uint64_t n,
+                     bitmap_t *record_starts);
+
+  Dictionary *record_starts_;
+  bitmap_t *record_samples_;
+  uint8_t record_sample_bits_;
+  uint64_t num_records_;
+};
+
+#endif
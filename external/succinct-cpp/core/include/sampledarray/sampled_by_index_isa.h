@@ -16,6 +16,10 @@ class SampledByIndexISA : public FlatSampledArray {
   virtual uint64_t operator[](uint64_t i);
 
  protected:
+  // Constructor for derived sampling schemes; does not sample
+  SampledByIndexISA(uint32_t sampling_rate, SamplingScheme scheme, NPA *npa,
+                    SuccinctAllocator &s_allocator);
+
   // Sample by index for ISA using original SA
   virtual void Sample(ArrayStream& original, uint64_t n);
 };
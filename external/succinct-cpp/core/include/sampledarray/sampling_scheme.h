@@ -5,7 +5,8 @@ typedef enum sampling_scheme {
   FLAT_SAMPLE_BY_INDEX = 0,
   FLAT_SAMPLE_BY_VALUE = 1,
   LAYERED_SAMPLE_BY_INDEX = 2,
-  OPPORTUNISTIC_LAYERED_SAMPLE_BY_INDEX = 3
+  OPPORTUNISTIC_LAYERED_SAMPLE_BY_INDEX = 3,
+  HYBRID_SAMPLE_BY_INDEX = 4
 } SamplingScheme;
 
 #endif
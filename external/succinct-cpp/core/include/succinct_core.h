@@ -3,12 +3,16 @@
 
 #include <vector>
 #include <fstream>
+#include <functional>
 
 #include "npa/elias_delta_encoded_npa.h"
 #include "npa/elias_gamma_encoded_npa.h"
+#include "npa/frame_of_reference_encoded_npa.h"
+#include "npa/interleaved_elias_gamma_encoded_npa.h"
 #include "npa/npa.h"
 #include "npa/wavelet_tree_encoded_npa.h"
 #include "sampledarray/flat_sampled_array.h"
+#include "sampledarray/hybrid_sampled_isa.h"
 #include "sampledarray/layered_sampled_array.h"
 #include "sampledarray/layered_sampled_isa.h"
 #include "sampledarray/layered_sampled_sa.h"
@@ -31,11 +35,35 @@ typedef enum {
   LOAD_MEMORY_MAPPED = 3
 } SuccinctMode;
 
+// Controls how pages are faulted in under LOAD_MEMORY_MAPPED
+enum class LoadPolicy {
+  EAGER = 0,           // Populate mappings as they are made (SA stays lazy)
+  LAZY = 1,            // Fault pages in on first access
+  EAGER_PARALLEL = 2,  // Prefault every component using multiple threads
+  HOT_SET = 3          // Prefault all but the SA samples, leave the SA lazy
+};
+
 class SuccinctCore : public SuccinctBase {
  public:
   typedef std::map<char, std::pair<uint64_t, uint32_t>> AlphabetMap;
   typedef std::pair<int64_t, int64_t> Range;
 
+  // Load statistics for a single memory mapped file
+  typedef struct {
+    std::string component;      // File name within the succinct path
+    size_t size;
+    bool prefaulted;
+    uint64_t prefault_time_us;
+  } ComponentLoadStats;
+
+  // Load statistics for LOAD_MEMORY_MAPPED
+  typedef struct {
+    LoadPolicy policy;
+    uint64_t map_time_us;       // Includes population under EAGER
+    uint64_t prefault_time_us;
+    std::vector<ComponentLoadStats> components;
+  } LoadStats;
+
   /* Constructors */
   SuccinctCore(const char *filename, SuccinctMode s_mode =
                    SuccinctMode::CONSTRUCT_IN_MEMORY,
@@ -47,7 +75,9 @@ class SuccinctCore : public SuccinctBase {
                    SamplingScheme::FLAT_SAMPLE_BY_INDEX,
                NPA::NPAEncodingScheme npa_encoding_scheme =
                    NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED,
-               uint32_t sampling_range = 1024);
+               uint32_t sampling_range = 1024,
+               const std::string& record_delimiters = "\n",
+               LoadPolicy load_policy = LoadPolicy::EAGER);
 
   virtual ~SuccinctCore() {
   }
@@ -85,6 +115,11 @@ class SuccinctCore : public SuccinctBase {
 
   virtual void PrintStorageBreakdown();
 
+  // Get load statistics; only populated under LOAD_MEMORY_MAPPED
+  const LoadStats& GetLoadStats();
+
+  void PrintLoadStats();
+
   // Get SA
   SampledArray *GetSA();
 
@@ -123,6 +158,14 @@ class SuccinctCore : public SuccinctBase {
   AlphabetMap alphabet_map_;
   uint32_t alphabet_size_;             // Size of the input alphabet_
 
+  /* Load policy */
+  LoadPolicy load_policy_;
+  LoadStats load_stats_;
+
+  // Runs map_fn with mapped regions logged, then faults in the regions it
+  // mapped according to load_policy_ and records them in load_stats_
+  void MapWithLoadPolicy(std::function<void()> map_fn);
+
  private:
   // Constructs the core data structures
   void Construct(const char* filename, uint32_t sa_sampling_rate,
@@ -130,7 +173,17 @@ class SuccinctCore : public SuccinctBase {
                  uint32_t context_len, SamplingScheme sa_sampling_scheme,
                  SamplingScheme isa_sampling_scheme,
                  NPA::NPAEncodingScheme npa_encoding_scheme,
-                 uint32_t sampling_range);
+                 uint32_t sampling_range,
+                 const std::string& record_delimiters);
+
+  // Returns the NPA encoding scheme recorded in the serialized NPA, or the
+  // provided default if it cannot be read
+  NPA::NPAEncodingScheme StoredNPAEncodingScheme(
+      NPA::NPAEncodingScheme default_scheme);
+
+  // Returns the ISA sampling scheme of the serialized ISA, if it can be
+  // inferred, or the provided default otherwise
+  SamplingScheme StoredISASamplingScheme(SamplingScheme default_scheme);
 
   uint64_t ComputeContextValue(char* data, uint32_t i, uint32_t context_len) {
     uint64_t val = 0;
@@ -35,7 +35,9 @@ class SuccinctShard : public SuccinctCore {
                     SamplingScheme::FLAT_SAMPLE_BY_INDEX,
                 NPA::NPAEncodingScheme npa_encoding_scheme =
                     NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED,
-                uint32_t context_len = 3, uint32_t sampling_range = 1024);
+                uint32_t context_len = 3, uint32_t sampling_range = 1024,
+                const std::string& record_delimiters = "\n",
+                LoadPolicy load_policy = LoadPolicy::EAGER);
 
   virtual ~SuccinctShard() {
   }
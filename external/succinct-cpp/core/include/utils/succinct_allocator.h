@@ -5,14 +5,35 @@
 #include <cstdlib>
 #include <cstring>
 
+// Backing of large blocks allocated through SuccinctAllocator
+typedef enum {
+  NO_HUGEPAGES = 0,           // Plain malloc
+  TRANSPARENT_HUGEPAGES = 1,  // Huge page aligned, madvise(MADV_HUGEPAGE)
+  EXPLICIT_HUGEPAGES = 2      // MAP_HUGETLB from the hugetlbfs pool; falls
+                              // back to transparent huge pages when empty
+} HugePagePolicy;
+
 class SuccinctAllocator {
  public:
+  // Blocks smaller than this are never backed by huge pages
+  static const size_t kHugePageSize = 2 * 1024 * 1024;
+
   /*
    * Constructor
    *
    */
   SuccinctAllocator(bool s_use_hugepages = false);
 
+  /*
+   * Sets the huge page policy used by all allocators, including the ones
+   * used when loading succinct data structures. Set it before constructing
+   * or loading them; blocks already allocated keep their backing.
+   *
+   */
+  static void SetHugePagePolicy(HugePagePolicy policy);
+
+  static HugePagePolicy GetHugePagePolicy();
+
   /*
    * Enable the use of huge pages.
    *
@@ -33,6 +54,13 @@ class SuccinctAllocator {
    */
   void* s_calloc(size_t num, size_t size);
 
+  /*
+   * Allocates a block of size bytes aligned to alignment (a power of two no
+   * larger than kHugePageSize), releasable with s_free.
+   *
+   */
+  void* s_memalign(size_t alignment, size_t size);
+
   /*
    * Changes the size of the memory block pointed to by ptr.
    *
@@ -55,8 +83,13 @@ class SuccinctAllocator {
   void *s_memset(void* ptr, int value, size_t num);
 
  private:
+  // Policy for a block of size bytes
+  HugePagePolicy PolicyFor(size_t size);
+
+  // Allocates a huge page backed block; returns NULL on failure
+  static void* HugePageAlloc(size_t size, HugePagePolicy policy);
+
   bool use_hugepages_;
 
 };
 #endif
-
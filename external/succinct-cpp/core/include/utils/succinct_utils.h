@@ -8,11 +8,15 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <vector>
 
 #include "assertions.h"
 #include "definitions.h"
+#include "succinct_allocator.h"
 
 #ifndef MAP_HUGETLB
 #define MAP_HUGETLB 0
@@ -24,6 +28,13 @@
 
 class SuccinctUtils {
  public:
+  // A memory mapped file
+  typedef struct {
+    std::string filename;
+    void *data;
+    size_t size;
+  } MappedRegion;
+
   // Returns the number of set bits in a 64 bit integer
   static uint64_t PopCount(uint64_t n) {
     // TODO: Add support for hardware instruction
@@ -93,9 +104,11 @@ class SuccinctUtils {
     int fd = open(filename.c_str(), O_RDONLY, 0);
     assert(fd != -1);
 
+    int populate = MappingContext().populate ? MAP_POPULATE : 0;
+
     // Try mapping with huge-pages support
     void *data = mmap(NULL, st.st_size, PROT_READ,
-                      MAP_SHARED | MAP_HUGETLB | MAP_POPULATE,
+                      MAP_SHARED | MAP_HUGETLB | populate,
                       fd, 0);
 
     // Revert to mapping with huge page support in case mapping fails
@@ -104,11 +117,14 @@ class SuccinctUtils {
           stderr,
           "mmap with MAP_HUGETLB option failed; trying without MAP_HUGETLB flag...\n");
       data = mmap(NULL, st.st_size, PROT_READ,
-                  MAP_SHARED | MAP_POPULATE,
+                  MAP_SHARED | populate,
                   fd, 0);
     }
     madvise(data, st.st_size, POSIX_MADV_RANDOM);
     assert(data != (void * )-1);
+    LogMappedRegion(filename, data, st.st_size);
+    BindToMappingNode(data, st.st_size);
+    AdviseHugePages(data, st.st_size);
 
     return data;
   }
@@ -134,6 +150,9 @@ class SuccinctUtils {
     }
     madvise(data, st.st_size, POSIX_MADV_RANDOM);
     assert(data != (void * )-1);
+    LogMappedRegion(filename, data, st.st_size);
+    BindToMappingNode(data, st.st_size);
+    AdviseHugePages(data, st.st_size);
 
     return data;
   }
@@ -146,9 +165,11 @@ class SuccinctUtils {
     int fd = open(filename.c_str(), O_RDWR, 0);
     assert(fd != -1);
 
+    int populate = MappingContext().populate ? MAP_POPULATE : 0;
+
     // Try mapping with huge-pages support
     void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
-                      MAP_SHARED | MAP_HUGETLB | MAP_POPULATE,
+                      MAP_SHARED | MAP_HUGETLB | populate,
                       fd, 0);
 
     // Revert to mapping with huge page support in case mapping fails
@@ -157,15 +178,70 @@ class SuccinctUtils {
           stderr,
           "mmap with MAP_HUGETLB option failed; trying without MAP_HUGETLB flag...\n");
       data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
-                  MAP_SHARED | MAP_POPULATE,
+                  MAP_SHARED | populate,
                   fd, 0);
     }
     madvise(data, st.st_size, POSIX_MADV_RANDOM);
     assert(data != (void * )-1);
+    LogMappedRegion(filename, data, st.st_size);
+    BindToMappingNode(data, st.st_size);
+    AdviseHugePages(data, st.st_size);
 
     return data;
   }
 
+  // Installs a log that records every region subsequently mapped by the
+  // calling thread; pass NULL to remove it. Unless populate is set, mappings
+  // made while a log is installed are not populated, leaving it to the caller
+  // to decide which regions to prefault (see Prefault).
+  static void SetMappedRegionLog(std::vector<MappedRegion> *log,
+                                 bool populate = false) {
+    MappingContext().regions = log;
+    MappingContext().populate = (log == NULL) || populate;
+  }
+
+  // Places every region subsequently mapped by the calling thread on NUMA
+  // node numa_node, moving its pages already in the page cache there; pass -1
+  // to stop. Pages faulted in later are placed by the memory policy of the
+  // faulting thread, so callers should also fault them in from that node.
+  static void SetMappingNode(int numa_node) {
+    MappingContext().numa_node = numa_node;
+  }
+
+  // Faults in every page of a mapped region, splitting the region across
+  // num_threads threads. Returns a checksum of the touched bytes so that the
+  // reads cannot be optimized away.
+  static uint64_t Prefault(void *data, size_t size, uint32_t num_threads = 1) {
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    uint8_t *buf = (uint8_t *) data;
+
+    // Kick off readahead for the whole region before touching it
+    madvise(data, size, MADV_WILLNEED);
+
+    size_t num_pages = NumBlocks(size, page_size);
+    if (num_threads <= 1 || num_pages < num_threads) {
+      return TouchPages(buf, 0, num_pages, size, page_size);
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> checksums(num_threads, 0);
+    size_t pages_per_thread = NumBlocks(num_pages, num_threads);
+    for (uint32_t t = 0; t < num_threads; t++) {
+      size_t page_beg = t * pages_per_thread;
+      size_t page_end = Min(page_beg + pages_per_thread, num_pages);
+      threads.push_back(std::thread([=, &checksums] {
+        checksums[t] = TouchPages(buf, page_beg, page_end, size, page_size);
+      }));
+    }
+
+    uint64_t checksum = 0;
+    for (uint32_t t = 0; t < num_threads; t++) {
+      threads[t].join();
+      checksum += checksums[t];
+    }
+    return checksum;
+  }
+
   static void Unmap(void *data, std::string filename) {
     struct stat st;
     stat(filename.c_str(), &st);
@@ -179,6 +255,70 @@ class SuccinctUtils {
     out.write(reinterpret_cast<const char *>(data), size * sizeof(T));
     out.close();
   }
+
+ private:
+  // Reads one byte from each page in [page_beg, page_end)
+  static uint64_t TouchPages(uint8_t *buf, size_t page_beg, size_t page_end,
+                             size_t size, size_t page_size) {
+    uint64_t checksum = 0;
+    for (size_t p = page_beg; p < page_end && p * page_size < size; p++) {
+      checksum += ((volatile uint8_t *) buf)[p * page_size];
+    }
+    return checksum;
+  }
+
+  // Per-thread state set by SetMappedRegionLog
+  typedef struct {
+    std::vector<MappedRegion> *regions;
+    bool populate;
+    int numa_node;
+  } MappingState;
+
+  static MappingState& MappingContext() {
+    static thread_local MappingState state = { NULL, true, -1 };
+    return state;
+  }
+
+  static void LogMappedRegion(std::string filename, void *data, size_t size) {
+    std::vector<MappedRegion> *log = MappingContext().regions;
+    if (log != NULL) {
+      MappedRegion region = { filename, data, size };
+      log->push_back(region);
+    }
+  }
+
+  // Asks for transparent huge pages on a new mapping if huge pages are
+  // enabled (see SuccinctAllocator::SetHugePagePolicy). File backed mappings
+  // only get them on kernels that support huge pages in the page cache
+  // (CONFIG_READ_ONLY_THP_FOR_FS); elsewhere this is a no-op.
+  static void AdviseHugePages(void *data, size_t size) {
+#ifdef MADV_HUGEPAGE
+    if (SuccinctAllocator::GetHugePagePolicy() != NO_HUGEPAGES) {
+      madvise(data, size, MADV_HUGEPAGE);
+    }
+#endif
+  }
+
+  // Sets a preferred-node policy on a new mapping (mbind), as requested by
+  // SetMappingNode.
+  static void BindToMappingNode(void *data, size_t size) {
+#ifdef SYS_mbind
+    int node = MappingContext().numa_node;
+    if (node < 0 || size == 0) {
+      return;
+    }
+    const int mpol_preferred = 1;     // From <numaif.h> (libnuma)
+    const unsigned mpol_mf_move = 2;
+    const size_t bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(node / bits + 1, 0);
+    mask[node / bits] |= 1UL << (node % bits);
+    if (syscall(SYS_mbind, data, size, mpol_preferred, mask.data(),
+                mask.size() * bits + 1, mpol_mf_move) != 0) {
+      fprintf(stderr, "mbind to NUMA node %d failed; leaving mapping at %p "
+              "unbound\n", node, data);
+    }
+#endif
+  }
 };
 
 #endif
@@ -0,0 +1,192 @@
+#include "npa/frame_of_reference_encoded_npa.h"
+
+FrameOfReferenceEncodedNPA::FrameOfReferenceEncodedNPA(
+    uint64_t npa_size, uint64_t sigma_size, uint32_t context_len,
+    uint32_t sampling_rate, std::string& isa_file,
+    std::vector<uint64_t>& col_offsets, std::string npa_file,
+    SuccinctAllocator &s_allocator)
+    : DeltaEncodedNPA(npa_size, sigma_size, context_len, sampling_rate,
+                      NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED,
+                      s_allocator) {
+  Encode(isa_file, col_offsets, npa_file);
+}
+
+FrameOfReferenceEncodedNPA::FrameOfReferenceEncodedNPA(
+    uint32_t context_len, uint32_t sampling_rate,
+    SuccinctAllocator &s_allocator)
+    : DeltaEncodedNPA(0, 0, context_len, sampling_rate,
+                      NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED,
+                      s_allocator) {
+}
+
+void FrameOfReferenceEncodedNPA::CreateDeltaEncodedVector(
+    DeltaEncodedVector *dv, std::vector<uint64_t> &data) {
+  if (data.size() == 0) {
+    return;
+  }
+  assert(dv != NULL);
+
+  uint64_t num_blocks = SuccinctUtils::NumBlocks(data.size(), sampling_rate_);
+  std::vector<uint64_t> _samples, _block_offsets, _block_widths;
+  _samples.reserve(num_blocks);
+  _block_offsets.reserve(num_blocks);
+  _block_widths.reserve(num_blocks);
+
+  // Compute the reference value, packing width and bit offset of each block
+  uint64_t max_sample = 0, cum_delta_size = 0;
+  for (uint64_t b = 0; b < num_blocks; b++) {
+    uint64_t block_start = b * sampling_rate_;
+    uint64_t block_end = SuccinctUtils::Min(block_start + sampling_rate_,
+                                            data.size());
+    uint64_t base = data[block_start];
+    uint64_t max_diff = data[block_end - 1] - base;
+    uint32_t width =
+        (max_diff == 0) ? 0 : SuccinctUtils::IntegerLog2(max_diff + 1);
+    assert(width < (1U << kWidthBits));
+
+    _samples.push_back(base);
+    if (base > max_sample)
+      max_sample = base;
+    _block_offsets.push_back(cum_delta_size);
+    _block_widths.push_back(width);
+    cum_delta_size += (block_end - block_start - 1) * width;
+  }
+
+  // Can occur at most once per context;
+  // only occurs if 0 is the only value in the cell
+  if (max_sample == 0)
+    dv->sample_bits = 1;
+  else
+    dv->sample_bits = (uint8_t) SuccinctUtils::IntegerLog2(max_sample + 1);
+
+  uint64_t max_offset = _block_offsets.back();
+  uint32_t offset_bits =
+      (max_offset == 0) ? 1 : SuccinctUtils::IntegerLog2(max_offset + 1);
+  dv->delta_offset_bits = (uint8_t) (offset_bits + kWidthBits);
+  assert(dv->delta_offset_bits <= 64);
+
+  // Pack the differences from the reference values
+  dv->deltas = new Bitmap;
+  if (cum_delta_size == 0) {
+    delete dv->deltas;
+    dv->deltas = NULL;
+  } else {
+    SuccinctBase::InitBitmap(&(dv->deltas), cum_delta_size, s_allocator_);
+    for (uint64_t b = 0; b < num_blocks; b++) {
+      uint64_t block_start = b * sampling_rate_;
+      uint64_t block_end = SuccinctUtils::Min(block_start + sampling_rate_,
+                                              data.size());
+      uint32_t width = _block_widths[b];
+      if (width == 0)
+        continue;
+      uint64_t pos = _block_offsets[b];
+      for (uint64_t i = block_start + 1; i < block_end; i++) {
+        assert(data[i] > data[i - 1]);
+        SuccinctBase::SetBitmapAtPos(&(dv->deltas), pos,
+                                     data[i] - _samples[b], width);
+        pos += width;
+      }
+    }
+  }
+
+  // Block descriptors: bit offset and packing width
+  std::vector<uint64_t> _descriptors;
+  _descriptors.reserve(num_blocks);
+  for (uint64_t b = 0; b < num_blocks; b++) {
+    _descriptors.push_back((_block_offsets[b] << kWidthBits)
+        | _block_widths[b]);
+  }
+
+  dv->samples = new Bitmap;
+  SuccinctBase::CreateBitmapArray(&(dv->samples), &_samples[0],
+                                  _samples.size(), dv->sample_bits,
+                                  s_allocator_);
+  dv->delta_offsets = new Bitmap;
+  SuccinctBase::CreateBitmapArray(&(dv->delta_offsets), &_descriptors[0],
+                                  _descriptors.size(), dv->delta_offset_bits,
+                                  s_allocator_);
+}
+
+uint64_t FrameOfReferenceEncodedNPA::LookupDeltaEncodedVector(
+    DeltaEncodedVector *dv, uint64_t i) {
+  uint64_t block_idx = i / sampling_rate_;
+  uint64_t delta_idx = i % sampling_rate_;
+  uint64_t base = SuccinctBase::LookupBitmapArray(dv->samples, block_idx,
+                                                  dv->sample_bits);
+  if (delta_idx == 0)
+    return base;
+
+  uint64_t desc = SuccinctBase::LookupBitmapArray(dv->delta_offsets,
+                                                  block_idx,
+                                                  dv->delta_offset_bits);
+  return LookupBlock(dv, base, desc, delta_idx);
+}
+
+int64_t FrameOfReferenceEncodedNPA::BinarySearch(int64_t val,
+                                                 uint64_t start_idx,
+                                                 uint64_t end_idx, bool flag) {
+  if (end_idx < start_idx)
+    return end_idx;
+
+  // Get column-id
+  uint64_t col_id = SuccinctBase::GetRank1(&col_offsets_, start_idx) - 1;
+  int64_t col_offset = col_offsets_[col_id];
+
+  // Adjust start and end indexes for binary search
+  start_idx -= col_offset;
+  end_idx -= col_offset;
+
+  // Fetch relevant delta encoded vector
+  DeltaEncodedVector *dv = &del_npa_[col_id];
+
+  // Binary search within block samples to get the last block whose sample
+  // is not larger than val
+  int64_t first_block = start_idx / sampling_rate_;
+  int64_t sp = first_block, ep = end_idx / sampling_rate_;
+  int64_t block_idx = first_block - 1;
+  while (sp <= ep) {
+    int64_t m = (sp + ep) / 2;
+    int64_t sample = SuccinctBase::LookupBitmapArray(dv->samples, m,
+                                                     dv->sample_bits);
+    if (sample <= val) {
+      block_idx = m;
+      sp = m + 1;
+    } else {
+      ep = m - 1;
+    }
+  }
+
+  // Index of the first value in the range that is not smaller than val
+  int64_t lower_bound = start_idx;
+  if (block_idx >= first_block) {
+    uint64_t base = SuccinctBase::LookupBitmapArray(dv->samples, block_idx,
+                                                    dv->sample_bits);
+    uint64_t desc = SuccinctBase::LookupBitmapArray(dv->delta_offsets,
+                                                    block_idx,
+                                                    dv->delta_offset_bits);
+
+    // Entries are randomly accessible, so binary search within the block too
+    int64_t block_start = block_idx * sampling_rate_;
+    int64_t lo = SuccinctUtils::Max(block_start, (int64_t) start_idx);
+    int64_t hi = SuccinctUtils::Min(block_start + sampling_rate_ - 1,
+                                    (int64_t) end_idx);
+    lower_bound = hi + 1;
+    while (lo <= hi) {
+      int64_t m = (lo + hi) / 2;
+      int64_t delta_idx = m - block_start;
+      int64_t cur =
+          (delta_idx == 0) ? base : LookupBlock(dv, base, desc, delta_idx);
+      if (cur == val) {
+        return col_offset + m;
+      } else if (cur < val) {
+        lo = m + 1;
+      } else {
+        lower_bound = m;
+        hi = m - 1;
+      }
+    }
+  }
+
+  // Adjust the index based on whether we wanted lower bound or upper bound
+  return col_offset + (flag ? lower_bound - 1 : lower_bound);
+}
@@ -0,0 +1,305 @@
+#include "npa/interleaved_elias_gamma_encoded_npa.h"
+
+#include "npa/elias_gamma_encoded_npa.h"
+
+InterleavedEliasGammaEncodedNPA::InterleavedEliasGammaEncodedNPA(
+    uint64_t npa_size, uint64_t sigma_size, uint32_t context_len,
+    uint32_t sampling_rate, std::string& isa_file,
+    std::vector<uint64_t>& col_offsets, std::string npa_file,
+    SuccinctAllocator &s_allocator)
+    : DeltaEncodedNPA(npa_size, sigma_size, context_len, sampling_rate,
+                      NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED,
+                      s_allocator) {
+  Encode(isa_file, col_offsets, npa_file);
+}
+
+InterleavedEliasGammaEncodedNPA::InterleavedEliasGammaEncodedNPA(
+    uint32_t context_len, uint32_t sampling_rate,
+    SuccinctAllocator &s_allocator)
+    : DeltaEncodedNPA(0, 0, context_len, sampling_rate,
+                      NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED,
+                      s_allocator) {
+}
+
+uint64_t *InterleavedEliasGammaEncodedNPA::AllocateAligned(uint64_t num_words) {
+  size_t num_bytes = num_words * sizeof(uint64_t);
+  void *data = SuccinctAllocator().s_memalign(kWordsPerLine * sizeof(uint64_t),
+                                              num_bytes);
+  assert(data != NULL);
+  memset(data, 0, num_bytes);
+  return (uint64_t *) data;
+}
+
+void InterleavedEliasGammaEncodedNPA::CreateDeltaEncodedVector(
+    DeltaEncodedVector *dv, std::vector<uint64_t> &data) {
+  if (data.size() == 0) {
+    return;
+  }
+  assert(dv != NULL);
+
+  uint64_t num_blocks = SuccinctUtils::NumBlocks(data.size(), sampling_rate_);
+  uint64_t bits_per_line = kWordsPerLine * 64;
+
+  // Compute the starting cache-line for each block
+  std::vector<uint64_t> block_lines;
+  block_lines.reserve(num_blocks);
+  uint64_t num_lines = 0;
+  for (uint64_t b = 0; b < num_blocks; b++) {
+    uint64_t block_start = b * sampling_rate_;
+    uint64_t block_end = SuccinctUtils::Min(block_start + sampling_rate_,
+                                            data.size());
+    uint64_t block_bits = 64;
+    for (uint64_t i = block_start + 1; i < block_end; i++) {
+      assert(data[i] > data[i - 1]);
+      block_bits += EliasGammaEncodedNPA::EliasGammaEncodingSize(
+          data[i] - data[i - 1]);
+    }
+    block_lines.push_back(num_lines);
+    num_lines += SuccinctUtils::NumBlocks(block_bits, bits_per_line);
+  }
+
+  // One trailing cache-line of padding, so that decoding the last block never
+  // reads past the end of the allocation
+  uint64_t num_words = (num_lines + 1) * kWordsPerLine;
+  dv->deltas = new Bitmap;
+  dv->deltas->bitmap = AllocateAligned(num_words);
+  dv->deltas->size = num_words * 64;
+
+  for (uint64_t b = 0; b < num_blocks; b++) {
+    uint64_t block_start = b * sampling_rate_;
+    uint64_t block_end = SuccinctUtils::Min(block_start + sampling_rate_,
+                                            data.size());
+    uint64_t pos = block_lines[b] * bits_per_line;
+    dv->deltas->bitmap[pos / 64] = data[block_start];
+    pos += 64;
+    for (uint64_t i = block_start + 1; i < block_end; i++) {
+      uint64_t delta = data[i] - data[i - 1];
+      uint32_t N = LowerLog2(delta);
+      // N leading zeros, followed by the N + 1 bits of the delta
+      pos += N;
+      SuccinctBase::SetBitmapAtPos(&(dv->deltas), pos, delta, N + 1);
+      pos += (N + 1);
+    }
+  }
+
+  // Block directory
+  uint64_t max_line = block_lines.back();
+  dv->delta_offset_bits =
+      (max_line == 0) ? 1 : SuccinctUtils::IntegerLog2(max_line + 1);
+  dv->delta_offsets = new Bitmap;
+  SuccinctBase::CreateBitmapArray(&(dv->delta_offsets), &block_lines[0],
+                                  block_lines.size(), dv->delta_offset_bits,
+                                  s_allocator_);
+
+  dv->samples = NULL;
+  dv->sample_bits = 64;
+}
+
+uint64_t InterleavedEliasGammaEncodedNPA::LookupDeltaEncodedVector(
+    DeltaEncodedVector *dv, uint64_t i) {
+  const uint64_t *block = GetBlock(dv, i / sampling_rate_);
+  uint64_t delta_idx = i % sampling_rate_;
+  uint64_t val = block[0];
+  uint64_t pos = 64;
+  while (delta_idx--) {
+    val += EliasGammaDecode(block, &pos);
+  }
+  return val;
+}
+
+uint64_t InterleavedEliasGammaEncodedNPA::LookupDeltaEncodedVectorWithState(
+    DeltaEncodedVector *dv, uint64_t i, DecoderState *state) {
+  uint64_t block_idx = i / sampling_rate_;
+  const uint64_t *block = GetBlock(dv, block_idx);
+  uint64_t idx, val, pos;
+  if (state->dv == dv && state->idx <= i
+      && state->idx / sampling_rate_ == block_idx) {
+    idx = state->idx;
+    val = state->val;
+    pos = state->pos;
+  } else {
+    idx = block_idx * sampling_rate_;
+    val = block[0];
+    pos = 64;
+  }
+  while (idx < i) {
+    val += EliasGammaDecode(block, &pos);
+    idx++;
+  }
+
+  state->dv = dv;
+  state->idx = idx;
+  state->val = val;
+  state->pos = pos;
+  return val;
+}
+
+int64_t InterleavedEliasGammaEncodedNPA::BinarySearch(int64_t val,
+                                                      uint64_t start_idx,
+                                                      uint64_t end_idx,
+                                                      bool flag) {
+  if (end_idx < start_idx)
+    return end_idx;
+
+  // Get column-id
+  uint64_t col_id = SuccinctBase::GetRank1(&col_offsets_, start_idx) - 1;
+  int64_t col_offset = col_offsets_[col_id];
+
+  // Adjust start and end indexes for binary search
+  start_idx -= col_offset;
+  end_idx -= col_offset;
+
+  // Fetch relevant delta encoded vector
+  DeltaEncodedVector *dv = &del_npa_[col_id];
+
+  // Binary search within block samples to get the last block whose sample
+  // is not larger than val
+  int64_t first_block = start_idx / sampling_rate_;
+  int64_t sp = first_block, ep = end_idx / sampling_rate_;
+  int64_t block_idx = first_block - 1;
+  while (sp <= ep) {
+    int64_t m = (sp + ep) / 2;
+    if ((int64_t) GetBlock(dv, m)[0] <= val) {
+      block_idx = m;
+      sp = m + 1;
+    } else {
+      ep = m - 1;
+    }
+  }
+
+  // Index of the first value in the range that is not smaller than val
+  int64_t lower_bound = start_idx;
+  if (block_idx >= first_block) {
+    const uint64_t *block = GetBlock(dv, block_idx);
+    int64_t cur = block[0];
+    uint64_t pos = 64;
+    uint64_t idx = block_idx * sampling_rate_;
+    uint64_t block_end = SuccinctUtils::Min(idx + sampling_rate_, end_idx + 1);
+
+    // Skip values before the start of the range
+    while (idx < start_idx) {
+      cur += EliasGammaDecode(block, &pos);
+      idx++;
+    }
+
+    // Keep decoding until the value is reached or the block is exhausted;
+    // the next block (if any) starts with a sample larger than val
+    while (cur < val && idx + 1 < block_end) {
+      cur += EliasGammaDecode(block, &pos);
+      idx++;
+    }
+
+    // If it is an exact match, return the index
+    if (cur == val)
+      return col_offset + idx;
+
+    lower_bound = (cur < val) ? idx + 1 : idx;
+  }
+
+  // Adjust the index based on whether we wanted lower bound or upper bound
+  return col_offset + (flag ? lower_bound - 1 : lower_bound);
+}
+
+size_t InterleavedEliasGammaEncodedNPA::SerializeDeltaEncodedVector(
+    DeltaEncodedVector *dv, std::ostream& out) {
+  size_t out_size = 0;
+
+  out.write(reinterpret_cast<const char *>(&(dv->sample_bits)),
+            sizeof(uint8_t));
+  out_size += sizeof(uint8_t);
+  out.write(reinterpret_cast<const char *>(&(dv->delta_offset_bits)),
+            sizeof(uint8_t));
+  out_size += sizeof(uint8_t);
+
+  out_size += SuccinctBase::SerializeBitmap(dv->delta_offsets, out);
+
+  uint64_t num_words = dv->deltas->size / 64;
+  out.write(reinterpret_cast<const char *>(&num_words), sizeof(uint64_t));
+  out_size += sizeof(uint64_t);
+
+  // Pad so that the blocks start on a cache-line boundary in the file; this
+  // keeps them aligned when the file is memory mapped.
+  uint64_t padding = AlignmentPadding(out.tellp());
+  for (uint64_t i = 0; i < padding; i++) {
+    out.put(0);
+  }
+  out_size += padding;
+
+  out.write(reinterpret_cast<const char *>(dv->deltas->bitmap),
+            num_words * sizeof(uint64_t));
+  out_size += num_words * sizeof(uint64_t);
+
+  return out_size;
+}
+
+size_t InterleavedEliasGammaEncodedNPA::DeserializeDeltaEncodedVector(
+    DeltaEncodedVector *dv, std::istream& in) {
+  size_t in_size = 0;
+
+  in.read(reinterpret_cast<char *>(&(dv->sample_bits)), sizeof(uint8_t));
+  in_size += sizeof(uint8_t);
+  in.read(reinterpret_cast<char *>(&(dv->delta_offset_bits)),
+          sizeof(uint8_t));
+  in_size += sizeof(uint8_t);
+
+  in_size += SuccinctBase::DeserializeBitmap(&(dv->delta_offsets), in);
+
+  uint64_t num_words;
+  in.read(reinterpret_cast<char *>(&num_words), sizeof(uint64_t));
+  in_size += sizeof(uint64_t);
+
+  uint64_t padding = AlignmentPadding(in.tellg());
+  in.ignore(padding);
+  in_size += padding;
+
+  dv->deltas = new Bitmap;
+  dv->deltas->bitmap = AllocateAligned(num_words);
+  dv->deltas->size = num_words * 64;
+  in.read(reinterpret_cast<char *>(dv->deltas->bitmap),
+          num_words * sizeof(uint64_t));
+  in_size += num_words * sizeof(uint64_t);
+
+  dv->samples = NULL;
+
+  return in_size;
+}
+
+size_t InterleavedEliasGammaEncodedNPA::MemoryMapDeltaEncodedVector(
+    DeltaEncodedVector *dv, uint8_t *buf) {
+  uint8_t *data, *data_beg;
+  data = data_beg = buf;
+
+  dv->sample_bits = *data;
+  data += sizeof(uint8_t);
+  dv->delta_offset_bits = *data;
+  data += sizeof(uint8_t);
+
+  data += SuccinctBase::MemoryMapBitmap(&(dv->delta_offsets), data);
+
+  uint64_t num_words = *((uint64_t *) data);
+  data += sizeof(uint64_t);
+
+  // The mapping is page aligned, so the padding matches the one in the file
+  data += AlignmentPadding((uintptr_t) data);
+
+  dv->deltas = new Bitmap;
+  dv->deltas->bitmap = (uint64_t *) data;
+  dv->deltas->size = num_words * 64;
+  data += num_words * sizeof(uint64_t);
+
+  dv->samples = NULL;
+
+  return data - data_beg;
+}
+
+size_t InterleavedEliasGammaEncodedNPA::DeltaEncodedVectorSize(
+    DeltaEncodedVector *dv) {
+  if (dv == NULL)
+    return 0;
+  // The blocks are preceded by the padding that aligns them to a cache line,
+  // which depends on where they land; count the most it can take.
+  return sizeof(uint8_t) + sizeof(uint8_t)
+      + SuccinctBase::BitmapSize(dv->delta_offsets) + sizeof(uint64_t)
+      + (kWordsPerLine * sizeof(uint64_t) - 1)
+      + (dv->deltas->size / 64) * sizeof(uint64_t);
+}
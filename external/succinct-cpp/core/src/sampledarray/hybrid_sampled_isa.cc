@@ -0,0 +1,124 @@
+#include "sampledarray/hybrid_sampled_isa.h"
+
+HybridSampledISA::HybridSampledISA(uint32_t sampling_rate, NPA *npa,
+                                   ArrayStream& sa_stream, uint64_t sa_n,
+                                   bitmap_t *record_starts,
+                                   SuccinctAllocator &s_allocator)
+    : SampledByIndexISA(sampling_rate, SamplingScheme::HYBRID_SAMPLE_BY_INDEX,
+                        npa, s_allocator) {
+
+  this->original_size_ = sa_n;
+  Sample(sa_stream, sa_n);
+  sa_stream.Reset();
+  SampleRecords(sa_stream, sa_n, record_starts);
+
+}
+
+HybridSampledISA::HybridSampledISA(uint32_t sampling_rate, NPA *npa,
+                                   SuccinctAllocator &s_allocator)
+    : SampledByIndexISA(sampling_rate, SamplingScheme::HYBRID_SAMPLE_BY_INDEX,
+                        npa, s_allocator) {
+
+  this->record_starts_ = NULL;
+  this->record_samples_ = NULL;
+  this->record_sample_bits_ = 0;
+  this->num_records_ = 0;
+
+}
+
+void HybridSampledISA::SampleRecords(ArrayStream& sa_stream, uint64_t n,
+                                     bitmap_t *record_starts) {
+
+  record_starts_ = new Dictionary;
+  SuccinctBase::CreateDictionary(record_starts, record_starts_,
+                                 succinct_allocator_);
+  num_records_ = SuccinctBase::GetRank1(record_starts_, n - 1);
+  assert(num_records_ > 0);
+
+  record_sample_bits_ = SuccinctUtils::IntegerLog2(n + 1);
+  record_samples_ = new bitmap_t;
+  SuccinctBase::InitBitmap(&record_samples_, num_records_ * record_sample_bits_,
+                           succinct_allocator_);
+
+  for (uint64_t i = 0; i < n; i++) {
+    uint64_t sa_val = sa_stream.Get();
+    if (ACCESSBIT(record_starts, sa_val)) {
+      uint64_t record_idx = SuccinctBase::GetRank1(record_starts_, sa_val) - 1;
+      SuccinctBase::SetBitmapArray(&record_samples_, record_idx, i,
+                                   record_sample_bits_);
+    }
+  }
+}
+
+bool HybridSampledISA::IsRecordStart(uint64_t i) {
+  return
+      (i == 0) ?
+          SuccinctBase::GetRank1(record_starts_, i) :
+          SuccinctBase::GetRank1(record_starts_, i)
+              - SuccinctBase::GetRank1(record_starts_, i - 1);
+}
+
+uint64_t HybridSampledISA::operator [](uint64_t i) {
+
+  assert(i < original_size_);
+  if (i % sampling_rate_ != 0) {
+    uint64_t rank = SuccinctBase::GetRank1(record_starts_, i);
+    if (rank != SuccinctBase::GetRank1(record_starts_, i - 1)) {
+      return SuccinctBase::LookupBitmapArray(record_samples_, rank - 1,
+                                             record_sample_bits_);
+    }
+  }
+  return SampledByIndexISA::operator [](i);
+
+}
+
+size_t HybridSampledISA::SerializeRecordSamples(std::ostream& out) {
+  size_t out_size = 0;
+
+  out.write(reinterpret_cast<const char *>(&num_records_), sizeof(uint64_t));
+  out_size += sizeof(uint64_t);
+  out.write(reinterpret_cast<const char *>(&record_sample_bits_),
+            sizeof(uint8_t));
+  out_size += sizeof(uint8_t);
+
+  out_size += SuccinctBase::SerializeDictionary(record_starts_, out);
+  out_size += SuccinctBase::SerializeBitmap(record_samples_, out);
+
+  return out_size;
+}
+
+size_t HybridSampledISA::DeserializeRecordSamples(std::istream& in) {
+  size_t in_size = 0;
+
+  in.read(reinterpret_cast<char *>(&num_records_), sizeof(uint64_t));
+  in_size += sizeof(uint64_t);
+  in.read(reinterpret_cast<char *>(&record_sample_bits_), sizeof(uint8_t));
+  in_size += sizeof(uint8_t);
+
+  record_starts_ = new Dictionary;
+  in_size += SuccinctBase::DeserializeDictionary(record_starts_, in);
+  in_size += SuccinctBase::DeserializeBitmap(&record_samples_, in);
+
+  return in_size;
+}
+
+size_t HybridSampledISA::MemoryMapRecordSamples(std::string filename) {
+  uint8_t *data_buf, *data_beg;
+  data_buf = data_beg = (uint8_t *) SuccinctUtils::MemoryMap(filename);
+
+  num_records_ = *((uint64_t *) data_buf);
+  data_buf += sizeof(uint64_t);
+  record_sample_bits_ = *((uint8_t *) data_buf);
+  data_buf += sizeof(uint8_t);
+
+  data_buf += SuccinctBase::MemoryMapDictionary(&record_starts_, data_buf);
+  data_buf += SuccinctBase::MemoryMapBitmap(&record_samples_, data_buf);
+
+  return data_buf - data_beg;
+}
+
+size_t HybridSampledISA::StorageSize() {
+  return SampledByIndexISA::StorageSize() + sizeof(uint64_t) + sizeof(uint8_t)
+      + SuccinctBase::DictionarySize(record_starts_)
+      + SuccinctBase::BitmapSize(record_samples_);
+}
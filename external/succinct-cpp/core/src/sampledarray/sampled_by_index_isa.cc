@@ -23,6 +23,18 @@ SampledByIndexISA::SampledByIndexISA(uint32_t sampling_rate, NPA *npa,
 
 }
 
+SampledByIndexISA::SampledByIndexISA(uint32_t sampling_rate,
+                                     SamplingScheme scheme, NPA *npa,
+                                     SuccinctAllocator &s_allocator)
+    : FlatSampledArray(sampling_rate, scheme, npa, s_allocator) {
+
+  this->original_size_ = 0;
+  this->data_bits_ = 0;
+  this->data_size_ = 0;
+  this->data_ = NULL;
+
+}
+
 void SampledByIndexISA::Sample(ArrayStream& sa_stream, uint64_t n) {
 
   data_bits_ = SuccinctUtils::IntegerLog2(n + 1);
@@ -47,11 +59,7 @@ uint64_t SampledByIndexISA::operator [](uint64_t i) {
   uint64_t sample_idx = i / sampling_rate_;
   uint64_t sample = SuccinctBase::LookupBitmapArray(data_, sample_idx,
                                                     data_bits_);
-  uint64_t pos = sample;
   i -= (sample_idx * sampling_rate_);
-  while (i--) {
-    pos = (*npa_)[pos];
-  }
-  return pos;
+  return npa_->Advance(sample, i);
 
 }
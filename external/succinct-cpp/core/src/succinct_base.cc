@@ -276,7 +276,9 @@ size_t SuccinctBase::DeserializeBitmap(SuccinctBase::Bitmap **B,
     in_size += sizeof(uint64_t);
     (*B) = new Bitmap;
     (*B)->size = bitmap_size;
-    (*B)->bitmap = new uint64_t[BITS2BLOCKS(bitmap_size)];
+    // Through the allocator, so that large bitmaps get huge pages
+    (*B)->bitmap = (uint64_t *) SuccinctAllocator().s_malloc(
+        BITS2BLOCKS(bitmap_size) * sizeof(uint64_t));
     for (uint64_t i = 0; i < BITS2BLOCKS(bitmap_size); i++) {
       in.read(reinterpret_cast<char *>(&(*B)->bitmap[i]), sizeof(uint64_t));
       in_size += sizeof(uint64_t);
@@ -317,14 +319,14 @@ uint64_t SuccinctBase::CreateDictionary(SuccinctBase::Bitmap *B,
 
   D->size = B->size;
   D->B = new Bitmap;
-  D->rank_l3 = new uint64_t[l3_size];
-  D->pos_l3 = new uint64_t[l3_size];
+  D->rank_l3 = (uint64_t *) s_allocator.s_malloc(l3_size * sizeof(uint64_t));
+  D->pos_l3 = (uint64_t *) s_allocator.s_malloc(l3_size * sizeof(uint64_t));
   uint64_t *rank_l2 = new uint64_t[l2_size];
   uint64_t *rank_l1 = new uint64_t[l1_size];
   uint64_t *pos_l2 = new uint64_t[l2_size];
   uint64_t *pos_l1 = new uint64_t[l1_size];
-  D->rank_l12 = new uint64_t[l2_size];
-  D->pos_l12 = new uint64_t[l2_size];
+  D->rank_l12 = (uint64_t *) s_allocator.s_malloc(l2_size * sizeof(uint64_t));
+  D->pos_l12 = (uint64_t *) s_allocator.s_malloc(l2_size * sizeof(uint64_t));
 
   std::vector<uint16_t> dict;
   uint64_t sum_l1 = 0, sum_pos_l1 = 0, i, p, size = 0;
@@ -732,10 +734,13 @@ size_t SuccinctBase::DeserializeDictionary(Dictionary *D, std::istream& in) {
     in_size += sizeof(uint64_t);
     D->size = dictionary_size;
 
-    D->rank_l3 = new uint64_t[(D->size / L3BLKSIZE) + 1];
-    D->rank_l12 = new uint64_t[(D->size / L2BLKSIZE) + 1];
-    D->pos_l3 = new uint64_t[(D->size / L3BLKSIZE) + 1];
-    D->pos_l12 = new uint64_t[(D->size / L2BLKSIZE) + 1];
+    SuccinctAllocator s_allocator;
+    size_t l3_bytes = ((D->size / L3BLKSIZE) + 1) * sizeof(uint64_t);
+    size_t l12_bytes = ((D->size / L2BLKSIZE) + 1) * sizeof(uint64_t);
+    D->rank_l3 = (uint64_t *) s_allocator.s_malloc(l3_bytes);
+    D->rank_l12 = (uint64_t *) s_allocator.s_malloc(l12_bytes);
+    D->pos_l3 = (uint64_t *) s_allocator.s_malloc(l3_bytes);
+    D->pos_l12 = (uint64_t *) s_allocator.s_malloc(l12_bytes);
 
     for (uint64_t i = 0; i < (D->size / L3BLKSIZE) + 1; i++) {
       in.read(reinterpret_cast<char *>(&D->rank_l3[i]), sizeof(uint64_t));
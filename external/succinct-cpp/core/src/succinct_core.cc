@@ -1,5 +1,7 @@
 #include "succinct_core.h"
 
+#include <chrono>
+
 SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
                            uint32_t sa_sampling_rate,
                            uint32_t isa_sampling_rate,
@@ -7,7 +9,9 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
                            SamplingScheme sa_sampling_scheme,
                            SamplingScheme isa_sampling_scheme,
                            NPA::NPAEncodingScheme npa_encoding_scheme,
-                           uint32_t sampling_range)
+                           uint32_t sampling_range,
+                           const std::string& record_delimiters,
+                           LoadPolicy load_policy)
     : SuccinctBase() {
 
   this->alphabet_ = NULL;
@@ -18,11 +22,16 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
   this->input_size_ = 0;
   this->filename_ = std::string(filename);
   this->succinct_path_ = this->filename_ + ".succinct";
+  this->load_policy_ = load_policy;
+  this->load_stats_.policy = load_policy;
+  this->load_stats_.map_time_us = 0;
+  this->load_stats_.prefault_time_us = 0;
   switch (s_mode) {
     case SuccinctMode::CONSTRUCT_IN_MEMORY: {
       Construct(filename, sa_sampling_rate, isa_sampling_rate,
                 npa_sampling_rate, context_len, sa_sampling_scheme,
-                isa_sampling_scheme, npa_encoding_scheme, sampling_range);
+                isa_sampling_scheme, npa_encoding_scheme, sampling_range,
+                record_delimiters);
       break;
     }
     case SuccinctMode::CONSTRUCT_MEMORY_MAPPED: {
@@ -31,6 +40,9 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
       break;
     }
     case SuccinctMode::LOAD_IN_MEMORY: {
+      // The NPA and ISA may have been constructed with non-default schemes
+      npa_encoding_scheme = StoredNPAEncodingScheme(npa_encoding_scheme);
+      isa_sampling_scheme = StoredISASamplingScheme(isa_sampling_scheme);
       switch (npa_encoding_scheme) {
         case NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED:
           npa_ = new EliasGammaEncodedNPA(context_len, npa_sampling_rate,
@@ -40,6 +52,15 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
           npa_ = new EliasDeltaEncodedNPA(context_len, npa_sampling_rate,
                                           s_allocator);
           return;
+        case NPA::NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED:
+          npa_ = new InterleavedEliasGammaEncodedNPA(context_len,
+                                                     npa_sampling_rate,
+                                                     s_allocator);
+          break;
+        case NPA::NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED:
+          npa_ = new FrameOfReferenceEncodedNPA(context_len, npa_sampling_rate,
+                                                s_allocator);
+          break;
         case NPA::NPAEncodingScheme::WAVELET_TREE_ENCODED:
           npa_ = new WaveletTreeEncodedNPA(context_len, npa_sampling_rate,
                                            s_allocator);
@@ -92,6 +113,9 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
               isa_sampling_rate, isa_sampling_rate * sampling_range, npa_,
               s_allocator);
           break;
+        case SamplingScheme::HYBRID_SAMPLE_BY_INDEX:
+          isa_ = new HybridSampledISA(isa_sampling_rate, npa_, s_allocator);
+          break;
         default:
           isa_ = NULL;
       }
@@ -102,6 +126,9 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
       break;
     }
     case SuccinctMode::LOAD_MEMORY_MAPPED: {
+      // The NPA and ISA may have been constructed with non-default schemes
+      npa_encoding_scheme = StoredNPAEncodingScheme(npa_encoding_scheme);
+      isa_sampling_scheme = StoredISASamplingScheme(isa_sampling_scheme);
       switch (npa_encoding_scheme) {
         case NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED:
           npa_ = new EliasGammaEncodedNPA(context_len, npa_sampling_rate,
@@ -111,6 +138,15 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
           npa_ = new EliasDeltaEncodedNPA(context_len, npa_sampling_rate,
                                           s_allocator);
           return;
+        case NPA::NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED:
+          npa_ = new InterleavedEliasGammaEncodedNPA(context_len,
+                                                     npa_sampling_rate,
+                                                     s_allocator);
+          break;
+        case NPA::NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED:
+          npa_ = new FrameOfReferenceEncodedNPA(context_len, npa_sampling_rate,
+                                                s_allocator);
+          break;
         case NPA::NPAEncodingScheme::WAVELET_TREE_ENCODED:
           npa_ = new WaveletTreeEncodedNPA(context_len, npa_sampling_rate,
                                            s_allocator);
@@ -163,13 +199,16 @@ SuccinctCore::SuccinctCore(const char *filename, SuccinctMode s_mode,
               isa_sampling_rate, isa_sampling_rate * sampling_range, npa_,
               s_allocator);
           break;
+        case SamplingScheme::HYBRID_SAMPLE_BY_INDEX:
+          isa_ = new HybridSampledISA(isa_sampling_rate, npa_, s_allocator);
+          break;
         default:
           isa_ = NULL;
       }
 
       assert(isa_ != NULL);
 
-      MemoryMap();
+      MapWithLoadPolicy([this] {MemoryMap();});
       break;
     }
   }
@@ -183,7 +222,8 @@ void SuccinctCore::Construct(const char* filename, uint32_t sa_sampling_rate,
                              SamplingScheme sa_sampling_scheme,
                              SamplingScheme isa_sampling_scheme,
                              NPA::NPAEncodingScheme npa_encoding_scheme,
-                             uint32_t sampling_range) {
+                             uint32_t sampling_range,
+                             const std::string& record_delimiters) {
 
   std::string sa_file = std::string(filename) + ".tmp.sa";
   std::string isa_file = std::string(filename) + ".tmp.isa";
@@ -205,6 +245,19 @@ void SuccinctCore::Construct(const char* filename, uint32_t sa_sampling_rate,
   input_size_ = fsize + 1;
   uint32_t bits = SuccinctUtils::IntegerLog2(input_size_ + 1);
 
+  // Mark record starts (if needed)
+  Bitmap *record_starts;
+  if (isa_sampling_scheme == SamplingScheme::HYBRID_SAMPLE_BY_INDEX) {
+    record_starts = new Bitmap;
+    InitBitmap(&record_starts, input_size_, s_allocator);
+    SETBITVAL(record_starts, 0);
+    for (uint64_t i = 1; i < input_size_; i++) {
+      if (record_delimiters.find(data[i - 1]) != std::string::npos) {
+        SETBITVAL(record_starts, i);
+      }
+    }
+  }
+
   // Construct Suffix Array
   int64_t *lSA = (int64_t *) s_allocator.s_calloc(sizeof(int64_t), input_size_);
   divsufsortxx::constructSA((uint8_t *) data, (uint8_t *) (data + input_size_),
@@ -283,6 +336,20 @@ void SuccinctCore::Construct(const char* filename, uint32_t sa_sampling_rate,
                                       npa_file, s_allocator);
       return;
     }
+    case NPA::NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED: {
+      npa_ = new InterleavedEliasGammaEncodedNPA(input_size_, alphabet_size_,
+                                                 context_len, npa_sampling_rate,
+                                                 isa_file, col_offsets,
+                                                 npa_file, s_allocator);
+      break;
+    }
+    case NPA::NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED: {
+      npa_ = new FrameOfReferenceEncodedNPA(input_size_, alphabet_size_,
+                                            context_len, npa_sampling_rate,
+                                            isa_file, col_offsets, npa_file,
+                                            s_allocator);
+      break;
+    }
     case NPA::NPAEncodingScheme::WAVELET_TREE_ENCODED: {
       Bitmap *compactSA = ReadAsBitmap(input_size_, bits, s_allocator, sa_file);
       Bitmap *compactISA = ReadAsBitmap(input_size_, bits, s_allocator,
@@ -346,6 +413,11 @@ void SuccinctCore::Construct(const char* filename, uint32_t sa_sampling_rate,
           isa_sampling_rate, isa_sampling_rate * sampling_range, npa_,
           sa_stream, input_size_, s_allocator);
       break;
+    case SamplingScheme::HYBRID_SAMPLE_BY_INDEX:
+      isa_ = new HybridSampledISA(isa_sampling_rate, npa_, sa_stream,
+                                  input_size_, record_starts, s_allocator);
+      DestroyBitmap(&record_starts, s_allocator);
+      break;
     default:
       isa_ = NULL;
   }
@@ -430,6 +502,17 @@ size_t SuccinctCore::Serialize() {
   out_size += sa_->Serialize(sa_out);
   out_size += isa_->Serialize(isa_out);
 
+  // Record samples are kept in a separate file; its presence marks the
+  // hybrid sampling scheme on load.
+  if (isa_->GetSamplingScheme() == SamplingScheme::HYBRID_SAMPLE_BY_INDEX) {
+    std::ofstream isa_records_out(succinct_path_ + "/isa_records");
+    out_size += ((HybridSampledISA *) isa_)->SerializeRecordSamples(
+        isa_records_out);
+    isa_records_out.close();
+  } else {
+    remove((succinct_path_ + "/isa_records").c_str());
+  }
+
   if (sa_->GetSamplingScheme() == SamplingScheme::FLAT_SAMPLE_BY_VALUE) {
     assert(isa_->GetSamplingScheme() == SamplingScheme::FLAT_SAMPLE_BY_VALUE);
     out_size += SerializeDictionary(
@@ -446,6 +529,25 @@ size_t SuccinctCore::Serialize() {
   return out_size;
 }
 
+NPA::NPAEncodingScheme SuccinctCore::StoredNPAEncodingScheme(
+    NPA::NPAEncodingScheme default_scheme) {
+  // All NPA encodings serialize the encoding scheme as the first 64 bits
+  std::ifstream npa_in(succinct_path_ + "/npa");
+  uint64_t scheme;
+  npa_in.read(reinterpret_cast<char *>(&scheme), sizeof(uint64_t));
+  if (!npa_in.good())
+    return default_scheme;
+  return (NPA::NPAEncodingScheme) scheme;
+}
+
+SamplingScheme SuccinctCore::StoredISASamplingScheme(
+    SamplingScheme default_scheme) {
+  struct stat st;
+  if (stat((succinct_path_ + "/isa_records").c_str(), &st) == 0)
+    return SamplingScheme::HYBRID_SAMPLE_BY_INDEX;
+  return default_scheme;
+}
+
 size_t SuccinctCore::Deserialize() {
   // Check if directory exists
   struct stat st;
@@ -495,6 +597,12 @@ size_t SuccinctCore::Deserialize() {
   // Deserialize SA, ISA
   in_size += sa_->Deserialize(sa_in);
   in_size += isa_->Deserialize(isa_in);
+  if (isa_->GetSamplingScheme() == SamplingScheme::HYBRID_SAMPLE_BY_INDEX) {
+    std::ifstream isa_records_in(succinct_path_ + "/isa_records");
+    in_size += ((HybridSampledISA *) isa_)->DeserializeRecordSamples(
+        isa_records_in);
+    isa_records_in.close();
+  }
 
   // Deserialize bitmap marking positions of sampled values if the sampling scheme
   // is sample by value.
@@ -514,6 +622,13 @@ size_t SuccinctCore::Deserialize() {
     case NPA::NPAEncodingScheme::ELIAS_GAMMA_ENCODED:
       in_size += ((EliasGammaEncodedNPA *) npa_)->Deserialize(npa_in);
       break;
+    case NPA::NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED:
+      in_size += ((InterleavedEliasGammaEncodedNPA *) npa_)->Deserialize(
+          npa_in);
+      break;
+    case NPA::NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED:
+      in_size += ((FrameOfReferenceEncodedNPA *) npa_)->Deserialize(npa_in);
+      break;
     case NPA::NPAEncodingScheme::WAVELET_TREE_ENCODED:
       in_size += ((WaveletTreeEncodedNPA *) npa_)->Deserialize(npa_in);
       break;
@@ -570,6 +685,10 @@ size_t SuccinctCore::MemoryMap() {
   // Memory map SA and ISA
   data += sa_->MemoryMap(succinct_path_ + "/sa");
   data += isa_->MemoryMap(succinct_path_ + "/isa");
+  if (isa_->GetSamplingScheme() == SamplingScheme::HYBRID_SAMPLE_BY_INDEX) {
+    ((HybridSampledISA *) isa_)->MemoryMapRecordSamples(
+        succinct_path_ + "/isa_records");
+  }
 
   // Memory map bitmap marking positions of sampled values if the sampling scheme
   // is sample by value.
@@ -591,6 +710,14 @@ size_t SuccinctCore::MemoryMap() {
       data += ((EliasGammaEncodedNPA *) npa_)->MemoryMap(
           succinct_path_ + "/npa");
       break;
+    case NPA::NPAEncodingScheme::INTERLEAVED_ELIAS_GAMMA_ENCODED:
+      data += ((InterleavedEliasGammaEncodedNPA *) npa_)->MemoryMap(
+          succinct_path_ + "/npa");
+      break;
+    case NPA::NPAEncodingScheme::FRAME_OF_REFERENCE_ENCODED:
+      data += ((FrameOfReferenceEncodedNPA *) npa_)->MemoryMap(
+          succinct_path_ + "/npa");
+      break;
     case NPA::NPAEncodingScheme::WAVELET_TREE_ENCODED:
       data += ((WaveletTreeEncodedNPA *) npa_)->MemoryMap(
           succinct_path_ + "/npa");
@@ -619,6 +746,76 @@ size_t SuccinctCore::StorageSize() {
   return tot_size;
 }
 
+void SuccinctCore::MapWithLoadPolicy(std::function<void()> map_fn) {
+  typedef std::chrono::steady_clock Clock;
+  typedef std::chrono::microseconds Micros;
+
+  std::vector<SuccinctUtils::MappedRegion> regions;
+  SuccinctUtils::SetMappedRegionLog(&regions,
+                                    load_policy_ == LoadPolicy::EAGER);
+  Clock::time_point map_start = Clock::now();
+  map_fn();
+  load_stats_.map_time_us += std::chrono::duration_cast<Micros>(
+      Clock::now() - map_start).count();
+  SuccinctUtils::SetMappedRegionLog(NULL);
+
+  uint32_t num_threads = 1;
+  if (load_policy_ == LoadPolicy::EAGER_PARALLEL
+      || load_policy_ == LoadPolicy::HOT_SET) {
+    num_threads = SuccinctUtils::Max(std::thread::hardware_concurrency(), 1);
+  }
+
+  for (auto& region : regions) {
+    ComponentLoadStats component;
+    component.component = region.filename.substr(
+        region.filename.rfind('/') + 1);
+    component.size = region.size;
+    component.prefault_time_us = 0;
+
+    // SA samples are only accessed by search; every other component is on
+    // the path of every extract.
+    switch (load_policy_) {
+      case LoadPolicy::EAGER_PARALLEL:
+        component.prefaulted = true;
+        break;
+      case LoadPolicy::HOT_SET:
+        component.prefaulted = (component.component != "sa");
+        break;
+      default:
+        component.prefaulted = false;
+    }
+
+    if (component.prefaulted) {
+      Clock::time_point prefault_start = Clock::now();
+      SuccinctUtils::Prefault(region.data, region.size, num_threads);
+      component.prefault_time_us = std::chrono::duration_cast<Micros>(
+          Clock::now() - prefault_start).count();
+      load_stats_.prefault_time_us += component.prefault_time_us;
+    }
+
+    // Accesses to all components are random once loaded
+    madvise(region.data, region.size, MADV_RANDOM);
+    load_stats_.components.push_back(component);
+  }
+}
+
+const SuccinctCore::LoadStats& SuccinctCore::GetLoadStats() {
+  return load_stats_;
+}
+
+void SuccinctCore::PrintLoadStats() {
+  fprintf(stderr,
+          "Load policy = %d, map time = %llu us, prefault time = %llu us\n",
+          static_cast<int>(load_stats_.policy),
+          (unsigned long long) load_stats_.map_time_us,
+          (unsigned long long) load_stats_.prefault_time_us);
+  for (auto& component : load_stats_.components) {
+    fprintf(stderr, "  %s: size = %zu, prefaulted = %d, time = %llu us\n",
+            component.component.c_str(), component.size, component.prefaulted,
+            (unsigned long long) component.prefault_time_us);
+  }
+}
+
 void SuccinctCore::PrintStorageBreakdown() {
   size_t metadata_size = SuccinctBase::StorageSize();
   metadata_size += sizeof(uint64_t);
@@ -7,11 +7,13 @@ SuccinctFile::SuccinctFile(std::string filename, SuccinctMode s_mode,
                            SamplingScheme sa_sampling_scheme,
                            SamplingScheme isa_sampling_scheme,
                            NPA::NPAEncodingScheme npa_encoding_scheme,
-                           uint32_t context_len, uint32_t sampling_range)
+                           uint32_t context_len, uint32_t sampling_range,
+                           const std::string& record_delimiters,
+                           LoadPolicy load_policy)
     : SuccinctCore(filename.c_str(), s_mode, sa_sampling_rate,
                    isa_sampling_rate, npa_sampling_rate, context_len,
                    sa_sampling_scheme, isa_sampling_scheme, npa_encoding_scheme,
-                   sampling_range) {
+                   sampling_range, record_delimiters, load_policy) {
   this->input_filename_ = filename;
   this->succinct_filename_ = filename + ".succinct";
 }
@@ -164,12 +166,9 @@ std::string SuccinctFile::Name() {
 }
 
 void SuccinctFile::Extract(std::string& result, uint64_t offset, uint64_t len) {
-  result.resize(len);
-  uint64_t idx = LookupISA(offset);
-  for (uint64_t k = 0; k < len; k++) {
-    result[k] = alphabet_[LookupC(idx)];
-    idx = LookupNPA(idx);
-  }
+  result.clear();
+  result.reserve(len);
+  npa_->Walk(LookupISA(offset), len, alphabet_, &result);
 }
 
 uint64_t SuccinctFile::Count(const std::string& str) {
@@ -201,17 +200,9 @@ int64_t SuccinctFile::ExtractUntil(
     char end_char) {
 
     result.clear();
-    uint32_t k = 1;
-    uint64_t idx = LookupISA(offset);
-    char curr_char = alphabet_[LookupC(idx)];
-    while (curr_char != end_char) {
-        ++k;
-        result += curr_char;
-
-        idx = LookupNPA(idx);
-        curr_char = alphabet_[LookupC(idx)];
-    }
-    return offset + k;
+    npa_->Walk(LookupISA(offset), -1ULL, alphabet_, &result,
+               (unsigned char) end_char);
+    return offset + result.size() + 1;
 }
 
 void SuccinctFile::Extract(
@@ -220,13 +211,10 @@ void SuccinctFile::Extract(
     uint64_t offset,
     uint64_t len) {
 
-    result = "";
-    uint64_t idx = suf_arr_idx;
-    for (uint64_t k = 0;  k < len; k++) {
-        result += alphabet_[LookupC(idx)];
-        idx = LookupNPA(idx);
-    }
-    suf_arr_idx = idx; // points to next char past len
+    result.clear();
+    result.reserve(len);
+    // points to next char past len
+    suf_arr_idx = npa_->Walk(suf_arr_idx, len, alphabet_, &result);
 }
 
 int64_t SuccinctFile::SkippingExtractUntil(
@@ -253,16 +241,9 @@ int64_t SuccinctFile::ExtractUntil(
     char end_char)
 {
     result.clear();
-    uint32_t k = 1;
     uint64_t idx = (suf_arr_idx == -1ULL) ? LookupISA(offset) : suf_arr_idx;
-    char curr_char = alphabet_[LookupC(idx)];
-    while (curr_char != end_char) {
-        ++k;
-        result += curr_char;
-
-        idx = LookupNPA(idx);
-        curr_char = alphabet_[LookupC(idx)];
-    }
-    suf_arr_idx = LookupNPA(idx); // points to next
-    return offset + k;
+    // points to next char past `end_char`
+    suf_arr_idx = npa_->Walk(idx, -1ULL, alphabet_, &result,
+                             (unsigned char) end_char);
+    return offset + result.size() + 1;
 }
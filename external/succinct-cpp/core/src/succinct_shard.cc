@@ -7,11 +7,13 @@ SuccinctShard::SuccinctShard(uint32_t id, std::string filename,
                              SamplingScheme sa_sampling_scheme,
                              SamplingScheme isa_sampling_scheme,
                              NPA::NPAEncodingScheme npa_encoding_scheme,
-                             uint32_t context_len, uint32_t sampling_range)
+                             uint32_t context_len, uint32_t sampling_range,
+                             const std::string& record_delimiters,
+                             LoadPolicy load_policy)
     : SuccinctCore(filename.c_str(), s_mode, sa_sampling_rate,
                    isa_sampling_rate, npa_sampling_rate, context_len,
                    sa_sampling_scheme, isa_sampling_scheme, npa_encoding_scheme,
-                   sampling_range) {
+                   sampling_range, record_delimiters, load_policy) {
 
   this->id_ = id;
 
@@ -63,29 +65,32 @@ SuccinctShard::SuccinctShard(uint32_t id, std::string filename,
       break;
     }
     case SuccinctMode::LOAD_MEMORY_MAPPED: {
-      uint8_t *data, *data_beg;
-      data = data_beg = (uint8_t *) SuccinctUtils::MemoryMapMutable(
-          succinct_path_ + "/keyval");
-
-      // Read keys
-      size_t keys_size = *((size_t *) data);
-      data += sizeof(size_t);
-      buf_allocator<int64_t> key_allocator((int64_t *) data);
-      keys_ = std::vector<int64_t>((int64_t *) data,
-                                   (int64_t *) data + keys_size, key_allocator);
-      data += (sizeof(int64_t) * keys_size);
-
-      // Read values
-      size_t value_offsets_size = *((size_t *) data);
-      data += sizeof(size_t);
-      buf_allocator<int64_t> value_offsets_allocator((int64_t *) data);
-      value_offsets_ = std::vector<int64_t>(
-          (int64_t *) data, (int64_t *) data + value_offsets_size,
-          value_offsets_allocator);
-      data += (sizeof(int64_t) * value_offsets_size);
-
-      // Read bitmap
-      data += SuccinctBase::MemoryMapBitmap(&invalid_offsets_, data);
+      MapWithLoadPolicy([this] {
+        uint8_t *data, *data_beg;
+        data = data_beg = (uint8_t *) SuccinctUtils::MemoryMapMutable(
+            succinct_path_ + "/keyval");
+
+        // Read keys
+        size_t keys_size = *((size_t *) data);
+        data += sizeof(size_t);
+        buf_allocator<int64_t> key_allocator((int64_t *) data);
+        keys_ = std::vector<int64_t>((int64_t *) data,
+                                     (int64_t *) data + keys_size,
+                                     key_allocator);
+        data += (sizeof(int64_t) * keys_size);
+
+        // Read values
+        size_t value_offsets_size = *((size_t *) data);
+        data += sizeof(size_t);
+        buf_allocator<int64_t> value_offsets_allocator((int64_t *) data);
+        value_offsets_ = std::vector<int64_t>(
+            (int64_t *) data, (int64_t *) data + value_offsets_size,
+            value_offsets_allocator);
+        data += (sizeof(int64_t) * value_offsets_size);
+
+        // Read bitmap
+        data += SuccinctBase::MemoryMapBitmap(&invalid_offsets_, data);
+      });
       break;
     }
   }
@@ -274,12 +279,9 @@ int64_t SuccinctShard::Count(const std::string& str) {
 
 void SuccinctShard::FlatExtract(std::string& result, int64_t offset,
                                 int64_t len) {
-  result = "";
-  uint64_t idx = LookupISA(offset);
-  for (uint64_t k = 0; k < len; k++) {
-    result += alphabet_[LookupC(idx)];
-    idx = LookupNPA(idx);
-  }
+  result.clear();
+  result.reserve(len);
+  npa_->Walk(LookupISA(offset), len, alphabet_, &result);
 }
 
 int64_t SuccinctShard::FlatCount(const std::string& str) {
@@ -313,15 +315,9 @@ int64_t SuccinctShard::ExtractUntil(std::string& result, uint64_t& suf_arr_idx,
     idx = LookupISA(pos);
   }
 
-  char curr_char = alphabet_[LookupC(idx)];
-  while (curr_char != end_char) {
-    result += curr_char;
-    ++pos;
-    idx = LookupNPA(idx);
-    curr_char = alphabet_[LookupC(idx)];
-  }
-  suf_arr_idx = LookupNPA(idx);
-  ++pos;
+  suf_arr_idx = npa_->Walk(idx, -1ULL, alphabet_, &result,
+                           (unsigned char) end_char);
+  pos += result.size() + 1;
   return pos;
 }
 
@@ -329,13 +325,8 @@ void SuccinctShard::ExtractUntilHint(std::string& result, uint64_t& suf_arr_idx,
                                      int64_t raw_offset, char end_char) {
   result.clear();
   uint64_t idx = (suf_arr_idx == -1) ? LookupISA(raw_offset) : suf_arr_idx;
-  char curr_char = alphabet_[LookupC(idx)];
-  while (curr_char != end_char) {
-    result += curr_char;
-    idx = LookupNPA(idx);
-    curr_char = alphabet_[LookupC(idx)];
-  }
-  suf_arr_idx = LookupNPA(idx);
+  suf_arr_idx = npa_->Walk(idx, -1ULL, alphabet_, &result,
+                           (unsigned char) end_char);
 }
 
 bool SuccinctShard::ExtractCompareUntil(int64_t raw_offset, char end_char,
@@ -356,18 +347,9 @@ bool SuccinctShard::ExtractCompareUntil(int64_t raw_offset, char end_char,
 
 void SuccinctShard::ExtractUntil(std::string& result, int64_t raw_offset,
                                  char end_char) {
-  uint64_t idx = LookupISA(raw_offset);
-  char curr_char;
   result.clear();
-
-  for (;;) {
-    curr_char = alphabet_[LookupC(idx)];
-    idx = LookupNPA(idx);
-    if (curr_char == end_char) {
-      break;
-    }
-    result += curr_char;
-  }
+  npa_->Walk(LookupISA(raw_offset), -1ULL, alphabet_, &result,
+             (unsigned char) end_char);
 }
 
 size_t SuccinctShard::Serialize() {
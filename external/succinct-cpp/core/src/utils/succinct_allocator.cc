@@ -1,5 +1,39 @@
 #include "utils/succinct_allocator.h"
 
+#include <malloc.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::atomic<int> hugepage_policy(NO_HUGEPAGES);
+
+// Blocks mapped from the hugetlbfs pool, with their mapped sizes; every
+// other block came from malloc or posix_memalign.
+std::mutex explicit_blocks_mutex;
+std::map<void*, size_t>& ExplicitBlocks() {
+  static std::map<void*, size_t> *blocks = new std::map<void*, size_t>();
+  return *blocks;
+}
+
+// Returns the mapped size of ptr if it came from the hugetlbfs pool, else 0
+size_t ExplicitBlockSize(void *ptr) {
+  std::lock_guard<std::mutex> lk(explicit_blocks_mutex);
+  std::map<void*, size_t>::iterator it = ExplicitBlocks().find(ptr);
+  return it == ExplicitBlocks().end() ? 0 : it->second;
+}
+
+size_t RoundUpToHugePage(size_t size) {
+  const size_t page = SuccinctAllocator::kHugePageSize;
+  return (size + page - 1) / page * page;
+}
+
+}
+
 /*
  * Constructor
  *
@@ -8,23 +42,76 @@ SuccinctAllocator::SuccinctAllocator(bool s_use_hugepages) {
   this->use_hugepages_ = s_use_hugepages;
 }
 
+void SuccinctAllocator::SetHugePagePolicy(HugePagePolicy policy) {
+  hugepage_policy = policy;
+}
+
+HugePagePolicy SuccinctAllocator::GetHugePagePolicy() {
+  return (HugePagePolicy) hugepage_policy.load();
+}
+
 /*
  * Enable the use of huge pages.
  *
  */
 bool SuccinctAllocator::UseHugePages() {
-  use_hugepages_ = false;
+  use_hugepages_ = true;
   return use_hugepages_;
 }
 
+/*
+ * Huge pages are used for blocks of at least a huge page, under the process
+ * wide policy, or transparently if this allocator has them enabled.
+ *
+ */
+HugePagePolicy SuccinctAllocator::PolicyFor(size_t size) {
+  if (size < kHugePageSize) {
+    return NO_HUGEPAGES;
+  }
+  HugePagePolicy policy = GetHugePagePolicy();
+  if (policy == NO_HUGEPAGES && use_hugepages_) {
+    return TRANSPARENT_HUGEPAGES;
+  }
+  return policy;
+}
+
+void* SuccinctAllocator::HugePageAlloc(size_t size, HugePagePolicy policy) {
+  size_t mapped_size = RoundUpToHugePage(size);
+#ifdef MAP_HUGETLB
+  if (policy == EXPLICIT_HUGEPAGES) {
+    void *data = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      std::lock_guard<std::mutex> lk(explicit_blocks_mutex);
+      ExplicitBlocks()[data] = mapped_size;
+      return data;
+    }
+    static std::once_flag warned;
+    std::call_once(warned, [] {
+      fprintf(stderr, "hugetlbfs pool exhausted or not configured (see "
+              "vm.nr_hugepages); using transparent huge pages\n");
+    });
+  }
+#endif
+  void *data = NULL;
+  if (posix_memalign(&data, kHugePageSize, mapped_size) != 0) {
+    return NULL;
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(data, mapped_size, MADV_HUGEPAGE);
+#endif
+  return data;
+}
+
 /*
  * Allocates a block of size bytes of memory, returning a pointer to the
  * beginning of the block.
  *
  */
 void* SuccinctAllocator::s_malloc(size_t size) {
-  if (use_hugepages_) {
-    return 0;
+  HugePagePolicy policy = PolicyFor(size);
+  if (policy != NO_HUGEPAGES) {
+    return HugePageAlloc(size, policy);
   }
   return malloc(size);
 }
@@ -35,21 +122,50 @@ void* SuccinctAllocator::s_malloc(size_t size) {
  *
  */
 void* SuccinctAllocator::s_calloc(size_t num, size_t size) {
-  if (use_hugepages_) {
-    return 0;
+  HugePagePolicy policy = PolicyFor(num * size);
+  if (policy != NO_HUGEPAGES) {
+    void *data = HugePageAlloc(num * size, policy);
+    if (data != NULL) {
+      memset(data, 0, num * size);
+    }
+    return data;
   }
   return calloc(num, size);
 }
 
+void* SuccinctAllocator::s_memalign(size_t alignment, size_t size) {
+  HugePagePolicy policy = PolicyFor(size);
+  if (policy != NO_HUGEPAGES) {
+    return HugePageAlloc(size, policy);
+  }
+  void *data = NULL;
+  if (posix_memalign(&data, alignment, size) != 0) {
+    return NULL;
+  }
+  return data;
+}
+
 /*
  * Changes the size of the memory block pointed to by ptr.
  *
  */
 void* SuccinctAllocator::s_realloc(void* ptr, size_t size) {
-  if (use_hugepages_) {
-    return 0;
+  if (ptr == NULL) {
+    return s_malloc(size);
+  }
+  size_t old_size = ExplicitBlockSize(ptr);
+  if (old_size == 0 && PolicyFor(size) == NO_HUGEPAGES) {
+    return realloc(ptr, size);
+  }
+  if (old_size == 0) {
+    old_size = malloc_usable_size(ptr);
   }
-  return realloc(ptr, size);
+  void *data = s_malloc(size);
+  if (data != NULL) {
+    memcpy(data, ptr, old_size < size ? old_size : size);
+    s_free(ptr);
+  }
+  return data;
 }
 
 /*
@@ -59,7 +175,16 @@ void* SuccinctAllocator::s_realloc(void* ptr, size_t size) {
  *
  */
 void SuccinctAllocator::s_free(void* ptr) {
-  if (use_hugepages_) {
+  if (ptr == NULL) {
+    return;
+  }
+  size_t mapped_size = ExplicitBlockSize(ptr);
+  if (mapped_size != 0) {
+    {
+      std::lock_guard<std::mutex> lk(explicit_blocks_mutex);
+      ExplicitBlocks().erase(ptr);
+    }
+    munmap(ptr, mapped_size);
     return;
   }
   free(ptr);
@@ -71,8 +196,5 @@ void SuccinctAllocator::s_free(void* ptr) {
  *
  */
 void *SuccinctAllocator::s_memset(void *ptr, int value, size_t num) {
-  if (use_hugepages_) {
-    return 0;
-  }
   return memset(ptr, value, num);
 }
@@ -71,6 +71,8 @@ class GraphQueryAggregatorServiceIf {
   virtual void getFilteredLinkList(std::vector<ThriftAssoc> & _return, const int64_t id1, const int64_t link_type, const int64_t min_timestamp, const int64_t max_timestamp, const int64_t offset, const int64_t limit) = 0;
   virtual void getFilteredLinkListLocal(std::vector<ThriftAssoc> & _return, const int64_t shard_id, const int64_t id1, const int64_t link_type, const int64_t min_timestamp, const int64_t max_timestamp, const int64_t offset, const int64_t limit) = 0;
   virtual int64_t countLinks(const int64_t id1, const int64_t link_type) = 0;
+  virtual void get_stats(std::string& _return) = 0;
+  virtual void trace_next(const int64_t trace_id) = 0;
 };
 
 class GraphQueryAggregatorServiceIfFactory {
@@ -265,6 +267,12 @@ class GraphQueryAggregatorServiceNull : virtual public GraphQueryAggregatorServi
     int64_t _return = 0;
     return _return;
   }
+  void get_stats(std::string& /* _return */) {
+    return;
+  }
+  void trace_next(const int64_t /* trace_id */) {
+    return;
+  }
 };
 
 
@@ -5984,6 +5992,147 @@ class GraphQueryAggregatorService_countLinks_presult {
 
 };
 
+class GraphQueryAggregatorService_get_stats_args {
+ public:
+
+  GraphQueryAggregatorService_get_stats_args(const GraphQueryAggregatorService_get_stats_args&);
+  GraphQueryAggregatorService_get_stats_args& operator=(const GraphQueryAggregatorService_get_stats_args&);
+  GraphQueryAggregatorService_get_stats_args() {
+  }
+
+  virtual ~GraphQueryAggregatorService_get_stats_args() throw();
+
+  bool operator == (const GraphQueryAggregatorService_get_stats_args & /* rhs */) const
+  {
+    return true;
+  }
+  bool operator != (const GraphQueryAggregatorService_get_stats_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const GraphQueryAggregatorService_get_stats_args & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+
+class GraphQueryAggregatorService_get_stats_pargs {
+ public:
+
+
+  virtual ~GraphQueryAggregatorService_get_stats_pargs() throw();
+
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+typedef struct _GraphQueryAggregatorService_get_stats_result__isset {
+  _GraphQueryAggregatorService_get_stats_result__isset() : success(false) {}
+  bool success :1;
+} _GraphQueryAggregatorService_get_stats_result__isset;
+
+class GraphQueryAggregatorService_get_stats_result {
+ public:
+
+  GraphQueryAggregatorService_get_stats_result(const GraphQueryAggregatorService_get_stats_result&);
+  GraphQueryAggregatorService_get_stats_result& operator=(const GraphQueryAggregatorService_get_stats_result&);
+  GraphQueryAggregatorService_get_stats_result() : success() {
+  }
+
+  virtual ~GraphQueryAggregatorService_get_stats_result() throw();
+  std::string success;
+
+  _GraphQueryAggregatorService_get_stats_result__isset __isset;
+
+  void __set_success(const std::string& val);
+
+  bool operator == (const GraphQueryAggregatorService_get_stats_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    return true;
+  }
+  bool operator != (const GraphQueryAggregatorService_get_stats_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const GraphQueryAggregatorService_get_stats_result & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+typedef struct _GraphQueryAggregatorService_get_stats_presult__isset {
+  _GraphQueryAggregatorService_get_stats_presult__isset() : success(false) {}
+  bool success :1;
+} _GraphQueryAggregatorService_get_stats_presult__isset;
+
+class GraphQueryAggregatorService_get_stats_presult {
+ public:
+
+
+  virtual ~GraphQueryAggregatorService_get_stats_presult() throw();
+  std::string* success;
+
+  _GraphQueryAggregatorService_get_stats_presult__isset __isset;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+
+};
+
+
+typedef struct _GraphQueryAggregatorService_trace_next_args__isset {
+  _GraphQueryAggregatorService_trace_next_args__isset() : trace_id(false) {}
+  bool trace_id :1;
+} _GraphQueryAggregatorService_trace_next_args__isset;
+
+class GraphQueryAggregatorService_trace_next_args {
+ public:
+
+  GraphQueryAggregatorService_trace_next_args(const GraphQueryAggregatorService_trace_next_args&);
+  GraphQueryAggregatorService_trace_next_args& operator=(const GraphQueryAggregatorService_trace_next_args&);
+  GraphQueryAggregatorService_trace_next_args() : trace_id(0) {
+  }
+
+  virtual ~GraphQueryAggregatorService_trace_next_args() throw();
+  int64_t trace_id;
+
+  _GraphQueryAggregatorService_trace_next_args__isset __isset;
+
+  void __set_trace_id(const int64_t val);
+
+  bool operator == (const GraphQueryAggregatorService_trace_next_args & rhs) const
+  {
+    if (!(trace_id == rhs.trace_id))
+      return false;
+    return true;
+  }
+  bool operator != (const GraphQueryAggregatorService_trace_next_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const GraphQueryAggregatorService_trace_next_args & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+
+class GraphQueryAggregatorService_trace_next_pargs {
+ public:
+
+
+  virtual ~GraphQueryAggregatorService_trace_next_pargs() throw();
+  const int64_t* trace_id;
+
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
 class GraphQueryAggregatorServiceClient : virtual public GraphQueryAggregatorServiceIf {
  public:
   GraphQueryAggregatorServiceClient(boost::shared_ptr< ::apache::thrift::protocol::TProtocol> prot) {
@@ -6159,6 +6308,11 @@ class GraphQueryAggregatorServiceClient : virtual public GraphQueryAggregatorSer
   int64_t countLinks(const int64_t id1, const int64_t link_type);
   void send_countLinks(const int64_t id1, const int64_t link_type);
   int64_t recv_countLinks();
+  void get_stats(std::string& _return);
+  void send_get_stats();
+  void recv_get_stats(std::string& _return);
+  void trace_next(const int64_t trace_id);
+  void send_trace_next(const int64_t trace_id);
  protected:
   boost::shared_ptr< ::apache::thrift::protocol::TProtocol> piprot_;
   boost::shared_ptr< ::apache::thrift::protocol::TProtocol> poprot_;
@@ -6224,6 +6378,8 @@ class GraphQueryAggregatorServiceProcessor : public ::apache::thrift::TDispatchP
   void process_getFilteredLinkList(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_getFilteredLinkListLocal(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_countLinks(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
+  void process_get_stats(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
+  void process_trace_next(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
  public:
   GraphQueryAggregatorServiceProcessor(boost::shared_ptr<GraphQueryAggregatorServiceIf> iface) :
     iface_(iface) {
@@ -6277,6 +6433,8 @@ class GraphQueryAggregatorServiceProcessor : public ::apache::thrift::TDispatchP
     processMap_["getFilteredLinkList"] = &GraphQueryAggregatorServiceProcessor::process_getFilteredLinkList;
     processMap_["getFilteredLinkListLocal"] = &GraphQueryAggregatorServiceProcessor::process_getFilteredLinkListLocal;
     processMap_["countLinks"] = &GraphQueryAggregatorServiceProcessor::process_countLinks;
+    processMap_["get_stats"] = &GraphQueryAggregatorServiceProcessor::process_get_stats;
+    processMap_["trace_next"] = &GraphQueryAggregatorServiceProcessor::process_trace_next;
   }
 
   virtual ~GraphQueryAggregatorServiceProcessor() {}
@@ -6786,6 +6944,25 @@ class GraphQueryAggregatorServiceMultiface : virtual public GraphQueryAggregator
     return ifaces_[i]->countLinks(id1, link_type);
   }
 
+  void get_stats(std::string& _return) {
+    size_t sz = ifaces_.size();
+    size_t i = 0;
+    for (; i < (sz - 1); ++i) {
+      ifaces_[i]->get_stats(_return);
+    }
+    ifaces_[i]->get_stats(_return);
+    return;
+  }
+
+  void trace_next(const int64_t trace_id) {
+    size_t sz = ifaces_.size();
+    size_t i = 0;
+    for (; i < (sz - 1); ++i) {
+      ifaces_[i]->trace_next(trace_id);
+    }
+    ifaces_[i]->trace_next(trace_id);
+  }
+
 };
 
 // The 'concurrent' client is a thread safe client that correctly handles
@@ -6966,6 +7143,11 @@ class GraphQueryAggregatorServiceConcurrentClient : virtual public GraphQueryAgg
   int64_t countLinks(const int64_t id1, const int64_t link_type);
   int32_t send_countLinks(const int64_t id1, const int64_t link_type);
   int64_t recv_countLinks(const int32_t seqid);
+  void get_stats(std::string& _return);
+  int32_t send_get_stats();
+  void recv_get_stats(std::string& _return, const int32_t seqid);
+  void trace_next(const int64_t trace_id);
+  void send_trace_next(const int64_t trace_id);
  protected:
   boost::shared_ptr< ::apache::thrift::protocol::TProtocol> piprot_;
   boost::shared_ptr< ::apache::thrift::protocol::TProtocol> poprot_;
@@ -2,86 +2,504 @@
 #define ASYNC_THREAD_POOL_H
 
 #include <vector>
-#include <queue>
+#include <map>
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <type_traits>
+#include <cstddef>
 
+#include "Numa.h"
+#include "Trace.h"
+
+// Priority classes of pool tasks: workers run pending HIGH tasks before
+// NORMAL ones, and NORMAL before LOW, so cheap point reads are not queued
+// behind scans.  In a NUMA-aware pool this holds per node: a worker runs the
+// NORMAL tasks of its own node before it steals HIGH ones from another.
+enum class TaskPriority {
+  HIGH = 0,
+  NORMAL = 1,
+  LOW = 2
+};
+
+// Work-stealing pool: every worker owns one queue per priority class.  A
+// task goes to the queue of the worker its affinity hint maps to (e.g. its
+// shard, so a shard's data stays warm in one core's caches), or round-robin
+// without a hint.  Workers run their own tasks oldest first, and steal the
+// newest tasks of other workers when they run out, so a burst on one shard
+// still spreads over all workers.  Each worker's queues have their own lock,
+// and a count per priority that is read without it, so that a worker looking
+// for tasks only locks queues that have some; the shared idle lock is only
+// taken to put a worker to sleep or wake it.
+//
+// A NUMA-aware pool spreads its workers over the NUMA nodes and pins each to
+// its node's CPUs; workers steal from the workers of their own node before
+// those of other nodes.
 class AsyncThreadPool {
  public:
-  AsyncThreadPool(size_t);
+  static const int NO_AFFINITY = -1;
+
+  explicit AsyncThreadPool(size_t threads, bool numa_aware = false);
+
+  // Affinity hint for the tasks of `key` (e.g. a shard id) whose data lives
+  // on NUMA node `node`: one of the workers pinned to that node, or just
+  // `key` if the pool is not NUMA-aware or `node` is -1.
+  int affinity_for(int node, int key) const;
+
   template<class F, class ... Args>
   auto enqueue(F&& f, Args&&... args)
   -> std::future<typename std::result_of<F(Args...)>::type>;
+
+  // As enqueue(), in priority class `priority`, preferably on the worker
+  // `affinity` maps to.
+  template<class F, class ... Args>
+  auto enqueue_with(TaskPriority priority, int affinity, F&& f,
+                    Args&&... args)
+  -> std::future<typename std::result_of<F(Args...)>::type>;
+
   ~AsyncThreadPool();
+
  private:
+  static const int NUM_PRIORITIES = 3;
+
+  // Callable and promise of a task, in place of a packaged_task behind a
+  // shared_ptr behind a std::function.
+  template<class R, class F>
+  struct TaskBody {
+    explicit TaskBody(F&& f)
+        : f_(std::move(f)) {
+    }
+    void run() {
+      run_and_set(promise_, f_);
+    }
+    F f_;
+    std::promise<R> promise_;
+  };
+
+  template<class R, class F>
+  static void run_and_set(std::promise<R>& promise, F& f) {
+    try {
+      promise.set_value(f());
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  }
+
+  template<class F>
+  static void run_and_set(std::promise<void>& promise, F& f) {
+    try {
+      f();
+      promise.set_value();
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  }
+
+  // Type-erased, move-only task.  Its body is stored inline when it fits in
+  // kInlineBytes, as that of a lambda capturing a few values does, and on
+  // the heap otherwise; queues hold tasks by value, so the common task is
+  // not allocated on its own.
+  class Task {
+   public:
+    static const size_t kInlineBytes = 128;
+
+    Task()
+        : ops_(nullptr) {
+    }
+
+    Task(Task&& other)
+        : ops_(other.ops_) {
+      if (ops_ != nullptr) {
+        ops_->move(&other.storage_, &storage_);
+        other.ops_ = nullptr;
+      }
+    }
+
+    Task& operator=(Task&& other) {
+      if (this != &other) {
+        reset();
+        ops_ = other.ops_;
+        if (ops_ != nullptr) {
+          ops_->move(&other.storage_, &storage_);
+          other.ops_ = nullptr;
+        }
+      }
+      return *this;
+    }
+
+    ~Task() {
+      reset();
+    }
+
+    // Replaces the body with a Body constructed from `args`.
+    template<class Body, class ... Args>
+    Body& emplace(Args&&... args) {
+      reset();
+      return emplace<Body>(std::integral_constant<bool, fits<Body>()>(),
+                           std::forward<Args>(args)...);
+    }
+
+    void run() {
+      ops_->run(&storage_);
+    }
+
+    bool empty() const {
+      return ops_ == nullptr;
+    }
+
+   private:
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    typedef std::aligned_storage<kInlineBytes,
+        alignof(std::max_align_t)>::type Storage;
+
+    struct Ops {
+      void (*run)(void* storage);
+      // Moves the body from one storage into the other, which is empty, and
+      // leaves the first empty.
+      void (*move)(void* from, void* to);
+      void (*destroy)(void* storage);
+    };
+
+    template<class Body>
+    struct InlineOps {
+      static void run(void* storage) {
+        static_cast<Body*>(storage)->run();
+      }
+      static void move(void* from, void* to) {
+        Body* body = static_cast<Body*>(from);
+        new (to) Body(std::move(*body));
+        body->~Body();
+      }
+      static void destroy(void* storage) {
+        static_cast<Body*>(storage)->~Body();
+      }
+      static const Ops ops;
+    };
+
+    template<class Body>
+    struct HeapOps {
+      static Body*& body(void* storage) {
+        return *static_cast<Body**>(storage);
+      }
+      static void run(void* storage) {
+        body(storage)->run();
+      }
+      static void move(void* from, void* to) {
+        new (to) Body*(body(from));
+      }
+      static void destroy(void* storage) {
+        delete body(storage);
+      }
+      static const Ops ops;
+    };
+
+    template<class Body>
+    static constexpr bool fits() {
+      return sizeof(Body) <= sizeof(Storage)
+          && alignof(Body) <= alignof(Storage);
+    }
+
+    template<class Body, class ... Args>
+    Body& emplace(std::true_type, Args&&... args) {
+      Body* body = new (&storage_) Body(std::forward<Args>(args)...);
+      ops_ = &InlineOps<Body>::ops;
+      return *body;
+    }
+
+    template<class Body, class ... Args>
+    Body& emplace(std::false_type, Args&&... args) {
+      Body* body = new Body(std::forward<Args>(args)...);
+      new (&storage_) Body*(body);
+      ops_ = &HeapOps<Body>::ops;
+      return *body;
+    }
+
+    void reset() {
+      if (ops_ != nullptr) {
+        ops_->destroy(&storage_);
+        ops_ = nullptr;
+      }
+    }
+
+    const Ops* ops_;
+    Storage storage_;
+  };
+
+  // Ring buffer of tasks that can be taken from either end; it only
+  // allocates when it outgrows its capacity, which it keeps.
+  class TaskQueue {
+   public:
+    TaskQueue()
+        : head_(0),
+          size_(0) {
+    }
+
+    size_t size() const {
+      return size_;
+    }
+
+    bool empty() const {
+      return size_ == 0;
+    }
+
+    void push_back(Task&& task) {
+      if (size_ == slots_.size()) {
+        grow();
+      }
+      slots_[slot(size_)] = std::move(task);
+      size_++;
+    }
+
+    Task pop_front() {
+      Task task(std::move(slots_[head_]));
+      head_ = slot(1);
+      size_--;
+      return task;
+    }
+
+    Task pop_back() {
+      size_--;
+      return Task(std::move(slots_[slot(size_)]));
+    }
+
+   private:
+    // Capacity is a power of two.
+    size_t slot(size_t i) const {
+      return (head_ + i) & (slots_.size() - 1);
+    }
+
+    void grow() {
+      std::vector<Task> slots(slots_.empty() ? 16 : 2 * slots_.size());
+      for (size_t i = 0; i < size_; ++i) {
+        slots[i] = std::move(slots_[slot(i)]);
+      }
+      slots_.swap(slots);
+      head_ = 0;
+    }
+
+    std::vector<Task> slots_;
+    size_t head_;
+    size_t size_;
+  };
+
+  struct Worker {
+    Worker() {
+      for (int p = 0; p < NUM_PRIORITIES; ++p) {
+        counts[p].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    std::mutex mutex;
+    TaskQueue tasks[NUM_PRIORITIES];
+    // Sizes of `tasks`, written under `mutex` and read without it: a zero
+    // count lets pop() pass the worker by without taking its lock.
+    std::atomic<size_t> counts[NUM_PRIORITIES];
+  };
+
+  void push(Task task, TaskPriority priority, int affinity);
+  bool pop(size_t self, Task& task);
+  void work(size_t self);
+
   // need to keep track of threads so we can join them
   std::vector<std::thread> workers;
-  // the task queue
-  std::queue<std::function<void()> > tasks;
+  std::vector<std::unique_ptr<Worker>> queues;
+
+  // NUMA node of each worker (-1 if not pinned), the workers of each node,
+  // and the tiers in which each worker looks for tasks: its own node's
+  // workers, itself first, then those of the other nodes.
+  std::vector<int> worker_node;
+  std::map<int, std::vector<size_t>> node_workers;
+  std::vector<std::vector<std::vector<size_t>>> steal_tiers;
+
+  // Tasks pushed but not yet popped, and workers asleep waiting for them.
+  std::atomic<size_t> pending;
+  std::atomic<size_t> sleepers;
+  std::atomic<size_t> next_worker;
 
   // synchronization
-  std::mutex queue_mutex;
+  std::mutex idle_mutex;
   std::condition_variable condition;
-  bool stop;
+  std::atomic<bool> stop;
 };
 
-// the constructor just launches some amount of workers
-inline AsyncThreadPool::AsyncThreadPool(size_t threads)
-    : stop(false) {
-  for (size_t i = 0; i < threads; ++i)
-    workers.emplace_back([this]
-    {
-      for(;;)
-      {
-        std::function<void()> task;
-
-        {
-          std::unique_lock<std::mutex> lock(this->queue_mutex);
-          this->condition.wait(lock,
-              [this] {return this->stop || !this->tasks.empty();});
-          if(this->stop && this->tasks.empty())
-          return;
-          task = std::move(this->tasks.front());
-          this->tasks.pop();
-        }
+template<class Body>
+const typename AsyncThreadPool::Task::Ops
+AsyncThreadPool::Task::InlineOps<Body>::ops = {
+    &InlineOps<Body>::run, &InlineOps<Body>::move, &InlineOps<Body>::destroy};
+
+template<class Body>
+const typename AsyncThreadPool::Task::Ops
+AsyncThreadPool::Task::HeapOps<Body>::ops = {
+    &HeapOps<Body>::run, &HeapOps<Body>::move, &HeapOps<Body>::destroy};
 
-        task();
+// the constructor just launches some amount of workers
+inline AsyncThreadPool::AsyncThreadPool(size_t threads, bool numa_aware)
+    : pending(0),
+      sleepers(0),
+      next_worker(0),
+      stop(false) {
+  if (threads == 0) {
+    threads = 1;
+  }
+  const std::vector<int>& nodes = Numa::nodes();
+  for (size_t i = 0; i < threads; ++i) {
+    queues.emplace_back(new Worker());
+    worker_node.push_back(numa_aware ? nodes[i % nodes.size()] : -1);
+    if (numa_aware) {
+      node_workers[worker_node[i]].push_back(i);
+    }
+  }
+  for (size_t self = 0; self < threads; ++self) {
+    std::vector<size_t> local, remote;
+    for (size_t i = 0; i < threads; ++i) {
+      size_t other = (self + i) % threads;
+      (worker_node[other] == worker_node[self] ? local : remote).push_back(
+          other);
+    }
+    steal_tiers.emplace_back();
+    steal_tiers.back().push_back(local);
+    if (!remote.empty()) {
+      steal_tiers.back().push_back(remote);
+    }
+  }
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([this, i] {
+      if (worker_node[i] >= 0) {
+        Numa::pin_thread(worker_node[i]);
       }
+      work(i);
     });
+  }
+}
+
+inline int AsyncThreadPool::affinity_for(int node, int key) const {
+  auto it = node_workers.find(node);
+  if (it == node_workers.end()) {
+    return key;
+  }
+  return it->second[key % it->second.size()];
 }
 
-// add new work item to the pool
 template<class F, class ... Args>
 auto AsyncThreadPool::enqueue(F&& f, Args&&... args)
+-> std::future<typename std::result_of<F(Args...)>::type> {
+  return enqueue_with(TaskPriority::NORMAL, NO_AFFINITY, std::forward<F>(f),
+                      std::forward<Args>(args)...);
+}
+
+// add new work item to the pool
+template<class F, class ... Args>
+auto AsyncThreadPool::enqueue_with(TaskPriority priority, int affinity,
+                                   F&& f, Args&&... args)
 -> std::future<typename std::result_of<F(Args...)>::type> {
   using return_type = typename std::result_of<F(Args...)>::type;
 
-  auto task = std::make_shared<std::packaged_task<return_type()> >(
-      std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+  // don't allow enqueueing after stopping the pool
+  if (stop) {
+    throw std::runtime_error("enqueue on stopped ThreadPool");
+  }
+
+  auto bound = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+  // Traced tasks carry the submitter's trace, and record how long they
+  // queued and ran.
+  int64_t trace_id = Trace::current();
+  uint64_t enqueued = trace_id != 0 ? Trace::now_ns() : 0;
+  auto traced = [bound, trace_id, enqueued]() mutable -> return_type {
+    if (trace_id == 0) {
+      return bound();
+    }
+    Trace::record("queue", trace_id, enqueued, Trace::now_ns());
+    Trace::Scope scope(trace_id);
+    Trace::Span span("task");
+    return bound();
+  };
 
-  std::future<return_type> res = task->get_future();
+  Task task;
+  std::future<return_type> res = task.emplace<
+      TaskBody<return_type, decltype(traced)>>(std::move(traced))
+      .promise_.get_future();
+  push(std::move(task), priority, affinity);
+  return res;
+}
+
+inline void AsyncThreadPool::push(Task task, TaskPriority priority,
+                                  int affinity) {
+  size_t target = affinity >= 0 ? affinity : next_worker++;
+  Worker& worker = *queues[target % queues.size()];
+  int p = static_cast<int>(priority);
+  // Counted before it is visible, so pop() never takes pending below zero.
+  pending++;
   {
-    std::unique_lock<std::mutex> lock(queue_mutex);
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    worker.tasks[p].push_back(std::move(task));
+    worker.counts[p].store(worker.tasks[p].size(), std::memory_order_relaxed);
+  }
+  // Sleepers register under idle_mutex before re-checking pending, so
+  // either they see this task or we see them.
+  if (sleepers > 0) {
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    condition.notify_one();
+  }
+}
 
-    // don't allow enqueueing after stopping the pool
-    if (stop)
-      throw std::runtime_error("enqueue on stopped ThreadPool");
+// Highest priority task of the nearest tier that has one: own tasks oldest
+// first, else the newest task of another worker.  Workers whose count says
+// they have none are not locked; one that was just pushed to and is missed
+// is found on the next call, as work() does not sleep while pending > 0.
+inline bool AsyncThreadPool::pop(size_t self, Task& task) {
+  const std::vector<std::vector<size_t>>& tiers = steal_tiers[self];
+  for (size_t t = 0; t < tiers.size(); ++t) {
+    const std::vector<size_t>& tier = tiers[t];
+    for (int p = 0; p < NUM_PRIORITIES; ++p) {
+      for (size_t i = 0; i < tier.size(); ++i) {
+        Worker& worker = *queues[tier[i]];
+        if (worker.counts[p].load(std::memory_order_relaxed) == 0) {
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        TaskQueue& tasks = worker.tasks[p];
+        if (tasks.empty()) {
+          continue;
+        }
+        task = tier[i] == self ? tasks.pop_front() : tasks.pop_back();
+        worker.counts[p].store(tasks.size(), std::memory_order_relaxed);
+        pending--;
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-    tasks.emplace([task]() {(*task)();});
+inline void AsyncThreadPool::work(size_t self) {
+  for (;;) {
+    Task task;
+    if (pop(self, task)) {
+      task.run();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    sleepers++;
+    condition.wait(lock, [this] {return stop || pending > 0;});
+    sleepers--;
+    if (stop && pending == 0) {
+      return;
+    }
   }
-  condition.notify_one();
-  return res;
 }
 
 // the destructor joins all threads
 inline AsyncThreadPool::~AsyncThreadPool() {
   {
-    std::unique_lock<std::mutex> lock(queue_mutex);
+    std::unique_lock<std::mutex> lock(idle_mutex);
     stop = true;
   }
   condition.notify_all();
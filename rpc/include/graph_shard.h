@@ -4,10 +4,12 @@
 #include "GraphFormatter.hpp"
 #include "GraphLogStore.h"
 #include "GraphSuffixStore.h"
+#include "Router.h"
 #include "SuccinctGraph.hpp"
 #include "utils.h"
 
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <future>
 #include "async_thread_pool.h"
@@ -18,9 +20,14 @@ class GraphShard {
              bool construct, int32_t sa_sampling_rate,
              int32_t isa_sampling_rate, int32_t npa_sampling_rate, int shard_id,
              int total_num_shards, const StoreMode store_mode,
-             int num_suffixstore_shards, int num_logstore_shards)
+             int num_suffixstore_shards, int num_logstore_shards,
+             LoadPolicy load_policy = LoadPolicy::EAGER,
+             const ShardRouter* shard_router = nullptr)
       : shard_id_(shard_id),
         total_num_shards_(total_num_shards),
+        modulo_router_(total_num_shards),
+        shard_router_(
+            shard_router != nullptr ? shard_router : &modulo_router_),
         node_file_(node_file),
         edge_file_(edge_file),
         construct_(construct),
@@ -60,6 +67,7 @@ class GraphShard {
         graph_->set_npa_sampling_rate(npa_sampling_rate);
         graph_->set_sa_sampling_rate(sa_sampling_rate);
         graph_->set_isa_sampling_rate(isa_sampling_rate);
+        graph_->set_load_policy(load_policy);
         if (construct_) {
           LOG_E("Construct is set to true: starting to construct & encode\n");
           if (!node_table_empty_ && !edge_table_empty_) {
@@ -82,6 +90,7 @@ class GraphShard {
           } else {
             assert(false && "Neither node file nor edge file exists!");
           }
+          graph_->print_load_stats();
         }
         break;
       }
@@ -100,9 +109,10 @@ class GraphShard {
         graph_log_store_ = new GraphLogStore(node_file_, edge_file_);
 
         if (shard_id_ == total_num_shards_) {
-          // This process is the append-only, initially empty store
-          // the node file and edge file will be ignored, since
-          // construct() / load() is not called
+          // This process is the append-only store: the node file and edge
+          // file, if any, only name its snapshots, and it starts from the
+          // last one, or empty.
+          graph_log_store_->load();
           break;
         }
 
@@ -127,7 +137,7 @@ class GraphShard {
     // Your implementation goes here
     COND_LOG_E("Received: get_neighbors(%lld)\n", nodeId);
 
-    assert(nodeId % total_num_shards_ == shard_id_);
+    assert(shard_router_->shard_of(nodeId) == shard_id_);
     if (edge_table_empty_) {
       _return.clear();
       return;
@@ -139,7 +149,7 @@ class GraphShard {
                            const int64_t atype) {
     COND_LOG_E("get_neighbors_atype\n");
 
-    assert(nodeId % total_num_shards_ == shard_id_);
+    assert(shard_router_->shard_of(nodeId) == shard_id_);
     if (edge_table_empty_) {
       _return.clear();
       return;
@@ -150,7 +160,7 @@ class GraphShard {
   void get_edge_attrs(std::vector<std::string> & _return, const int64_t nodeId,
                       const int64_t atype) {
     COND_LOG_E("get_edge_attrs\n");
-    assert(nodeId % total_num_shards_ == shard_id_);
+    assert(shard_router_->shard_of(nodeId) == shard_id_);
     if (edge_table_empty_) {
       _return.clear();
       return;
@@ -170,10 +180,9 @@ class GraphShard {
     std::set<int64_t> local_keys;
     graph_->get_nodes(local_keys, attrId, attrKey);
 
-    // TODO: this assumes a particular form of hash partitioning
     auto it = _return.begin();
     for (int64_t local_key : local_keys) {
-      it = _return.insert(it, local_key * total_num_shards_ + shard_id_);
+      it = _return.insert(it, shard_router_->global_key(shard_id_, local_key));
     }
   }
 
@@ -190,10 +199,9 @@ class GraphShard {
     std::set<int64_t> local_keys;
     graph_->get_nodes(local_keys, attrId1, attrKey1, attrId2, attrKey2);
 
-    // TODO: this assumes a particular form of hash partitioning
     auto it = _return.begin();
     for (int64_t local_key : local_keys) {
-      it = _return.insert(it, local_key * total_num_shards_ + shard_id_);
+      it = _return.insert(it, shard_router_->global_key(shard_id_, local_key));
     }
   }
 
@@ -478,6 +486,27 @@ class GraphShard {
     }
   }
 
+  // Snapshots a LogStore shard; false for other stores, or on failure.
+  bool snapshot() {
+    if (store_mode_ != StoreMode::LogStore) {
+      return false;
+    }
+    return graph_log_store_->snapshot();
+  }
+
+  // What a LogStore shard holds, for the update pointers of the shards of
+  // its edges' sources and of its nodes; nothing for other stores.
+  void build_backfill_updates(
+      std::unordered_map<int, GraphFormatter::AssocSet>& edge_updates,
+      std::unordered_map<int, std::vector<int64_t>>& node_updates,
+      const ShardRouter& router) {
+    if (store_mode_ != StoreMode::LogStore) {
+      return;
+    }
+    graph_log_store_->build_backfill_edge_updates(edge_updates, router);
+    graph_log_store_->build_backfill_node_updates(node_updates, router);
+  }
+
   void getFilteredLinkList(std::vector<Link>& assocs, const int64_t id1,
                            const int64_t link_type, const int64_t min_timestamp,
                            const int64_t max_timestamp, const int64_t offset,
@@ -516,6 +545,11 @@ class GraphShard {
   const int shard_id_;
   const int total_num_shards_;
 
+  // Where the nodes are: the router the cluster was partitioned with, or
+  // by default modulo_router_, which the shard owns.
+  const ModuloShardRouter modulo_router_;
+  const ShardRouter* shard_router_;
+
   const std::string node_file_;
   const std::string edge_file_;
   const bool construct_;
@@ -538,19 +572,41 @@ class AsyncGraphShard : public GraphShard {
                   int32_t isa_sampling_rate, int32_t npa_sampling_rate,
                   int shard_id, int total_num_shards,
                   const StoreMode store_mode, int num_suffixstore_shards,
-                  int num_logstore_shards, AsyncThreadPool* pool)
+                  int num_logstore_shards, AsyncThreadPool* pool,
+                  LoadPolicy load_policy = LoadPolicy::EAGER,
+                  int numa_node = -1,
+                  const ShardRouter* shard_router = nullptr)
       : GraphShard(node_file, edge_file, construct, sa_sampling_rate,
                    isa_sampling_rate, npa_sampling_rate, shard_id,
                    total_num_shards, store_mode, num_suffixstore_shards,
-                   num_logstore_shards) {
+                   num_logstore_shards, load_policy, shard_router),
+        numa_node_(numa_node),
+        affinity_(pool->affinity_for(numa_node, shard_id)) {
     pool_ = pool;
   }
 
+  // NUMA node this shard was loaded on, or -1 if it was not placed.
+  int numa_node() const {
+    return numa_node_;
+  }
+
+  // Runs `f` on a pool worker of this shard's NUMA node, which is pinned
+  // there, and waits for it, so that the caller's thread stays where it is;
+  // runs it on the calling thread if the shard was not placed or the thread
+  // is on that node already.
+  template<class F>
+  auto run_on_node(TaskPriority priority, F&& f) -> decltype(f()) {
+    if (numa_node_ < 0 || Numa::pinned_node() == numa_node_) {
+      return f();
+    }
+    return pool_->enqueue_with(priority, affinity_, std::forward<F>(f)).get();
+  }
+
   // Async functions using futures
   std::future<std::vector<int64_t>> async_filter_nodes(
       const std::vector<int64_t> & nodeIds, const int32_t attrId,
       const std::string& attrKey) {
-    return pool_->enqueue([&] {
+    return pool_->enqueue_with(TaskPriority::LOW, affinity_, [&] {
       std::vector<int64_t> res;
       filter_nodes(res, nodeIds, attrId, attrKey);
       return res;
@@ -559,7 +615,7 @@ class AsyncGraphShard : public GraphShard {
 
   std::future<std::set<int64_t>> async_get_nodes(const int32_t attrId,
                                                  const std::string& attrKey) {
-    return pool_->enqueue([&] {
+    return pool_->enqueue_with(TaskPriority::LOW, affinity_, [&] {
       std::set<int64_t> res;
       get_nodes(res, attrId, attrKey);
       return res;
@@ -570,7 +626,7 @@ class AsyncGraphShard : public GraphShard {
                                                   const std::string& attrKey1,
                                                   const int32_t attrId2,
                                                   const std::string& attrKey2) {
-    return pool_->enqueue([&] {
+    return pool_->enqueue_with(TaskPriority::LOW, affinity_, [&] {
       std::set<int64_t> res;
       get_nodes2(res, attrId1, attrKey1, attrId2, attrKey2);
       return res;
@@ -578,7 +634,7 @@ class AsyncGraphShard : public GraphShard {
   }
 
   std::future<int64_t> async_assoc_count(int64_t src, int64_t atype) {
-    return pool_->enqueue([&] {
+    return pool_->enqueue_with(TaskPriority::HIGH, affinity_, [&] {
       return assoc_count(src, atype);
     });
   }
@@ -586,7 +642,7 @@ class AsyncGraphShard : public GraphShard {
   std::future<std::vector<ThriftAssoc>> async_assoc_get(
       const int64_t src, const int64_t atype, const std::set<int64_t>& dstIdSet,
       const int64_t tLow, const int64_t tHigh) {
-    return pool_->enqueue([&] {
+    return pool_->enqueue_with(TaskPriority::NORMAL, affinity_, [&] {
       std::vector<ThriftAssoc> res;
       assoc_get(res, src, atype, dstIdSet, tLow, tHigh);
       return res;
@@ -596,7 +652,7 @@ class AsyncGraphShard : public GraphShard {
   std::future<std::vector<ThriftAssoc>> async_assoc_time_range(
       const int64_t src, const int64_t atype, const int64_t tLow,
       const int64_t tHigh, const int32_t limit) {
-    return pool_->enqueue([&] {
+    return pool_->enqueue_with(TaskPriority::NORMAL, affinity_, [&] {
       std::vector<ThriftAssoc> res;
       assoc_time_range(res, src, atype, tLow, tHigh, limit);
       return res;
@@ -605,7 +661,7 @@ class AsyncGraphShard : public GraphShard {
 
   std::future<std::vector<ThriftAssoc>> async_getLinkList(
       const int64_t id1, const int64_t link_type) {
-    return pool_->enqueue([&] {
+    return pool_->enqueue_with(TaskPriority::NORMAL, affinity_, [&] {
       std::vector<ThriftAssoc> res;
       getLinkList(res, id1, link_type);
       return res;
@@ -615,7 +671,7 @@ class AsyncGraphShard : public GraphShard {
   std::future<std::vector<ThriftAssoc>> async_getFilteredLinkList(
       const int64_t id1, const int64_t link_type, const int64_t min_timestamp,
       const int64_t max_timestamp, const int64_t offset, const int64_t limit) {
-    return pool_->enqueue(
+    return pool_->enqueue_with(TaskPriority::NORMAL, affinity_,
         [&] {
           std::vector<ThriftAssoc> res;
           getFilteredLinkList(res, id1, link_type, min_timestamp, max_timestamp, offset, limit);
@@ -626,6 +682,10 @@ class AsyncGraphShard : public GraphShard {
   // TODO: Add more async functions
  private:
   AsyncThreadPool *pool_;
+  const int numa_node_;
+  // Tasks of this shard go to the same pool worker (on the shard's NUMA node,
+  // if placed) unless stolen.
+  const int affinity_;
 };
 
 #endif
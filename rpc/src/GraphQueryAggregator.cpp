@@ -13,6 +13,7 @@
 #include <set>
 #include <unordered_map>
 
+#include <thrift/TProcessor.h>
 #include <thrift/protocol/TBinaryProtocol.h>
 #include <thrift/server/TThreadedServer.h>
 #include <thrift/transport/TBufferTransports.h>
@@ -23,6 +24,11 @@
 #include <iomanip>
 #include <sstream>
 
+#include "Metrics.h"
+#include "Numa.h"
+#include "ReplicaSelector.h"
+#include "Router.h"
+#include "Trace.h"
 #include "graph_shard.h"
 #include "ports.h"
 #include "utils.h"
@@ -47,6 +53,25 @@ boost::shared_mutex edge_update_ptrs_mutex;
 std::vector<std::unordered_map<int64_t, int32_t>> node_update_ptrs;
 boost::shared_mutex node_update_ptrs_mutex;
 
+// Set once the LogStore host has pointed the shards at the edges and nodes
+// it restored from a snapshot, which no assoc_add() or obj_add() announces.
+std::once_flag update_ptrs_restored;
+
+const Metrics::Id kRemoteCalls = Metrics::counter("aggregator.remote_calls");
+const Metrics::Id kUpdatePtrHits = Metrics::counter(
+    "aggregator.update_ptr_hits");
+const Metrics::Id kUpdatePtrMisses = Metrics::counter(
+    "aggregator.update_ptr_misses");
+const Metrics::Id kReplicaReads = Metrics::counter(
+    "aggregator.replica_reads");
+
+// Set by SIGUSR1, to snapshot the LogStore without waiting for the interval.
+volatile sig_atomic_t snapshot_requested = 0;
+
+// Trace id sent ahead of the next call on this connection (see trace_next);
+// each connection is served by its own thread.
+thread_local int64_t next_trace_id = 0;
+
 // anuragk: What we want is per shard control over whether
 // the shard is a SuccinctStore shard, SuffixStore shard, or
 // a LogStore shard. Right now, for much of the code it is assumed
@@ -73,13 +98,17 @@ class GraphQueryAggregatorServiceHandler :
       int total_num_shards, int local_num_shards, int local_host_id,
       const std::vector<std::string>& hostnames,
       const std::vector<AsyncGraphShard*>& local_shards,
-      bool multistore_enabled = false, int num_suffixstore_shards = 1,
-      int num_logstore_shards = 1)
+      const ShardRouter& shard_router, const HostRouter& host_router,
+      ReplicaSelector& replica_selector, bool multistore_enabled = false,
+      int num_suffixstore_shards = 1, int num_logstore_shards = 1)
       : total_num_shards_(total_num_shards),
         local_num_shards_(local_num_shards),
         local_host_id_(local_host_id),
         hostnames_(hostnames),
         local_shards_(local_shards),
+        shard_router_(shard_router),
+        host_router_(host_router),
+        replica_selector_(replica_selector),
         total_num_hosts_(hostnames.size()),
         initiated_(false),
         multistore_enabled_(multistore_enabled),
@@ -87,6 +116,12 @@ class GraphQueryAggregatorServiceHandler :
         num_suffixstore_shards_(num_suffixstore_shards),
         num_logstore_shards_(num_logstore_shards) {
     num_succinctstore_hosts_ = total_num_hosts_;  // FIXME
+
+    local_shard_ids_ = host_router_.shards_of(local_host_id_);
+    local_shard_idx_.assign(total_num_shards_, -1);
+    for (size_t i = 0; i < local_shard_ids_.size(); ++i) {
+      local_shard_idx_[local_shard_ids_[i]] = i;
+    }
   }
 
   // Should just be connection establishment; assumes data loading has already
@@ -146,6 +181,19 @@ class GraphQueryAggregatorServiceHandler :
       return 1;
     }COND_LOG_E("Aggregators connected: cluster has %zu aggregators in total.\n",
         hostnames_.size());
+
+    // The LogStore host reaches every aggregator from here on, whichever
+    // one was init()ed.
+    if (multistore_enabled_ && local_host_id_ == total_num_hosts_ - 1) {
+      try {
+        std::call_once(update_ptrs_restored, [this] {
+          restore_update_ptrs();
+        });
+      } catch (std::exception& e) {
+        LOG_E("Could not restore update pointers: %s\n", e.what());
+        return 1;
+      }
+    }
     return 0;
   }
 
@@ -168,6 +216,59 @@ class GraphQueryAggregatorServiceHandler :
     aggregator_transports_.clear();
   }
 
+  // Points the shards at what the LogStore shard restored from a snapshot,
+  // as assoc_add() and obj_add() did when it was first added.  Pointers
+  // recorded twice meanwhile are harmless: record_edge_updates() keeps one.
+  void restore_update_ptrs() {
+    std::unordered_map<int, GraphFormatter::AssocSet> edge_updates;
+    std::unordered_map<int, std::vector<int64_t>> node_updates;
+    local_shards_.back()->build_backfill_updates(edge_updates, node_updates,
+                                                 shard_router_);
+
+    int32_t logstore_shard_id = total_num_shards_;
+    size_t num_lists = 0, num_nodes = 0;
+    for (auto& shard_updates : edge_updates) {
+      int primary_shard_id = shard_updates.first;
+      std::vector<ThriftSrcAtype> updates;
+      updates.reserve(shard_updates.second.size());
+      for (auto& list : shard_updates.second) {
+        ThriftSrcAtype src_atype;
+        src_atype.src = list.first;
+        src_atype.atype = list.second;
+        updates.push_back(src_atype);
+      }
+      num_lists += updates.size();
+
+      for (int primary_host_id : hosts_for_shard(primary_shard_id)) {
+        if (primary_host_id == local_host_id_) {
+          record_edge_updates(logstore_shard_id, primary_shard_id, updates);
+        } else {
+          remote(primary_host_id)->record_edge_updates(logstore_shard_id,
+                                                       primary_shard_id,
+                                                       updates);
+        }
+      }
+    }
+
+    for (auto& shard_updates : node_updates) {
+      int primary_shard_id = shard_updates.first;
+      num_nodes += shard_updates.second.size();
+      for (int primary_host_id : hosts_for_shard(primary_shard_id)) {
+        for (int64_t obj : shard_updates.second) {
+          if (primary_host_id == local_host_id_) {
+            record_node_append(logstore_shard_id, primary_shard_id, obj);
+          } else {
+            remote(primary_host_id)->record_node_append(logstore_shard_id,
+                                                        primary_shard_id,
+                                                        obj);
+          }
+        }
+      }
+    }
+    LOG_E("[LOGSTORE] Restored update pointers of %zu edge lists and "
+          "%zu nodes\n", num_lists, num_nodes);
+  }
+
   void record_node_append(const int32_t next_shard_id,
                           const int32_t local_shard_id, const int64_t obj) {
     COND_LOG_E(
@@ -214,82 +315,101 @@ class GraphQueryAggregatorServiceHandler :
 
   void get_attribute(std::string& _return, const int64_t nodeId,
                      const int32_t attrId) {
-    int shard_id = nodeId % total_num_shards_;
-    int host_id = shard_id % total_num_hosts_;
+    int shard_id = shard_for_node(nodeId);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
     if (host_id == local_host_id_) {
       get_attribute_local(_return, shard_id, nodeId, attrId);
     } else {
       COND_LOG_E("nodeId %lld, host id %d, aggs size\n", nodeId, host_id,
           aggregators_.size());
-      aggregators_.at(host_id).get_attribute_local(_return, shard_id, nodeId,
-                                                   attrId);
+      remote(host_id)->get_attribute_local(_return, shard_id, nodeId,
+                                           attrId);
     }
   }
 
   void get_attribute_local(std::string& _return, const int64_t shard_id,
                            const int64_t node_id, const int32_t attrId) {
-    local_shards_.at(shard_id_to_shard_idx(shard_id))->get_attribute_local(
-        _return, global_to_local_node_id(node_id, shard_id), attrId);
+    on_local_shard(shard_id_to_shard_idx(shard_id), TaskPriority::HIGH,
+                   [&](AsyncGraphShard* shard) {
+      shard->get_attribute_local(_return, shard_router_.local_key(node_id),
+                                 attrId);
+    });
   }
 
   void get_neighbors(std::vector<int64_t> & _return, const int64_t nodeId) {
-    int shard_id = nodeId % total_num_shards_;
-    int host_id = shard_id % total_num_hosts_;
+    int shard_id = shard_for_node(nodeId);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
     COND_LOG_E("Received: get_neighbors(%lld), route to shard %d on host %d\n",
         nodeId, shard_id, host_id);
     if (host_id == local_host_id_) {
       int shard_idx = shard_id_to_shard_idx(shard_id);
-      local_shards_.at(shard_idx)->get_neighbors(_return, nodeId);
+      on_local_shard(shard_idx, TaskPriority::NORMAL,
+                     [&](AsyncGraphShard* shard) {
+        shard->get_neighbors(_return, nodeId);
+      });
     } else {
-      aggregators_.at(host_id).get_neighbors_local(_return, shard_id, nodeId);
+      remote(host_id)->get_neighbors_local(_return, shard_id, nodeId);
     }
   }
 
   void get_neighbors_local(std::vector<int64_t> & _return,
                            const int32_t shardId, const int64_t nodeId) {
-    local_shards_[shardId / total_num_hosts_]->get_neighbors(_return, nodeId);
+    on_local_shard(shard_id_to_shard_idx(shardId), TaskPriority::NORMAL,
+                   [&](AsyncGraphShard* shard) {
+      shard->get_neighbors(_return, nodeId);
+    });
   }
 
   void get_neighbors_atype(std::vector<int64_t> & _return, const int64_t nodeId,
                            const int64_t atype) {
-    int shard_id = nodeId % total_num_shards_;
-    int host_id = shard_id % total_num_hosts_;
+    int shard_id = shard_for_node(nodeId);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
     if (host_id == local_host_id_) {
-      local_shards_.at(shard_id_to_shard_idx(shard_id))->get_neighbors_atype(
-          _return, nodeId, atype);
+      on_local_shard(shard_id_to_shard_idx(shard_id), TaskPriority::NORMAL,
+                     [&](AsyncGraphShard* shard) {
+        shard->get_neighbors_atype(_return, nodeId, atype);
+      });
     } else {
-      aggregators_.at(host_id).get_neighbors_atype_local(_return, shard_id,
-                                                         nodeId, atype);
+      remote(host_id)->get_neighbors_atype_local(_return, shard_id,
+                                                 nodeId, atype);
     }
   }
 
   void get_neighbors_atype_local(std::vector<int64_t> & _return,
                                  const int32_t shardId, const int64_t nodeId,
                                  const int64_t atype) {
-    local_shards_[shardId / total_num_hosts_]->get_neighbors_atype(_return,
-                                                                   nodeId,
-                                                                   atype);
+    on_local_shard(shard_id_to_shard_idx(shardId), TaskPriority::NORMAL,
+                   [&](AsyncGraphShard* shard) {
+      shard->get_neighbors_atype(_return, nodeId, atype);
+    });
   }
 
   void get_edge_attrs(std::vector<std::string> & _return, const int64_t nodeId,
                       const int64_t atype) {
-    int shard_id = nodeId % total_num_shards_;
-    int host_id = shard_id % total_num_hosts_;
+    int shard_id = shard_for_node(nodeId);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
     if (host_id == local_host_id_) {
-      local_shards_.at(shard_id_to_shard_idx(shard_id))->get_edge_attrs(_return,
-                                                                        nodeId,
-                                                                        atype);
+      on_local_shard(shard_id_to_shard_idx(shard_id), TaskPriority::NORMAL,
+                     [&](AsyncGraphShard* shard) {
+        shard->get_edge_attrs(_return, nodeId, atype);
+      });
     } else {
-      aggregators_.at(host_id).get_edge_attrs_local(_return, shard_id, nodeId,
-                                                    atype);
+      remote(host_id)->get_edge_attrs_local(_return, shard_id, nodeId,
+                                            atype);
     }
   }
 
   void get_edge_attrs_local(std::vector<std::string> & _return,
                             const int32_t shardId, const int64_t nodeId,
                             const int64_t atype) {
-    local_shards_[shardId / total_num_hosts_]->get_edge_attrs(_return, nodeId,
-                                                              atype);
+    on_local_shard(shard_id_to_shard_idx(shardId), TaskPriority::NORMAL,
+                   [&](AsyncGraphShard* shard) {
+      shard->get_edge_attrs(_return, nodeId, atype);
+    });
   }
 
   void get_neighbors_attr(std::vector<int64_t> & _return, const int64_t nodeId,
@@ -297,8 +417,9 @@ class GraphQueryAggregatorServiceHandler :
     COND_LOG_E("Aggregator get_nhbr_node(nodeId %d, attrId %d)\n", nodeId,
         attrId);
 
-    int shard_id = nodeId % total_num_shards_;
-    int host_id = shard_id % total_num_hosts_;
+    int shard_id = shard_for_node(nodeId);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
     // Delegate to the shard responsible for nodeId.
     if (host_id == local_host_id_) {
       COND_LOG_E("Delegating to myself\n");
@@ -307,9 +428,9 @@ class GraphQueryAggregatorServiceHandler :
     } else {
       COND_LOG_E("Route to aggregator on host %d\n", host_id);
 
-      aggregators_.at(host_id).get_neighbors_attr_local(_return, shard_id,
-                                                        nodeId, attrId,
-                                                        attrKey);
+      remote(host_id)->get_neighbors_attr_local(_return, shard_id,
+                                                nodeId, attrId,
+                                                attrKey);
     }
   }
 
@@ -330,7 +451,7 @@ class GraphQueryAggregatorServiceHandler :
     int host_id;
 
     for (int64_t nhbr_id : nhbrs) {
-      host_id = (nhbr_id % total_num_shards_) % total_num_hosts_;
+      host_id = host_id_for_shard(shard_for_node(nhbr_id));
       splits_by_keys[host_id].push_back(nhbr_id);  // global
     }
 
@@ -342,8 +463,8 @@ class GraphQueryAggregatorServiceHandler :
         COND_LOG_E("locally filtered result: %d\n", _return.size());
       } else {
         COND_LOG_E("host id %d\n", host_id);
-        aggregators_.at(host_id).send_filter_nodes_local(it->second, attrId,
-                                                         attrKey);
+        remote(host_id)->send_filter_nodes_local(it->second, attrId,
+                                                 attrKey);
       }
     }
 
@@ -355,7 +476,7 @@ class GraphQueryAggregatorServiceHandler :
       COND_LOG_E("recv target: host %d\n", host_id);
       // The equal case has already been computed in loop above
       if (host_id != local_host_id_) {
-        aggregators_.at(host_id).recv_filter_nodes_local(shard_result);
+        reply(host_id)->recv_filter_nodes_local(shard_result);
         COND_LOG_E("remotely filtered result: %d\n", shard_result.size());
         _return.insert(_return.end(), shard_result.begin(), shard_result.end());
       }
@@ -371,37 +492,34 @@ class GraphQueryAggregatorServiceHandler :
     int shard_id;
 
     for (int64_t nhbr_id : nodeIds) {
-      shard_id = nhbr_id % total_num_shards_;
+      shard_id = shard_for_node(nhbr_id);
       splits_by_keys[shard_id].push_back(
-          global_to_local_node_id(nhbr_id, shard_id));  // to local
+          shard_router_.local_key(nhbr_id));  // to local
     }
 
     typedef std::future<std::vector<int64_t>> future_t;
     std::unordered_map<int, future_t> futures;
     for (auto it = splits_by_keys.begin(); it != splits_by_keys.end(); ++it) {
-      COND_LOG_E("sending to shard %d, filter_nodes\n",
-          it->first / total_num_hosts_);
+      int shard_idx = shard_id_to_shard_idx(it->first);
+      COND_LOG_E("sending to shard %d, filter_nodes\n", shard_idx);
       // FIXME?: try to sleep a while? get_nhbr(n, attr) bug here?
-      AsyncGraphShard *shard = local_shards_[it->first / total_num_hosts_];
+      AsyncGraphShard *shard = local_shards_[shard_idx];
       auto future = shard->async_filter_nodes(it->second, attrId, attrKey);
       futures.insert(
-          std::pair<int, future_t>(it->first / total_num_hosts_,
-                                   std::move(future)));
+          std::pair<int, future_t>(shard_idx, std::move(future)));
       COND_LOG_E("sent");
     }
 
     _return.clear();
     std::vector<int64_t> shard_result;
     for (auto it = splits_by_keys.begin(); it != splits_by_keys.end(); ++it) {
-      COND_LOG_E("receiving filter_nodes() result from shard %d, ",
-          it->first / total_num_hosts_);
-      shard_result = futures[it->first / total_num_hosts_].get();
+      int shard_idx = shard_id_to_shard_idx(it->first);
+      COND_LOG_E("receiving filter_nodes() result from shard %d, ", shard_idx);
+      shard_result = futures[shard_idx].get();
       COND_LOG_E("size: %d\n", shard_result.size());
       // local back to global
       for (const int64_t local_key : shard_result) {
-        // globalKey = localKey * numShards + shardId
-        // localKey = (globalKey - shardId) / numShards
-        _return.push_back(local_key * total_num_shards_ + it->first);
+        _return.push_back(shard_router_.global_key(it->first, local_key));
       }
     }
   }
@@ -412,7 +530,7 @@ class GraphQueryAggregatorServiceHandler :
       if (i == local_host_id_) {
         continue;
       }
-      aggregators_.at(i).send_get_nodes_local(attrId, attrKey);
+      remote(i)->send_get_nodes_local(attrId, attrKey);
     }
 
     get_nodes_local(_return, attrId, attrKey);
@@ -422,7 +540,7 @@ class GraphQueryAggregatorServiceHandler :
       if (i == local_host_id_) {
         continue;
       }
-      aggregators_.at(i).recv_get_nodes_local(shard_result);
+      reply(i)->recv_get_nodes_local(shard_result);
       _return.insert(shard_result.begin(), shard_result.end());
     }
   }
@@ -431,8 +549,11 @@ class GraphQueryAggregatorServiceHandler :
                        const std::string& attrKey) {
     typedef std::future<std::set<int64_t>> future_t;
     std::vector<future_t> futures;
-    for (auto& shard : local_shards_) {
-      auto future = shard->async_get_nodes(attrId, attrKey);
+    for (size_t i = 0; i < local_shards_.size(); ++i) {
+      if (is_replica(i)) {
+        continue;
+      }
+      auto future = local_shards_[i]->async_get_nodes(attrId, attrKey);
       futures.push_back(std::move(future));
     }
 
@@ -452,8 +573,8 @@ class GraphQueryAggregatorServiceHandler :
       if (i == local_host_id_) {
         continue;
       }
-      aggregators_.at(i).send_get_nodes2_local(attrId1, attrKey1, attrId2,
-                                               attrKey2);
+      remote(i)->send_get_nodes2_local(attrId1, attrKey1, attrId2,
+                                       attrKey2);
     }
 
     get_nodes2_local(_return, attrId1, attrKey1, attrId2, attrKey2);
@@ -463,7 +584,7 @@ class GraphQueryAggregatorServiceHandler :
       if (i == local_host_id_) {
         continue;
       }
-      aggregators_.at(i).recv_get_nodes2_local(shard_result);
+      reply(i)->recv_get_nodes2_local(shard_result);
       _return.insert(shard_result.begin(), shard_result.end());
     }
   }
@@ -473,9 +594,12 @@ class GraphQueryAggregatorServiceHandler :
                         const std::string& attrKey2) {
     typedef std::future<std::set<int64_t>> future_t;
     std::vector<future_t> futures;
-    for (auto& shard : local_shards_) {
-      auto future = shard->async_get_nodes2(attrId1, attrKey1, attrId2,
-                                            attrKey2);
+    for (size_t i = 0; i < local_shards_.size(); ++i) {
+      if (is_replica(i)) {
+        continue;
+      }
+      auto future = local_shards_[i]->async_get_nodes2(attrId1, attrKey1,
+                                                       attrId2, attrKey2);
       futures.push_back(std::move(future));
     }
 
@@ -515,6 +639,7 @@ class GraphQueryAggregatorServiceHandler :
     }
 
     lk.unlock();
+    Metrics::add(ptrs.empty() ? kUpdatePtrMisses : kUpdatePtrHits);
   }
 
   void assoc_range(std::vector<ThriftAssoc>& _return, int64_t src,
@@ -524,8 +649,9 @@ class GraphQueryAggregatorServiceHandler :
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    int shard_id = src % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(src);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     if (host_id == local_host_id_) {
       assoc_range_local(_return, shard_id, src, atype, off, len);
@@ -533,8 +659,8 @@ class GraphQueryAggregatorServiceHandler :
       COND_LOG_E("assoc_range(src %lld, atype %lld,...) "
           "route to shard %d on host %d",
           src, atype, shard_id, host_id);
-      aggregators_.at(host_id).assoc_range_local(_return, shard_id, src, atype,
-                                                 off, len);
+      remote(host_id)->assoc_range_local(_return, shard_id, src, atype,
+                                         off, len);
     }
   }
 
@@ -566,12 +692,14 @@ class GraphQueryAggregatorServiceHandler :
       int next_host_id = host_id_for_shard(ptr.shardId);
       if (next_host_id == local_host_id_) {
         int shard_idx_local = shard_id_to_shard_idx(ptr.shardId);
-        local_shards_[shard_idx_local]->assoc_range(assocs, src, atype, 0,
-                                                    len - curr_len);
+        on_local_shard(shard_idx_local, TaskPriority::NORMAL,
+                       [&](AsyncGraphShard* shard) {
+          shard->assoc_range(assocs, src, atype, 0, len - curr_len);
+        });
       } else {
-        aggregators_.at(next_host_id).assoc_range_local(assocs, ptr.shardId,
-                                                        src, atype, 0,  // FIXME: this is a hack and potentially expensive
-                                                        len - curr_len);
+        remote(next_host_id)->assoc_range_local(assocs, ptr.shardId,
+                                                src, atype, 0,  // FIXME: this is a hack and potentially expensive
+                                                len - curr_len);
       }
       _return.insert(_return.end(), assocs.begin(), assocs.end());
 
@@ -579,8 +707,10 @@ class GraphQueryAggregatorServiceHandler :
     }
 
     if (_return.size() < len) {
-      local_shards_.at(shard_idx)->assoc_range(assocs, src, atype, 0,
-                                               len - _return.size());
+      on_local_shard(shard_idx, TaskPriority::NORMAL,
+                     [&](AsyncGraphShard* shard) {
+        shard->assoc_range(assocs, src, atype, 0, len - _return.size());
+      });
       COND_LOG_E("local shard returns %d assocs\n", assocs.size());
       _return.insert(_return.end(), assocs.begin(), assocs.end());
     }
@@ -603,9 +733,10 @@ class GraphQueryAggregatorServiceHandler :
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    // %'ing with total_num_shards_ means always going to a primary
-    int primary_shard_id = src % total_num_shards_;
-    int host_id = primary_shard_id % num_succinctstore_hosts_;
+    // The node's own shard is always a primary, never the LogStore
+    int primary_shard_id = shard_for_node(src);
+    ReplicaSelector::Call replica = read_replica(primary_shard_id);
+    int host_id = replica.host();
 
     if (host_id == local_host_id_) {
       return assoc_count_local(primary_shard_id, src, atype);
@@ -613,8 +744,8 @@ class GraphQueryAggregatorServiceHandler :
       COND_LOG_E("assoc_count(src %lld, atype %lld) "
           "route to shard %d on host %d, shard idx",
           src, atype, primary_shard_id, host_id);
-      return aggregators_.at(host_id).assoc_count_local(primary_shard_id, src,
-                                                        atype);
+      return remote(host_id)->assoc_count_local(primary_shard_id, src,
+                                                atype);
     }
   }
 
@@ -643,8 +774,8 @@ class GraphQueryAggregatorServiceHandler :
             src, atype);
         local_futures.push_back(std::move(future));
       } else {
-        aggregators_.at(next_host_id).send_assoc_count_local(ptr.shardId, src,
-                                                             atype);
+        remote(next_host_id)->send_assoc_count_local(ptr.shardId, src,
+                                                     atype);
       }
     }
 
@@ -664,7 +795,7 @@ class GraphQueryAggregatorServiceHandler :
       int next_host_id = host_id_for_shard(ptr.shardId);
       // We already have all local counts at this point
       if (next_host_id != local_host_id_) {
-        cnt += aggregators_.at(next_host_id).recv_assoc_count_local();
+        cnt += reply(next_host_id)->recv_assoc_count_local();
       }
     }
 
@@ -678,16 +809,17 @@ class GraphQueryAggregatorServiceHandler :
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    int shard_id = src % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(src);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     if (host_id == local_host_id_) {
       COND_LOG_E("sending to shard %d on localhost\n", shard_id);
       assoc_get_local(_return, shard_id, src, atype, dstIdSet, tLow, tHigh);
     } else {
       COND_LOG_E("sending to shard %d on host %d\n", shard_id, host_id);
-      aggregators_.at(host_id).assoc_get_local(_return, shard_id, src, atype,
-                                               dstIdSet, tLow, tHigh);
+      remote(host_id)->assoc_get_local(_return, shard_id, src, atype,
+                                       dstIdSet, tLow, tHigh);
     }
   }
 
@@ -724,9 +856,9 @@ class GraphQueryAggregatorServiceHandler :
             src, atype, dstIdSet, tLow, tHigh);
         local_futures.push_back(std::move(future));
       } else {
-        aggregators_.at(next_host_id).send_assoc_get_local(it->shardId, src,
-                                                           atype, dstIdSet,
-                                                           tLow, tHigh);
+        remote(next_host_id)->send_assoc_get_local(it->shardId, src,
+                                                   atype, dstIdSet,
+                                                   tLow, tHigh);
       }
     }
 
@@ -751,7 +883,7 @@ class GraphQueryAggregatorServiceHandler :
       int next_host_id = host_id_for_shard(it->shardId);
       COND_LOG_E("Update ptrs: Next host id = %d\n", next_host_id);
       if (next_host_id != local_host_id_) {
-        aggregators_.at(next_host_id).recv_assoc_get_local(assocs);
+        reply(next_host_id)->recv_assoc_get_local(assocs);
       }
       _return.insert(_return.end(), assocs.begin(), assocs.end());
     }
@@ -763,8 +895,9 @@ class GraphQueryAggregatorServiceHandler :
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    int shard_id = nodeId % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(nodeId);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     COND_LOG_E("Received obj_get for nodeId = %lld\n", nodeId);
 
@@ -773,7 +906,7 @@ class GraphQueryAggregatorServiceHandler :
       obj_get_local(_return, shard_id, nodeId);
     } else {
       COND_LOG_E("Forwarding to shard %d on host %d.\n", shard_id, host_id);
-      aggregators_.at(host_id).obj_get_local(_return, shard_id, nodeId);
+      remote(host_id)->obj_get_local(_return, shard_id, nodeId);
     }
   }
 
@@ -789,8 +922,9 @@ class GraphQueryAggregatorServiceHandler :
     // TODO: Add check for key range to determine if object lies within SuccinctStore shards or LogStore shards
     COND_LOG_E("Shard index = %d, number of shards on this server = %zu\n",
         shard_idx, local_shards_.size());
-    local_shards_.at(shard_idx)->obj_get(
-        _return, global_to_local_node_id(nodeId, shardId));
+    on_local_shard(shard_idx, TaskPriority::HIGH, [&](AsyncGraphShard* shard) {
+      shard->obj_get(_return, shard_router_.local_key(nodeId));
+    });
   }
 
   void assoc_time_range(std::vector<ThriftAssoc>& _return, const int64_t src,
@@ -799,15 +933,16 @@ class GraphQueryAggregatorServiceHandler :
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    int shard_id = src % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(src);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     if (host_id == local_host_id_) {
       assoc_time_range_local(_return, shard_id, src, atype, tLow, tHigh, limit);
     } else {
-      aggregators_.at(host_id).assoc_time_range_local(_return, shard_id, src,
-                                                      atype, tLow, tHigh,
-                                                      limit);
+      remote(host_id)->assoc_time_range_local(_return, shard_id, src,
+                                              atype, tLow, tHigh,
+                                              limit);
     }
   }
 
@@ -840,10 +975,10 @@ class GraphQueryAggregatorServiceHandler :
             src, atype, tLow, tHigh, limit);
         local_futures.push_back(std::move(future));
       } else {
-        aggregators_.at(next_host_id).send_assoc_time_range_local(it->shardId,
-                                                                  src, atype,
-                                                                  tLow, tHigh,
-                                                                  limit);
+        remote(next_host_id)->send_assoc_time_range_local(it->shardId,
+                                                          src, atype,
+                                                          tLow, tHigh,
+                                                          limit);
       }
     }
 
@@ -874,7 +1009,7 @@ class GraphQueryAggregatorServiceHandler :
       // int64_t offset = ptr.offset; // TODO: add optimization
       int next_host_id = host_id_for_shard(it->shardId);
       if (next_host_id != local_host_id_) {
-        aggregators_.at(next_host_id).recv_assoc_time_range_local(assocs);
+        reply(next_host_id)->recv_assoc_time_range_local(assocs);
       }
 
       if (_return.size() + assocs.size() <= limit) {
@@ -908,23 +1043,24 @@ class GraphQueryAggregatorServiceHandler :
 
       start = get_timestamp();
       if (obj != -1) {
-        int primary_shard_id = obj % num_succinctstore_shards_;
-        int primary_host_id = host_id_for_shard(primary_shard_id);
-        // assert(local_host_id_ != primary_host_id); // No loger holds
-
-        COND_LOG_E("Updating host %d, shard %d about obj(%lld)\n",
-            primary_host_id, primary_shard_id, obj);
-
-        if (primary_host_id == local_host_id_) {
-          record_node_append(
-              num_succinctstore_shards_ + num_suffixstore_shards_
-                  + num_logstore_shards_ - 1,
-              primary_shard_id, obj);
-        } else {
-          aggregators_.at(primary_host_id).record_node_append(
-              num_succinctstore_shards_ + num_suffixstore_shards_
-                  + num_logstore_shards_ - 1,
-              primary_shard_id, obj);
+        int primary_shard_id = shard_for_node(obj);
+        for (int primary_host_id : hosts_for_shard(primary_shard_id)) {
+          // assert(local_host_id_ != primary_host_id); // No loger holds
+
+          COND_LOG_E("Updating host %d, shard %d about obj(%lld)\n",
+              primary_host_id, primary_shard_id, obj);
+
+          if (primary_host_id == local_host_id_) {
+            record_node_append(
+                num_succinctstore_shards_ + num_suffixstore_shards_
+                    + num_logstore_shards_ - 1,
+                primary_shard_id, obj);
+          } else {
+            remote(primary_host_id)->record_node_append(
+                num_succinctstore_shards_ + num_suffixstore_shards_
+                    + num_logstore_shards_ - 1,
+                primary_shard_id, obj);
+          }
         }
       }
       end = get_timestamp();
@@ -932,7 +1068,7 @@ class GraphQueryAggregatorServiceHandler :
           (end - start));
     } else {
       COND_LOG_E("Forwarding assoc_add to host %d\n", (total_num_hosts_ - 1));
-      return aggregators_.at(total_num_hosts_ - 1).obj_add(attrs);
+      return remote(total_num_hosts_ - 1)->obj_add(attrs);
     }
 
     return 0;
@@ -954,27 +1090,29 @@ class GraphQueryAggregatorServiceHandler :
       int ret = local_shards_.back()->assoc_add(src, atype, dst, time, attr);
 
       if (!ret) {
-        int primary_shard_id = src % num_succinctstore_shards_;
-        int primary_host_id = host_id_for_shard(primary_shard_id);
-        // assert(local_host_id_ != primary_host_id); // No loger holds
+        int primary_shard_id = shard_for_node(src);
 
         ThriftSrcAtype src_atype;
         src_atype.src = src;
         src_atype.atype = atype;
 
-        COND_LOG_E("Updating host %d, shard %d about (%lld,%d)\n",
-            primary_host_id, primary_shard_id, src, atype);
-
-        if (primary_host_id == local_host_id_) {
-          record_edge_updates(
-              num_succinctstore_shards_ + num_suffixstore_shards_
-                  + num_logstore_shards_ - 1,
-              primary_shard_id, { src_atype });
-        } else {
-          aggregators_.at(primary_host_id).record_edge_updates(
-              num_succinctstore_shards_ + num_suffixstore_shards_
-                  + num_logstore_shards_ - 1,
-              primary_shard_id, { src_atype });
+        for (int primary_host_id : hosts_for_shard(primary_shard_id)) {
+          // assert(local_host_id_ != primary_host_id); // No loger holds
+
+          COND_LOG_E("Updating host %d, shard %d about (%lld,%d)\n",
+              primary_host_id, primary_shard_id, src, atype);
+
+          if (primary_host_id == local_host_id_) {
+            record_edge_updates(
+                num_succinctstore_shards_ + num_suffixstore_shards_
+                    + num_logstore_shards_ - 1,
+                primary_shard_id, { src_atype });
+          } else {
+            remote(primary_host_id)->record_edge_updates(
+                num_succinctstore_shards_ + num_suffixstore_shards_
+                    + num_logstore_shards_ - 1,
+                primary_shard_id, { src_atype });
+          }
         }
       }
 
@@ -983,8 +1121,8 @@ class GraphQueryAggregatorServiceHandler :
       return ret;
     } else {
       COND_LOG_E("Forwarding assoc_add to host %d\n", (total_num_hosts_ - 1));
-      return aggregators_.at(total_num_hosts_ - 1).assoc_add(src, atype, dst,
-                                                             time, attr);
+      return remote(total_num_hosts_ - 1)->assoc_add(src, atype, dst,
+                                                     time, attr);
     }
   }
 
@@ -1009,10 +1147,13 @@ class GraphQueryAggregatorServiceHandler :
         // This request is for the LogStore shard, don't mess with id.
         local_id = id;
       } else {
-        local_id = global_to_local_node_id(id, shard_id);
+        local_id = shard_router_.local_key(id);
       }
 
-      local_shards_.at(shard_idx)->getNode(data, local_id);
+      on_local_shard(shard_idx, TaskPriority::HIGH,
+                     [&](AsyncGraphShard* shard) {
+        shard->getNode(data, local_id);
+      });
     } catch (std::exception& e) {
       LOG_E("Exception at getNodeLocal: %s\n", e.what());
     }
@@ -1024,8 +1165,9 @@ class GraphQueryAggregatorServiceHandler :
 
     data = "";
 
-    int shard_id = id % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(id);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     COND_LOG_E("Received getNode for nodeId = %lld\n", id);
 
@@ -1034,7 +1176,7 @@ class GraphQueryAggregatorServiceHandler :
       getNodeLocal(data, shard_id, id);
     } else {
       COND_LOG_E("Forwarding to shard %d on host %d.\n", shard_id, host_id);
-      aggregators_.at(host_id).getNodeLocal(data, shard_id, id);
+      remote(host_id)->getNodeLocal(data, shard_id, id);
 
     }
 
@@ -1046,9 +1188,9 @@ class GraphQueryAggregatorServiceHandler :
         getNodeLocal(data, total_num_shards_, id);
       } else {
         COND_LOG_E("LogStore shard is not local, forwarding to remote host.\n");
-        aggregators_.at(total_num_hosts_ - 1).getNodeLocal(data,
-                                                           total_num_shards_,
-                                                           id);
+        remote(total_num_hosts_ - 1)->getNodeLocal(data,
+                                                   total_num_shards_,
+                                                   id);
       }
     }
   }
@@ -1064,7 +1206,7 @@ class GraphQueryAggregatorServiceHandler :
       return local_shards_.back()->addNode(id, data);
     } else {
       COND_LOG_E("Forwarding addNode to host %d\n", (total_num_hosts_ - 1));
-      return aggregators_.at(total_num_hosts_ - 1).addNode(id, data);
+      return remote(total_num_hosts_ - 1)->addNode(id, data);
     }
 
     return 0;
@@ -1086,29 +1228,34 @@ class GraphQueryAggregatorServiceHandler :
       // This request is for the LogStore shard, don't mess with id.
       local_id = id;
     } else {
-      local_id = global_to_local_node_id(id, shard_id);
+      local_id = shard_router_.local_key(id);
     }
 
     COND_LOG_E("Final deleteNode request with local_id = %lld\n", local_id);
-    return local_shards_.at(shard_idx)->deleteNode(local_id);
+    return on_local_shard(shard_idx, TaskPriority::NORMAL,
+                          [&](AsyncGraphShard* shard) {
+      return shard->deleteNode(local_id);
+    });
   }
 
   bool deleteNode(int64_t id) {
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    int shard_id = id % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(id);
 
     COND_LOG_E("Received deleteNode for nodeId = %lld\n", id);
 
+    // Every copy of the shard marks the node deleted.
     bool deleted = false;
-    if (host_id == local_host_id_) {
-      COND_LOG_E("Shard %d is local.\n", shard_id);
-      deleted = deleteNodeLocal(shard_id, id);
-    } else {
-      COND_LOG_E("Forwarding to shard %d on host %d.\n", shard_id, host_id);
-      deleted = aggregators_.at(host_id).deleteNodeLocal(shard_id, id);
+    for (int host_id : hosts_for_shard(shard_id)) {
+      if (host_id == local_host_id_) {
+        COND_LOG_E("Shard %d is local.\n", shard_id);
+        deleted |= deleteNodeLocal(shard_id, id);
+      } else {
+        COND_LOG_E("Forwarding to shard %d on host %d.\n", shard_id, host_id);
+        deleted |= remote(host_id)->deleteNodeLocal(shard_id, id);
+      }
     }
 
     // If the regular lookup did not yield results, search the log store.
@@ -1119,8 +1266,8 @@ class GraphQueryAggregatorServiceHandler :
         return deleteNodeLocal(total_num_shards_, id);
       } else {
         COND_LOG_E("LogStore shard is not local, forwarding to remote host.\n");
-        aggregators_.at(total_num_hosts_ - 1).deleteNodeLocal(total_num_shards_,
-                                                              id);
+        remote(total_num_hosts_ - 1)->deleteNodeLocal(total_num_shards_,
+                                                      id);
       }
     }
 
@@ -1149,8 +1296,10 @@ class GraphQueryAggregatorServiceHandler :
         id2);
 
     // First try designated shard
-    bool found = local_shards_.at(shard_idx)->getLink(link, id1, link_type,
-                                                      id2);
+    bool found = on_local_shard(shard_idx, TaskPriority::HIGH,
+                                [&](AsyncGraphShard* shard) {
+      return shard->getLink(link, id1, link_type, id2);
+    });
     if (!found) {
       COND_LOG_E(
           "Edge not found in SuccinctStore, perhaps it exists in the LogStore.\n");
@@ -1167,12 +1316,15 @@ class GraphQueryAggregatorServiceHandler :
         if (next_host_id == local_host_id_) {
           int shard_idx_local = shard_id_to_shard_idx(ptr.shardId);
           COND_LOG_E("LogStore is local at shard idx=%lld\n", shard_idx_local);
-          local_shards_.at(shard_idx_local)->getLink(link, id1, link_type, id2);
+          on_local_shard(shard_idx_local, TaskPriority::HIGH,
+                         [&](AsyncGraphShard* shard) {
+            return shard->getLink(link, id1, link_type, id2);
+          });
         } else {
           COND_LOG_E("LogStore is remote at host id = %lld, shard id=%lld\n",
               next_host_id, ptr.shardId);
-          aggregators_.at(next_host_id).getLinkLocal(link, ptr.shardId, id1,
-                                                     link_type, id2);
+          remote(next_host_id)->getLinkLocal(link, ptr.shardId, id1,
+                                             link_type, id2);
         }
       }
     }
@@ -1185,14 +1337,15 @@ class GraphQueryAggregatorServiceHandler :
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    int shard_id = id1 % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(id1);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     if (host_id == local_host_id_) {
       getLinkLocal(link, shard_id, id1, link_type, id2);
     } else {
-      aggregators_.at(host_id).getLinkLocal(link, shard_id, id1, link_type,
-                                            id2);
+      remote(host_id)->getLinkLocal(link, shard_id, id1, link_type,
+                                    id2);
     }
   }
 
@@ -1211,26 +1364,28 @@ class GraphQueryAggregatorServiceHandler :
       bool added = local_shards_.back()->addLink(link);
 
       if (added) {
-        int primary_shard_id = link.srcId % num_succinctstore_shards_;
-        int primary_host_id = host_id_for_shard(primary_shard_id);
-        // assert(local_host_id_ != primary_host_id); // No loger holds
+        int primary_shard_id = shard_for_node(link.srcId);
 
         ThriftSrcAtype src_atype;
         src_atype.src = link.srcId;
         src_atype.atype = link.atype;
 
         int32_t logstore_shard_id = total_num_shards_;
-        COND_LOG_E(
-            "Adding update ptr to shard %lld for edge-record identified by (id1=%lld, link_type=%lld) at primary shard %lld, host %lld\n",
-            logstore_shard_id, link.srcId, link.atype, primary_shard_id,
-            primary_host_id);
-
-        if (primary_host_id == local_host_id_) {
-          record_edge_updates(logstore_shard_id, primary_shard_id,
-                              { src_atype });
-        } else {
-          aggregators_.at(primary_host_id).record_edge_updates(
-              logstore_shard_id, primary_shard_id, { src_atype });
+        for (int primary_host_id : hosts_for_shard(primary_shard_id)) {
+          // assert(local_host_id_ != primary_host_id); // No loger holds
+
+          COND_LOG_E(
+              "Adding update ptr to shard %lld for edge-record identified by (id1=%lld, link_type=%lld) at primary shard %lld, host %lld\n",
+              logstore_shard_id, link.srcId, link.atype, primary_shard_id,
+              primary_host_id);
+
+          if (primary_host_id == local_host_id_) {
+            record_edge_updates(logstore_shard_id, primary_shard_id,
+                                { src_atype });
+          } else {
+            remote(primary_host_id)->record_edge_updates(
+                logstore_shard_id, primary_shard_id, { src_atype });
+          }
         }
       }
 
@@ -1239,7 +1394,7 @@ class GraphQueryAggregatorServiceHandler :
       COND_LOG_E("Finished update!\n");
     } else {
       COND_LOG_E("Forwarding assoc_add to host %d\n", (total_num_hosts_ - 1));
-      return aggregators_.at(total_num_hosts_ - 1).addLink(link);
+      return remote(total_num_hosts_ - 1)->addLink(link);
     }
   }
 
@@ -1254,7 +1409,10 @@ class GraphQueryAggregatorServiceHandler :
         link_type, id2);
 
     // First try designated shard
-    bool deleted = local_shards_.at(shard_idx)->deleteLink(id1, link_type, id2);
+    bool deleted = on_local_shard(shard_idx, TaskPriority::NORMAL,
+                                  [&](AsyncGraphShard* shard) {
+      return shard->deleteLink(id1, link_type, id2);
+    });
     if (!deleted) {
       std::vector<ThriftEdgeUpdatePtr> ptrs;
       get_edge_update_ptrs(ptrs, shard_idx, id1, link_type);
@@ -1266,14 +1424,15 @@ class GraphQueryAggregatorServiceHandler :
         int next_host_id = host_id_for_shard(ptr.shardId);
         if (next_host_id == local_host_id_) {
           int shard_idx_local = shard_id_to_shard_idx(ptr.shardId);
-          deleted = local_shards_.at(shard_idx_local)->deleteLink(id1,
-                                                                  link_type,
-                                                                  id2);
+          deleted = on_local_shard(shard_idx_local, TaskPriority::NORMAL,
+                                   [&](AsyncGraphShard* shard) {
+            return shard->deleteLink(id1, link_type, id2);
+          });
         } else {
-          deleted = aggregators_.at(next_host_id).deleteLinkLocal(ptr.shardId,
-                                                                  id1,
-                                                                  link_type,
-                                                                  id2);
+          deleted = remote(next_host_id)->deleteLinkLocal(ptr.shardId,
+                                                          id1,
+                                                          link_type,
+                                                          id2);
         }
       }
     }
@@ -1287,15 +1446,20 @@ class GraphQueryAggregatorServiceHandler :
     assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
     assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
 
-    int shard_id = id1 % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(id1);
 
-    if (host_id == local_host_id_) {
-      return deleteLinkLocal(shard_id, id1, link_type, id2);
-    } else {
-      return aggregators_.at(host_id).deleteLinkLocal(shard_id, id1, link_type,
-                                                      id2);
+    // Every copy of the shard marks the edge deleted; the first to find it
+    // only in the LogStore deletes it there.
+    bool deleted = false;
+    for (int host_id : hosts_for_shard(shard_id)) {
+      if (host_id == local_host_id_) {
+        deleted |= deleteLinkLocal(shard_id, id1, link_type, id2);
+      } else {
+        deleted |= remote(host_id)->deleteLinkLocal(shard_id, id1, link_type,
+                                                    id2);
+      }
     }
+    return deleted;
   }
 
   bool updateLink(const Link& link) {
@@ -1345,14 +1509,17 @@ class GraphQueryAggregatorServiceHandler :
       } else {
         COND_LOG_E("LogStore shard is remote at host = %lld, shard_id = %lld\n",
             update_host_id, ptr.shardId);
-        aggregators_.at(update_host_id).send_getLinkListLocal(ptr.shardId, id1,
-                                                              link_type);
+        remote(update_host_id)->send_getLinkListLocal(ptr.shardId, id1,
+                                                      link_type);
       }
     }
 
     // Then process query at designated shard.
     COND_LOG_E("Processing query at designated shard.\n");
-    local_shards_.at(shard_idx)->getLinkList(assocs, id1, link_type);
+    on_local_shard(shard_idx, TaskPriority::NORMAL,
+                   [&](AsyncGraphShard* shard) {
+      shard->getLinkList(assocs, id1, link_type);
+    });
 
     // Finally process the responce from LogStore shard.
     if (!ptrs.empty()) {
@@ -1362,7 +1529,7 @@ class GraphQueryAggregatorServiceHandler :
       if (update_host_id == local_host_id_) {
         update_assocs = update_future.get();
       } else {
-        aggregators_.at(update_host_id).recv_getLinkListLocal(update_assocs);
+        reply(update_host_id)->recv_getLinkListLocal(update_assocs);
       }
 
       // Add responses from LogStore to result
@@ -1382,8 +1549,9 @@ class GraphQueryAggregatorServiceHandler :
     COND_LOG_E("Received getLinkList(id1=%lld, link_type=%lld) request\n", id1,
         link_type);
 
-    int shard_id = id1 % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(id1);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     if (host_id == local_host_id_) {
       COND_LOG_E("Forwarding to local shard %lld\n", shard_id);
@@ -1391,8 +1559,8 @@ class GraphQueryAggregatorServiceHandler :
     } else {
       COND_LOG_E("Forwarding to remote shard %lld on host %lld\n", shard_id,
           host_id);
-      aggregators_.at(host_id).getLinkListLocal(assocs, shard_id, id1,
-                                                link_type);
+      remote(host_id)->getLinkListLocal(assocs, shard_id, id1,
+                                        link_type);
     }
   }
 
@@ -1438,7 +1606,7 @@ class GraphQueryAggregatorServiceHandler :
       } else {
         COND_LOG_E("LogStore shard is remote at host = %lld, shard_id = %lld\n",
             update_host_id, ptr.shardId);
-        aggregators_.at(update_host_id).send_getFilteredLinkListLocal(
+        remote(update_host_id)->send_getFilteredLinkListLocal(
             ptr.shardId, id1, link_type, min_timestamp, max_timestamp, offset,
             limit);
       }
@@ -1446,10 +1614,11 @@ class GraphQueryAggregatorServiceHandler :
 
     // Then process query at designated shard.
     COND_LOG_E("Processing query at designated shard.\n");
-    local_shards_.at(shard_idx)->getFilteredLinkList(assocs, id1, link_type,
-                                                     min_timestamp,
-                                                     max_timestamp, offset,
-                                                     limit);
+    on_local_shard(shard_idx, TaskPriority::NORMAL,
+                   [&](AsyncGraphShard* shard) {
+      shard->getFilteredLinkList(assocs, id1, link_type, min_timestamp,
+                                 max_timestamp, offset, limit);
+    });
 
     // Finally process the responce from LogStore shard.
     if (!ptrs.empty()) {
@@ -1458,7 +1627,7 @@ class GraphQueryAggregatorServiceHandler :
       if (update_host_id == local_host_id_) {
         update_assocs = update_future.get();
       } else {
-        aggregators_.at(update_host_id).recv_getFilteredLinkListLocal(
+        reply(update_host_id)->recv_getFilteredLinkListLocal(
             update_assocs);
       }
 
@@ -1494,8 +1663,9 @@ class GraphQueryAggregatorServiceHandler :
         "Received getFilteredLinkList(id1=%lld, link_type=%lld, min_timestamp=%lld, max_timestamp=%lld, offset=%lld, limit=%lld) request\n",
         id1, link_type, min_timestamp, max_timestamp, offset, limit);
 
-    int shard_id = id1 % total_num_shards_;
-    int host_id = shard_id % num_succinctstore_hosts_;
+    int shard_id = shard_for_node(id1);
+    ReplicaSelector::Call replica = read_replica(shard_id);
+    int host_id = replica.host();
 
     if (host_id == local_host_id_) {
       COND_LOG_E("Forwarding to local shard %lld\n", shard_id);
@@ -1504,11 +1674,11 @@ class GraphQueryAggregatorServiceHandler :
     } else {
       COND_LOG_E("Forwarding to remote shard %lld on host %lld\n", shard_id,
           host_id);
-      aggregators_.at(host_id).getFilteredLinkListLocal(assocs, shard_id, id1,
-                                                        link_type,
-                                                        min_timestamp,
-                                                        max_timestamp, offset,
-                                                        limit);
+      remote(host_id)->getFilteredLinkListLocal(assocs, shard_id, id1,
+                                                link_type,
+                                                min_timestamp,
+                                                max_timestamp, offset,
+                                                limit);
     }
   }
 
@@ -1516,21 +1686,72 @@ class GraphQueryAggregatorServiceHandler :
     return assoc_count(id1, link_type);
   }
 
+  void get_stats(std::string& _return) {
+    _return = Metrics::to_json();
+  }
+
+  void trace_next(const int64_t trace_id) {
+    next_trace_id = trace_id;
+  }
+
  private:
 
-// globalKey = localKey * numShards + shardId
-// localKey = (globalKey - shardId) / numShards
-  inline int64_t global_to_local_node_id(int64_t global_node_id, int shard_id) {
-    assert(total_num_shards_ > 0 && "total_num_shards_ <= 0");
-    return (global_node_id - shard_id) / total_num_shards_;
+// A call to the aggregator on another host; traced as a "network" span
+// covering the call, if the query is traced.
+  class RemoteCall {
+   public:
+    RemoteCall(GraphQueryAggregatorServiceClient& client)
+        : client_(client),
+          span_("network") {
+    }
+    GraphQueryAggregatorServiceClient* operator->() {
+      return &client_;
+    }
+   private:
+    GraphQueryAggregatorServiceClient& client_;
+    Trace::Span span_;
+  };
+
+// Aggregator on host `host_id`, for forwarding a query to it.  A traced
+// query's trace id is sent ahead, so the remote host traces its part too.
+  inline RemoteCall remote(int host_id) {
+    Metrics::add(kRemoteCalls);
+    GraphQueryAggregatorServiceClient& client = aggregators_.at(host_id);
+    if (Trace::current() != 0) {
+      client.trace_next(Trace::current());
+    }
+    return RemoteCall(client);
+  }
+
+// Aggregator on host `host_id`, for receiving the reply of a call sent
+// earlier with remote(host_id)->send_*().
+  inline RemoteCall reply(int host_id) {
+    return RemoteCall(aggregators_.at(host_id));
+  }
+
+// Runs `f` on local shard `shard_idx` and returns its result.  Shards
+// placed on a NUMA node are queried from that node, by a pool worker pinned
+// there, at `priority`; the handler thread waits for it rather than moving.
+  template<class F>
+  inline auto on_local_shard(int shard_idx, TaskPriority priority, F f)
+  -> decltype(f(nullptr)) {
+    AsyncGraphShard* shard = local_shards_.at(shard_idx);
+    return shard->run_on_node(priority, [&] {
+      return f(shard);
+    });
+  }
+
+// Shard holding node `node_id`'s attributes and edge lists, as the input was
+// partitioned.
+  inline int shard_for_node(int64_t node_id) {
+    return shard_router_.shard_of(node_id);
   }
 
-// Host 0 to n 1: the SuccinctStores, hash-partitioned
-// Host n - 1: the empty LogStore
+// SuccinctStore shards: wherever the host router puts them
+// Host n - 1: the empty LogStore, too
   inline int host_id_for_shard(int shard_id) {
     if (!multistore_enabled_ || shard_id < num_succinctstore_shards_) {
-      assert(num_succinctstore_hosts_ > 0 && "num_succinctstore_hosts_ <= 0");
-      return shard_id % num_succinctstore_hosts_;
+      return host_router_.host_of(shard_id);
     }
     // FIXME
     COND_LOG_E("LogStore shard %d resides on host %d\n", shard_id,
@@ -1538,33 +1759,60 @@ class GraphQueryAggregatorServiceHandler :
     return num_succinctstore_hosts_ - 1;
   }
 
-// Limitation: this assumes 1 LogStore machine.
-  inline int shard_id_to_shard_idx(int shard_id) {
-    if (!multistore_enabled_) {
-      assert(total_num_hosts_ > 0 && "total_num_hosts_ <= 0");
-      return shard_id / total_num_hosts_;
+// Hosts with a copy of shard `shard_id`, the primary first.  Deletes and
+// update pointers for its nodes go to all of them.
+  inline std::vector<int32_t> hosts_for_shard(int shard_id) {
+    if (!multistore_enabled_ || shard_id < num_succinctstore_shards_) {
+      return host_router_.hosts_of(shard_id);
+    }
+    return std::vector<int32_t>(1, host_id_for_shard(shard_id));
+  }
+
+// Host to read shard `shard_id` from: its primary, or if it is replicated,
+// whichever copy the replica selector ranks least loaded.  The read is
+// tracked until the returned call goes out of scope.
+  inline ReplicaSelector::Call read_replica(int shard_id) {
+    int host_id = host_id_for_shard(shard_id);
+    if (shard_id < total_num_shards_
+        && host_router_.replication(shard_id) > 1) {
+      int primary_host_id = host_id;
+      host_id = replica_selector_.pick(host_router_.hosts_of(shard_id),
+                                       local_host_id_);
+      if (host_id != primary_host_id) {
+        Metrics::add(kReplicaReads);
+      }
     }
+    return replica_selector_.begin(host_id);
+  }
 
+// Whether local shard `shard_idx` is a read replica, which scans over all
+// shards skip: its primary covers it.
+  inline bool is_replica(int shard_idx) {
+    return shard_idx < local_shard_ids_.size()
+        && host_id_for_shard(local_shard_ids_[shard_idx]) != local_host_id_;
+  }
+
+// Limitation: this assumes 1 LogStore machine.
+  inline int shard_id_to_shard_idx(int shard_id) {
     COND_LOG_E("Converting shard id %d to shard idx\n", shard_id);
-    int diff = shard_id - total_num_shards_;
-    if (diff >= 0) {
+    if (shard_id >= total_num_shards_) {
       COND_LOG_E(
           "Shard id %d >= number of SuccinctStore shards %d, returning LogStore shard id.\n",
           shard_id, num_succinctstore_shards_);
       return local_shards_.size() - 1;  // log store
     }
-    return shard_id / num_succinctstore_hosts_;  // succinct st., round-robin
+    assert(local_shard_idx_[shard_id] >= 0 && "shard is not on this host");
+    return local_shard_idx_[shard_id];
   }
 
 // Limitation: this assumes 1 SuffixStore machine and 1 LogStore machine.
   inline int shard_idx_to_shard_id(int shard_idx) {
-    if (local_host_id_ < num_succinctstore_hosts_
-        && shard_idx < local_num_shards_) {
-      return shard_idx * num_succinctstore_hosts_ + local_host_id_;
+    if (shard_idx < local_shard_ids_.size()) {
+      return local_shard_ids_[shard_idx];
     } else {
       // case: log store machine
       assert(local_host_id_ == num_succinctstore_hosts_ - 1);
-      return shard_idx + num_succinctstore_shards_;
+      return shard_idx - local_shard_ids_.size() + num_succinctstore_shards_;
     }
   }
 
@@ -1586,12 +1834,96 @@ class GraphQueryAggregatorServiceHandler :
 
   std::vector<AsyncGraphShard*> local_shards_;
 
+// Shard of every node, host of every shard, and load of every host; shared
+// by all handlers.
+  const ShardRouter& shard_router_;
+  const HostRouter& host_router_;
+  ReplicaSelector& replica_selector_;
+
+// Shards with a copy on this host, and the index of each shard among them,
+// or -1.
+  std::vector<int32_t> local_shard_ids_;
+  std::vector<int> local_shard_idx_;
+
 // Maps host id to aggregator handle.  Does not contain self.
   std::unordered_map<int, GraphQueryAggregatorServiceClient> aggregators_;
   std::vector<shared_ptr<TTransport>> aggregator_transports_;
 
 };
 
+// Records the latency of every RPC served, in a histogram per method, and
+// traces sampled queries.  A query is traced if its caller sent a trace id
+// ahead of it (trace_next), or if it starts here and is sampled.
+class RpcEventHandler : public TProcessorEventHandler {
+ public:
+  void* getContext(const char* fn_name, void* server_context) {
+    RpcContext* ctx = new RpcContext();
+    ctx->start_ns = Metrics::now_ns();
+    ctx->trace_id = next_trace_id;
+    next_trace_id = 0;
+    if (ctx->trace_id == 0) {
+      int64_t sampled = Trace::sample();
+      if (sampled != 0 && !is_forwarded(method_name(fn_name))) {
+        ctx->trace_id = sampled;
+      }
+    }
+    if (ctx->trace_id != 0) {
+      ctx->trace_start_ns = Trace::now_ns();
+      Trace::set_current(ctx->trace_id);
+    }
+    return ctx;
+  }
+
+  void freeContext(void* ctx, const char* fn_name) {
+    RpcContext* rpc = static_cast<RpcContext*>(ctx);
+    Metrics::record(histogram_for(fn_name), Metrics::now_ns() - rpc->start_ns);
+    if (rpc->trace_id != 0) {
+      Trace::record(method_name(fn_name), rpc->trace_id, rpc->trace_start_ns,
+                    Trace::now_ns());
+      Trace::set_current(0);
+    }
+    delete rpc;
+  }
+
+ private:
+  struct RpcContext {
+    uint64_t start_ns;
+    int64_t trace_id;
+    uint64_t trace_start_ns;
+  };
+
+  // fn_name is "<service>.<method>", a string literal in the generated
+  // processor; so are its suffixes.
+  static const char* method_name(const char* fn_name) {
+    const char* dot = strchr(fn_name, '.');
+    return dot == NULL ? fn_name : dot + 1;
+  }
+
+  // Calls made by other aggregators on behalf of a query, which are traced
+  // only as part of it.
+  static bool is_forwarded(const char* method) {
+    std::string name(method);
+    auto ends_with = [&name](const std::string& suffix) {
+      return name.size() >= suffix.size()
+          && name.compare(name.size() - suffix.size(), suffix.size(),
+                          suffix) == 0;
+    };
+    return ends_with("_local") || ends_with("Local")
+        || name.compare(0, 7, "record_") == 0 || name == "trace_next";
+  }
+
+  // The address of fn_name identifies the method.
+  static Metrics::Id histogram_for(const char* fn_name) {
+    static thread_local std::unordered_map<const char*, Metrics::Id> ids;
+    auto it = ids.find(fn_name);
+    if (it != ids.end()) {
+      return it->second;
+    }
+    std::string name(method_name(fn_name));
+    return ids[fn_name] = Metrics::histogram("rpc." + name + "_ns");
+  }
+};
+
 // Dummy factory that just delegates fields.
 class ProcessorFactory : public TProcessorFactory {
  public:
@@ -1599,7 +1931,10 @@ class ProcessorFactory : public TProcessorFactory {
                    int local_host_id, const std::vector<std::string>& hostnames,
                    bool multistore_enabled, int num_suffixstore_shards,
                    int num_logstore_shards,
-                   const std::vector<AsyncGraphShard*>& shards)
+                   const std::vector<AsyncGraphShard*>& shards,
+                   const ShardRouter& shard_router,
+                   const HostRouter& host_router,
+                   ReplicaSelector& replica_selector)
       : total_num_shards_(total_num_shards),
         local_num_shards_(local_num_shards),
         local_host_id_(local_host_id),
@@ -1607,7 +1942,11 @@ class ProcessorFactory : public TProcessorFactory {
         multistore_enabled_(multistore_enabled),
         num_suffixstore_shards_(num_suffixstore_shards),
         num_logstore_shards_(num_logstore_shards),
-        shards_(shards) {
+        shards_(shards),
+        shard_router_(shard_router),
+        host_router_(host_router),
+        replica_selector_(replica_selector),
+        event_handler_(new RpcEventHandler()) {
   }
 
   boost::shared_ptr<TProcessor> getProcessor(const TConnectionInfo&) {
@@ -1615,11 +1954,15 @@ class ProcessorFactory : public TProcessorFactory {
         new GraphQueryAggregatorServiceHandler(total_num_shards_,
                                                local_num_shards_,
                                                local_host_id_, hostnames_,
-                                               shards_, multistore_enabled_,
+                                               shards_, shard_router_,
+                                               host_router_,
+                                               replica_selector_,
+                                               multistore_enabled_,
                                                num_suffixstore_shards_,
                                                num_logstore_shards_));
     boost::shared_ptr<TProcessor> handlerProcessor(
         new GraphQueryAggregatorServiceProcessor(handler));
+    handlerProcessor->setEventHandler(event_handler_);
     return handlerProcessor;
   }
 
@@ -1629,13 +1972,22 @@ class ProcessorFactory : public TProcessorFactory {
   int local_host_id_;
   const std::vector<std::string>& hostnames_;
   const std::vector<AsyncGraphShard*> shards_;
+  const ShardRouter& shard_router_;
+  const HostRouter& host_router_;
+  ReplicaSelector& replica_selector_;
   bool multistore_enabled_;
   int num_suffixstore_shards_, num_logstore_shards_;
+  boost::shared_ptr<TProcessorEventHandler> event_handler_;
 };
 
 void print_usage(char *exec) {
   LOG_E("Usage: %s [-t total_num_shards] [-s local_num_shards] "
-        "[-h hostsfile] [-i local_host_id]\n",
+        "[-h hostsfile] [-i local_host_id] [-T trace_sample_rate] "
+        "[-o trace_file] [-n T|F (NUMA placement)] "
+        "[-g none|thp|hugetlb (huge pages)] [-d logstore_snapshot_dir] "
+        "[-w logstore_snapshot_secs] [-r shard_router_file] "
+        "[-R modulo|range|consistent[:points]|table:<file> (host routing)] "
+        "[-P replication_file] [-b outstanding|latency (replica choice)]\n",
         exec);
 }
 
@@ -1703,6 +2055,10 @@ void crit_err_hdlr(int sig_num, siginfo_t * info, void * ucontext) {
   exit(EXIT_FAILURE);
 }
 
+void request_snapshot(int sig) {
+  snapshot_requested = 1;
+}
+
 void handler(int sig) {
   void *array[10];
   size_t size = backtrace(array, 10);
@@ -1740,8 +2096,17 @@ int main(int argc, char **argv) {
   bool multistore_enabled;
   int num_suffixstore_shards, num_logstore_shards;
   int sa_sampling_rate = 32, isa_sampling_rate = 64, npa_sampling_rate = 128;
-  std::string hostsfile;
-  while ((c = getopt(argc, argv, "t:s:i:h:f:l:m:x:y:z:")) != -1) {
+  LoadPolicy load_policy = LoadPolicy::EAGER;
+  bool numa_placement = false;
+  HugePagePolicy huge_pages = NO_HUGEPAGES;
+  uint64_t logstore_capacity_mb = 0;
+  int snapshot_secs = 0;
+  double trace_sample_rate = 0;
+  std::string hostsfile, trace_file, snapshot_dir, shard_router_file;
+  std::string host_routing("modulo"), replication_file;
+  ReplicaSelector::Policy replica_policy = ReplicaSelector::Policy::OUTSTANDING;
+  while ((c = getopt(argc, argv,
+                     "t:s:i:h:f:l:m:x:y:z:p:T:o:n:g:c:d:w:r:R:P:b:")) != -1) {
     switch (c) {
       case 't':
         total_num_shards = atoi(optarg);
@@ -1773,6 +2138,63 @@ int main(int argc, char **argv) {
       case 'z':
         npa_sampling_rate = atoi(optarg);
         break;
+      case 'p': {
+        std::string policy(optarg);
+        if (policy == "lazy") {
+          load_policy = LoadPolicy::LAZY;
+        } else if (policy == "eager-parallel") {
+          load_policy = LoadPolicy::EAGER_PARALLEL;
+        } else if (policy == "hot-set") {
+          load_policy = LoadPolicy::HOT_SET;
+        } else {
+          load_policy = LoadPolicy::EAGER;
+        }
+        break;
+      }
+      case 'T':
+        trace_sample_rate = atof(optarg);
+        break;
+      case 'o':
+        trace_file = optarg;
+        break;
+      case 'n':
+        numa_placement = (std::string(optarg) == "T");
+        break;
+      case 'g': {
+        std::string policy(optarg);
+        if (policy == "thp") {
+          huge_pages = TRANSPARENT_HUGEPAGES;
+        } else if (policy == "hugetlb") {
+          huge_pages = EXPLICIT_HUGEPAGES;
+        } else {
+          huge_pages = NO_HUGEPAGES;
+        }
+        break;
+      }
+      case 'c':
+        logstore_capacity_mb = strtoull(optarg, NULL, 10);
+        break;
+      case 'd':
+        snapshot_dir = optarg;
+        break;
+      case 'w':
+        snapshot_secs = atoi(optarg);
+        break;
+      case 'r':
+        shard_router_file = optarg;
+        break;
+      case 'R':
+        host_routing = optarg;
+        break;
+      case 'P':
+        replication_file = optarg;
+        break;
+      case 'b':
+        if (!ReplicaSelector::parse_policy(optarg, &replica_policy)) {
+          print_usage(argv[0]);
+          return -1;
+        }
+        break;
       default:
         LOG_E("Could not parse command line arguments.\n")
         ;
@@ -1791,6 +2213,46 @@ int main(int argc, char **argv) {
   std::string node_file = std::string(argv[optind]);
   std::string edge_file = std::string(argv[optind + 1]);
 
+  // Applies to every succinct structure loaded or constructed from here on.
+  SuccinctAllocator::SetHugePagePolicy(huge_pages);
+  if (logstore_capacity_mb > 0) {
+    KVLogStore::set_default_capacity(logstore_capacity_mb << 20);
+  }
+
+  // Nodes are on shard nodeId % total_num_shards, unless the input was
+  // partitioned otherwise; the partitioner then saved the router to use.
+  std::unique_ptr<ShardRouter> shard_router(
+      new ModuloShardRouter(total_num_shards));
+  if (!shard_router_file.empty()) {
+    shard_router = ShardRouter::load(shard_router_file, total_num_shards);
+    if (shard_router == nullptr) {
+      exit(1);
+    }
+    LOG_E("Routing nodes to shards by %s\n", shard_router_file.c_str());
+  }
+
+  // The shards this host serves follow from the host routing; it can change
+  // between restarts, as long as each host has the files of its shards.
+  std::unique_ptr<HostRouter> host_router = HostRouter::create(
+      host_routing, total_num_shards, hostnames);
+  if (host_router == nullptr) {
+    exit(1);
+  }
+  // Replicated shards are loaded, and read from, on the hosts following
+  // their primary's too.
+  if (!replication_file.empty()
+      && !host_router->load_replication(replication_file)) {
+    exit(1);
+  }
+  ReplicaSelector replica_selector(hostnames.size(), replica_policy);
+  std::vector<int32_t> local_shard_ids = host_router->shards_of(local_host_id);
+  if (local_shard_ids.size() != static_cast<size_t>(local_num_shards)) {
+    LOG_E("Host routing '%s' puts %zu shards on this host, not %d\n",
+          host_routing.c_str(), local_shard_ids.size(), local_num_shards);
+    local_num_shards = local_shard_ids.size();
+  }
+  const ShardRouter* router = shard_router.get();
+
   std::vector<AsyncGraphShard*> local_shards;
 
   local_shards.resize(local_num_shards);
@@ -1798,19 +2260,32 @@ int main(int argc, char **argv) {
   unsigned num_threads = std::thread::hardware_concurrency();
   num_threads = num_threads == 0 ? 64 : num_threads;
   LOG_E("Setting concurrency to %u\n", num_threads);
-  AsyncThreadPool *pool = new AsyncThreadPool(num_threads);
+  AsyncThreadPool *pool = new AsyncThreadPool(num_threads, numa_placement);
+  // With NUMA placement, shards are dealt round-robin to the NUMA nodes; each
+  // is loaded by a thread pinned to its node, so its heap and mapped pages
+  // are allocated there, and queried by threads on that node.
+  const std::vector<int>& numa_nodes = Numa::nodes();
+  if (numa_placement) {
+    LOG_E("Placing shards on %zu NUMA nodes\n", numa_nodes.size());
+  }
   LOG_E("Total number of hosts = %d, local host id = %d\n", total_num_hosts,
         local_host_id);
   for (size_t i = 0; i < local_num_shards; i++) {
-    int shard_id = i * total_num_hosts + local_host_id;
+    int shard_id = local_shard_ids[i];
+    int numa_node = numa_placement ? numa_nodes[i % numa_nodes.size()] : -1;
     std::string node_filename, edge_filename;
     node_filename = node_part_name(node_file, shard_id, total_num_shards);
     edge_filename = edge_part_name(edge_file, shard_id, total_num_shards);
-    LOG_E("Shard Id = %d, Node File = %s, Edge File = %s\n", shard_id,
-          node_filename.c_str(), edge_filename.c_str());
+    LOG_E("Shard Id = %d, Node File = %s, Edge File = %s, NUMA node = %d\n",
+          shard_id, node_filename.c_str(), edge_filename.c_str(), numa_node);
     init_threads.push_back(
         std::thread(
-            [i, node_filename, edge_filename, sa_sampling_rate, isa_sampling_rate, npa_sampling_rate, shard_id, total_num_shards, num_suffixstore_shards, num_logstore_shards, &pool, &local_shards] {
+            [i, node_filename, edge_filename, sa_sampling_rate, isa_sampling_rate, npa_sampling_rate, shard_id, total_num_shards, num_suffixstore_shards, num_logstore_shards, load_policy, numa_node, router, &pool, &local_shards] {
+              if (numa_node >= 0) {
+                Numa::pin_thread(numa_node);
+                Numa::prefer_node(numa_node);
+                SuccinctUtils::SetMappingNode(numa_node);
+              }
               local_shards[i] = new AsyncGraphShard(node_filename, edge_filename,
                   false, sa_sampling_rate,
                   isa_sampling_rate,
@@ -1818,7 +2293,8 @@ int main(int argc, char **argv) {
                   total_num_shards,
                   StoreMode::SuccinctStore,
                   num_suffixstore_shards,
-                  num_logstore_shards, pool);
+                  num_logstore_shards, pool, load_policy,
+                  numa_node, router);
             }));
   }
 
@@ -1830,8 +2306,14 @@ int main(int argc, char **argv) {
     // LogStore
     int shard_id = total_num_shards;
     LOG_E("Shard Id = %d, Log Store", shard_id);
-    AsyncGraphShard *shard = new AsyncGraphShard("", "", false,
-                                                 sa_sampling_rate,
+    // Without a snapshot directory, the LogStore starts empty every time.
+    std::string log_node_file, log_edge_file;
+    if (!snapshot_dir.empty()) {
+      log_node_file = snapshot_dir + "/logstore-nodes";
+      log_edge_file = snapshot_dir + "/logstore-edges";
+    }
+    AsyncGraphShard *shard = new AsyncGraphShard(log_node_file, log_edge_file,
+                                                 false, sa_sampling_rate,
                                                  isa_sampling_rate,
                                                  npa_sampling_rate, shard_id,
                                                  total_num_shards,
@@ -1840,6 +2322,28 @@ int main(int argc, char **argv) {
                                                  num_logstore_shards, pool);
     local_shards.push_back(shard);
 
+    if (!snapshot_dir.empty()) {
+      // Snapshots every snapshot_secs seconds, if set, and on SIGUSR1.  The
+      // update pointer tables are not part of the snapshot: this host
+      // rebuilds them from the restored tables once connected.
+      signal(SIGUSR1, request_snapshot);
+      std::thread([shard, snapshot_secs] {
+        int elapsed = 0;
+        while (true) {
+          sleep(1);
+          elapsed++;
+          if (snapshot_requested
+              || (snapshot_secs > 0 && elapsed >= snapshot_secs)) {
+            snapshot_requested = 0;
+            elapsed = 0;
+            if (!shard->snapshot()) {
+              LOG_E("[LOGSTORE] Snapshot failed\n");
+            }
+          }
+        }
+      }).detach();
+    }
+
     // +1 because of the last, empty shard
     edge_update_ptrs.resize(total_num_shards + num_logstore_shards + 1);
     node_update_ptrs.resize(total_num_shards + num_logstore_shards + 1);
@@ -1853,6 +2357,17 @@ int main(int argc, char **argv) {
           edge_update_ptrs.size());
   }
 
+  if (trace_sample_rate > 0) {
+    if (trace_file.empty()) {
+      trace_file = "aggregator-" + std::to_string(local_host_id)
+          + ".trace.json";
+    }
+    if (Trace::configure(trace_file, trace_sample_rate, local_host_id)) {
+      LOG_E("Tracing %g of queries to %s\n", trace_sample_rate,
+            trace_file.c_str());
+    }
+  }
+
   LOG_E("Handler started\n");
 
   int port = QUERY_HANDLER_PORT;
@@ -1861,7 +2376,8 @@ int main(int argc, char **argv) {
         new ProcessorFactory(total_num_shards, local_num_shards, local_host_id,
                              hostnames, multistore_enabled,
                              num_suffixstore_shards, num_logstore_shards,
-                             local_shards));
+                             local_shards, *shard_router, *host_router,
+                             replica_selector));
     shared_ptr<TServerTransport> server_transport(new TServerSocket(port));
     shared_ptr<TTransportFactory> transport_factory(
         new TBufferedTransportFactory());
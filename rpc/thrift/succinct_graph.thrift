@@ -171,4 +171,12 @@ service GraphQueryAggregatorService {
 
       i64 countLinks(1: i64 id1, 2: i64 link_type),
 
+      // Metrics of this aggregator process as a JSON object: counters and
+      // latency histograms (ns) summed over all threads since startup.
+      string get_stats(),
+
+      // Marks the next call on this connection as part of trace `trace_id`;
+      // sent by aggregators ahead of forwarded calls of sampled queries.
+      oneway void trace_next(1: i64 trace_id),
+
 }
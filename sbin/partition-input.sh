@@ -12,8 +12,15 @@ if [ ! -f "$prog" ]; then
   exit 1
 fi
 
+query_log_opt=
+if [ -n "$PARTITION_QUERY_LOG" ]; then
+  query_log_opt="-q $PARTITION_QUERY_LOG"
+fi
+
 $prog \
   -n $TOTAL_NUM_SHARDS \
+  -p "${PARTITIONER:-hash}" \
+  $query_log_opt \
   $NODE_FILE \
   $EDGE_FILE
 
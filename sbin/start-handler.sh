@@ -91,6 +91,16 @@ nohup "${bin}/../rpc/bin/graph_query_aggregator" \
   -f "${NUM_SUFFIXSTORE_PARTS}" \
   -l "${NUM_LOGSTORE_PARTS}" \
   -x ${sa_sr} -y ${isa_sr} -z ${npa_sr} \
+  -p "${LOAD_POLICY:-eager}" \
+  -n "${NUMA_PLACEMENT:-F}" \
+  -g "${HUGE_PAGES:-none}" \
+  -c "${LOGSTORE_CAPACITY_MB:-0}" \
+  -d "${LOGSTORE_SNAPSHOT_DIR:-}" \
+  -w "${LOGSTORE_SNAPSHOT_SECS:-0}" \
+  -r "${SHARD_MAP:-}" \
+  -R "${HOST_ROUTING:-modulo}" \
+  -P "${REPLICATION:-}" \
+  -b "${REPLICA_POLICY:-outstanding}" \
   $node_file_raw \
   $edge_file_raw 2>"${SUCCINCT_LOG_PATH}/handler.log" >/dev/null &
   #2>&1 > "${SUCCINCT_LOG_PATH}/handler_${2}.log" &
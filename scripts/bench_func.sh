@@ -422,6 +422,27 @@ function bench() {
       throughput_tao_mix-npa${npa}sa${sa}isa${isa}-${throughput_threads}clients.txt
   fi
 
+  if [[ -n "$benchTaoMixOpenLoop" ]]; then
+    # Latency vs. offered load; rates are aggregate queries/sec.
+    ${BIN_DIR}/../benchmark/bin/bench -t tao-mix-open-loop \
+      -p ${throughput_threads} \
+      -u ${openLoopRates:-"1000,2000,4000,8000,16000"} \
+      -v ${openLoopArrivals:-"poisson"} \
+      -o ${HOME_DIR}/openloop-taoMix-npa${npa}sa${sa}isa${isa}${dataset}-${TOTAL_NUM_SHARDS}shards.csv \
+      -w ${QUERY_DIR}/assocCount_warmup.txt \
+      -q ${QUERY_DIR}/assocCount_query.txt \
+      -a ${QUERY_DIR}/assocRange_warmup.txt \
+      -b ${QUERY_DIR}/assocRange_query.txt \
+      -c ${QUERY_DIR}/objGet_warmup.txt \
+      -d ${QUERY_DIR}/objGet_query.txt \
+      -e ${QUERY_DIR}/assocGet_warmup.txt \
+      -f ${QUERY_DIR}/assocGet_query.txt \
+      -g ${QUERY_DIR}/assocTimeRange_warmup.txt \
+      -l ${QUERY_DIR}/assocTimeRange_query.txt \
+      -m ${masterHostName} \
+      ${NODE_FILE} ${EDGE_FILE} ${SHARDED}
+  fi
+
   if [[ -n "$benchTaoMixWithUpdatesThput" ]]; then
     ${BIN_DIR}/../benchmark/bin/bench -t tao-mix-with-updates-throughput \
       -p ${throughput_threads} \
@@ -10,23 +10,29 @@ currDir=$(cd $(dirname $0); pwd)
 #### Copy the corresponding shard files over
 echo "Copying shard files..."
 
-num_succinctstore_hosts=$num_hosts
-
 limit=$(($TOTAL_NUM_SHARDS - 1))
 padWidth=${#TOTAL_NUM_SHARDS}
 
+# "<shard id> <host id> <host>" per copy of each shard, placed as the
+# handlers route them
+mapfile -t placements < <($SUCCINCT_HOME/bin/shard-hosts \
+  -n $TOTAL_NUM_SHARDS \
+  -h ${currDir}/../conf/hosts \
+  -R "${HOST_ROUTING:-modulo}" \
+  -P "${REPLICATION:-}")
+
 echo "Shard id range 0-$limit"
-echo "Number of Succinct Store Hosts: $num_succinctstore_hosts"
+echo "Host routing: ${HOST_ROUTING:-modulo}"
+echo "Replication: ${REPLICATION:-none}"
 
 echo "Hosts: $(cat ${currDir}/../conf/hosts)"
 
 echo "Beginning to copy in 10s..."
 sleep 10
 
-for shard_id in `seq 0 $limit`; do
+for placement in "${placements[@]}"; do
   # transfer shard id i to an appropriate host
-  host_id=$(($shard_id % num_succinctstore_hosts))
-  host=$(sed -n "$(($host_id + 1)){p;q;}" ${currDir}/../conf/hosts)
+  read shard_id host_id host <<< "$placement"
 
   padded_shard_id=$(printf "%0*d" ${padWidth} ${shard_id})
   nodeTblS3="s3://succinct-datasets/linkbench/succinct/${dataset}/distributed/${dataset}.node-part${padded_shard_id}of${TOTAL_NUM_SHARDS}WithPtrs.succinct"